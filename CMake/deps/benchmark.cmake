@@ -0,0 +1,17 @@
+set(BENCHMARK_ENABLE_TESTING OFF CACHE BOOL "Build benchmark's own tests" FORCE)
+set(BENCHMARK_ENABLE_GTEST_TESTS OFF CACHE BOOL "Build benchmark's gtest based tests" FORCE)
+set(BENCHMARK_ENABLE_INSTALL OFF CACHE BOOL "Install benchmark" FORCE)
+
+FetchContent_Declare(
+  benchmark
+  URL https://github.com/google/benchmark/archive/refs/tags/v1.8.3.zip
+)
+
+FetchContent_GetProperties(benchmark)
+
+if(NOT benchmark_POPULATED)
+  FetchContent_Populate(benchmark)
+  add_subdirectory(${benchmark_SOURCE_DIR} ${benchmark_BINARY_DIR} EXCLUDE_FROM_ALL)
+endif()
+
+target_link_libraries(cliot_bench PRIVATE benchmark::benchmark)
@@ -0,0 +1,24 @@
+#include <util/async_queue.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+
+namespace {
+// every thread puts one element in and takes one out, so nobody waits forever and the
+// queue sees as many producers as consumers contending for it
+void BM_AsyncQueueContention(benchmark::State &state) {
+    static auto queue = std::unique_ptr<util::AsyncQueue<int>>{};
+    if(state.thread_index() == 0)
+        queue = std::make_unique<util::AsyncQueue<int>>(static_cast<std::size_t>(state.range(0)), [](int &) {});
+
+    for(auto _ : state) {
+        queue->enqueue(42);
+        auto value = queue->dequeue();
+        benchmark::DoNotOptimize(value);
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+} // namespace
+
+BENCHMARK(BM_AsyncQueueContention)->ArgName("capacity")->Arg(64)->ThreadRange(1, 16)->UseRealTime();
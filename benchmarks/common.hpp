@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+/**
+ * @brief The data folder of the repository, with the example flows used as realistic input
+ */
+inline std::filesystem::path data_dir() {
+    return CLIOT_BENCH_DATA_DIR;
+}
+
+/**
+ * @brief Every flow folder under data/flows, sorted by name
+ */
+inline std::vector<std::filesystem::path> flow_dirs() {
+    auto dirs = std::vector<std::filesystem::path>{};
+    for(auto const &entry : std::filesystem::directory_iterator{ data_dir() / "flows" })
+        if(std::filesystem::exists(entry.path() / "script.yaml"))
+            dirs.push_back(entry.path());
+    std::sort(std::begin(dirs), std::end(dirs));
+    return dirs;
+}
+
+/**
+ * @brief ConnectionHandler that answers every request in-process with the request itself
+ *
+ * Takes the network out of the picture so that only cliot's own work per step is measured.
+ */
+class LoopbackHandler {
+public:
+    class Link {
+        std::string last_;
+
+    public:
+        void write(std::string &&data) {
+            last_ = std::move(data);
+        }
+
+        std::string_view read_one(std::chrono::milliseconds = {}) {
+            return last_;
+        }
+    };
+
+    using shared_link_t = std::shared_ptr<Link>;
+
+private:
+    shared_link_t link_ = std::make_shared<Link>(); // like a pooled connection, reused by every request
+
+public:
+    LoopbackHandler(std::string const &, std::string const &) { }
+
+    shared_link_t borrow() {
+        return link_;
+    }
+};
+
+/**
+ * @brief Fetch provider for flows that never fetch anything
+ */
+struct NullFetcher {
+    std::string get(std::string const &) const {
+        return {};
+    }
+    std::string post(std::string const &) const {
+        return {};
+    }
+};
+
+} // namespace bench
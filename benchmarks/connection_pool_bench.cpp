@@ -0,0 +1,47 @@
+#include <common.hpp>
+#include <echo_server.hpp>
+#include <web/async_connection_pool.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <string>
+
+namespace {
+// shared by all benchmark threads and alive until exit; the server outlives the pool
+struct Loopback {
+    EchoServer server;
+    AsyncConnectionPool pool{ "127.0.0.1", server.port() };
+
+    static Loopback &instance() {
+        static auto loopback = Loopback{};
+        return loopback;
+    }
+};
+
+void BM_PoolBorrow(benchmark::State &state) {
+    auto &pool = Loopback::instance().pool;
+
+    for(auto _ : state) {
+        auto link = pool.borrow(); // returned to the pool when the last reference goes away
+        benchmark::DoNotOptimize(link);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_PoolRoundTrip(benchmark::State &state) {
+    using namespace std::chrono_literals;
+    auto &pool = Loopback::instance().pool;
+
+    for(auto _ : state) {
+        auto link = pool.borrow();
+        link->write(R"({"method":"server_info"})");
+        auto response = link->read_one(5000ms);
+        benchmark::DoNotOptimize(response);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+} // namespace
+
+BENCHMARK(BM_PoolBorrow)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_PoolRoundTrip)->ThreadRange(1, 8)->UseRealTime();
@@ -0,0 +1,63 @@
+#include <common.hpp>
+#include <flow/default_flow_factory.hpp>
+#include <reporting/json_lines_renderer.hpp>
+#include <reporting/report_engine.hpp>
+#include <runner.hpp>
+#include <web/connection_manager.hpp>
+
+#include <benchmark/benchmark.h>
+#include <di.hpp>
+#include <fmt/format.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+using reporting_t    = ReportEngine<JsonLinesRenderer>;
+using con_man_t      = ConnectionManager<bench::LoopbackHandler, bench::NullFetcher>;
+using flow_factory_t = DefaultFlowFactory<con_man_t, reporting_t>;
+using flow_runner_t  = FlowRunner<flow_factory_t>;
+
+// a flow repeating a request and the validation of its response; the loopback answers with the request
+std::filesystem::path write_flow(std::int64_t repeat) {
+    auto const dir = std::filesystem::temp_directory_path() / "cliot_bench_flow";
+    std::filesystem::create_directories(dir);
+    std::ofstream{ dir / "request.json.j2" } << R"({"method": "ledger", "params": [{ "ledger_index": "{{ LedgerIndex }}", "transactions": true }]})";
+    std::ofstream{ dir / "response.json.j2" } << R"({"method": "ledger", "params": { "$each": { "ledger_index": "$string", "transactions": true } }})";
+    std::ofstream{ dir / "env.json" } << R"({"LedgerIndex": "validated"})";
+    std::ofstream{ dir / "script.yaml" } << fmt::format(R"(
+steps:
+- type: block
+  repeat: {}
+  steps:
+  - type: request
+    file: request.json.j2
+  - type: response
+    file: response.json.j2
+)",
+        repeat);
+    return dir;
+}
+
+void BM_FlowRunnerSteps(benchmark::State &state) {
+    auto const dir = write_flow(state.range(0));
+
+    auto renderer  = JsonLinesRenderer{};
+    auto reporting = reporting_t{ di::Deps<JsonLinesRenderer>{ renderer }, true };
+    auto fetcher   = bench::NullFetcher{};
+    auto con_man   = con_man_t{ "127.0.0.1", "0", fetcher };
+
+    auto flow_deps    = di::Deps<reporting_t, con_man_t>{ reporting, con_man };
+    auto flow_factory = flow_factory_t{ flow_deps };
+    auto runner       = flow_runner_t{ di::combine(flow_deps, di::Deps<flow_factory_t>{ flow_factory }), "bench", (dir / "").string() };
+
+    for(auto _ : state)
+        runner.run();
+
+    state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+    std::filesystem::remove_all(dir);
+}
+} // namespace
+
+BENCHMARK(BM_FlowRunnerSteps)->ArgName("repeat")->Arg(1)->Arg(10)->Arg(100)->Unit(benchmark::kMicrosecond);
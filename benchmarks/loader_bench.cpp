@@ -0,0 +1,23 @@
+#include <common.hpp>
+#include <flow/impl/yaml_file_loader.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace {
+void BM_LoadScripts(benchmark::State &state) {
+    auto const dirs = bench::flow_dirs();
+
+    for(auto _ : state)
+        for(auto const &dir : dirs) {
+            auto script = impl::YamlFileLoader{ dir }.load();
+            benchmark::DoNotOptimize(script);
+        }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(dirs.size()));
+}
+} // namespace
+
+BENCHMARK(BM_LoadScripts)->Unit(benchmark::kMicrosecond);
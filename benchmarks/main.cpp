@@ -0,0 +1,34 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Same flags as any Google Benchmark binary. Results are also written to cliot_bench.json
+// unless --benchmark_out is given, so that runs can be compared
+// with tools/compare.py from the benchmark repository.
+int main(int argc, char **argv) {
+    auto args        = std::vector<char *>{ argv, argv + argc };
+    auto const given = [&args](std::string_view flag) {
+        return std::any_of(std::begin(args), std::end(args), [flag](std::string_view arg) {
+            return arg.starts_with(flag);
+        });
+    };
+
+    auto out    = std::string{ "--benchmark_out=cliot_bench.json" };
+    auto format = std::string{ "--benchmark_out_format=json" };
+    if(not given("--benchmark_out="))
+        args.push_back(out.data());
+    if(not given("--benchmark_out_format="))
+        args.push_back(format.data());
+
+    auto count = static_cast<int>(args.size());
+    benchmark::Initialize(&count, args.data());
+    if(benchmark::ReportUnrecognizedArguments(count, args.data()))
+        return 1;
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
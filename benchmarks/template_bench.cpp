@@ -0,0 +1,90 @@
+#include <bundle/bundle.hpp>
+#include <common.hpp>
+
+#include <benchmark/benchmark.h>
+#include <inja/inja.hpp>
+
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+using json = inja::json;
+
+// the runner's extensions, reduced to what rendering the example flows needs
+void register_extensions(inja::Environment &env, json &store) {
+    env.add_callback("storeAndReturn", 2, [&store](inja::Arguments &args) {
+        return store[args.at(1)->get<std::string>()] = *args.at(0);
+    });
+    env.add_void_callback("store", 2, [&store](inja::Arguments &args) {
+        store[args.at(1)->get<std::string>()] = *args.at(0);
+    });
+    env.add_callback("load", 1, [&store](inja::Arguments &args) {
+        return store[args.at(0)->get<std::string>()];
+    });
+    env.add_callback("combine", 2, [](inja::Arguments &args) {
+        auto value = *args.at(0);
+        value.insert(value.end(), args.at(1)->begin(), args.at(1)->end());
+        return value;
+    });
+    env.add_callback("equal", 2, [](inja::Arguments &args) {
+        return *args.at(0) == *args.at(1);
+    });
+    env.add_void_callback("assert", 2, [](inja::Arguments &) {});
+    env.add_void_callback("report", 1, [](inja::Arguments &) {});
+    env.add_void_callback("fetch_json", 2, [](inja::Arguments &) {});
+}
+
+std::vector<std::string> template_paths() {
+    auto paths = std::vector<std::string>{};
+    for(auto const &dir : bench::flow_dirs())
+        for(auto const &entry : std::filesystem::directory_iterator{ dir })
+            if(entry.path().extension() == ".j2")
+                paths.push_back(entry.path().string());
+    return paths;
+}
+
+void BM_ParseTemplates(benchmark::State &state) {
+    auto const paths = template_paths();
+    auto env         = inja::Environment{};
+    auto store       = json::object();
+    register_extensions(env, store);
+
+    for(auto _ : state)
+        for(auto const &path : paths) {
+            auto temp = bundle::parse_template(env, path);
+            benchmark::DoNotOptimize(temp);
+        }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(paths.size()));
+}
+
+void BM_RenderTemplates(benchmark::State &state) {
+    auto env   = inja::Environment{};
+    auto store = json::object();
+    register_extensions(env, store);
+
+    // response templates refer to values of earlier responses; those that can't render without them are left out
+    auto templates = std::vector<inja::Template>{};
+    for(auto const &path : template_paths()) {
+        try {
+            auto temp = bundle::parse_template(env, path);
+            env.render(temp, store);
+            templates.push_back(std::move(temp));
+        } catch(std::exception const &) {
+        }
+    }
+
+    for(auto _ : state)
+        for(auto const &temp : templates) {
+            auto rendered = env.render(temp, store);
+            benchmark::DoNotOptimize(rendered);
+        }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(templates.size()));
+    state.counters["templates"] = static_cast<double>(templates.size());
+}
+} // namespace
+
+BENCHMARK(BM_ParseTemplates)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_RenderTemplates)->Unit(benchmark::kMicrosecond);
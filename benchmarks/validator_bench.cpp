@@ -0,0 +1,133 @@
+#include <util/arena.hpp>
+#include <util/arena_json.hpp>
+#include <validation/validator.hpp>
+
+#include <benchmark/benchmark.h>
+#include <fmt/format.h>
+#include <inja/inja.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace {
+using json = inja::json;
+
+// a distinct, valid looking account per object
+std::string account(std::size_t i) {
+    static constexpr std::string_view alphabet = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+    auto result                                = std::string{ "rHb9CJAWyB4rj91VRWn96DkukG4bwd" };
+    for(auto n = 0; n < 4; ++n, i /= alphabet.size())
+        result += alphabet[i % alphabet.size()];
+    return result;
+}
+
+// one ledger object as returned by ledger_data
+json object(std::size_t i) {
+    return {
+        { "index", fmt::format("{:064X}", i * 2654435761u) },
+        { "LedgerEntryType", i % 3 == 0 ? "AccountRoot" : "Offer" },
+        { "Account", account(i) },
+        { "Balance", std::to_string(1000000 + i) },
+        { "Flags", i % 7 },
+        { "Sequence", i },
+        { "PreviousTxnLgrSeq", 32570 + i }
+    };
+}
+
+// the checks a flow would write for it
+json object_expectations() {
+    return json::parse(R"({
+        "index": { "$length": 64 },
+        "LedgerEntryType": "$string",
+        "Account": { "$regex": "^r[1-9A-HJ-NP-Za-km-z]{24,34}$" },
+        "Balance": { "$range": [0, null] },
+        "Flags": "$uint",
+        "Sequence": "$uint",
+        "PreviousTxnLgrSeq": "$uint"
+    })");
+}
+
+// small: a server_info sized response, medium: a ledger with its transactions, huge: a ledger_data page
+std::pair<json, json> response_of(std::size_t objects) {
+    auto incoming = json{
+        { "result", { { "ledger_index", 32570 }, { "ledger_hash", fmt::format("{:064X}", 42) }, { "validated", true }, { "state", json::array() } } },
+        { "status", "success" },
+        { "type", "response" }
+    };
+    for(auto i = std::size_t{ 0 }; i < objects; ++i)
+        incoming["result"]["state"].push_back(object(i));
+
+    auto expectations = json::parse(R"({
+        "result": { "ledger_index": { "$range": [1, null] }, "ledger_hash": { "$length": 64 }, "validated": true },
+        "status": "success",
+        "type": "response"
+    })");
+    expectations["result"]["state"] = { { "$each", object_expectations() } };
+    return { std::move(expectations), std::move(incoming) };
+}
+
+void BM_Validate(benchmark::State &state) {
+    auto const [expectations, incoming] = response_of(static_cast<std::size_t>(state.range(0)));
+    auto validator                      = Validator{};
+    if(not validator.validate(expectations, incoming).first)
+        return state.SkipWithError("Response does not match its expectations");
+
+    for(auto _ : state) {
+        auto result = validator.validate(expectations, incoming);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations() * (state.range(0) + 1));
+}
+
+void BM_ValidateStream(benchmark::State &state) {
+    auto const [expectations, incoming] = response_of(static_cast<std::size_t>(state.range(0)));
+    auto const raw                      = incoming.dump();
+    auto const captures                 = Validator::captures_t{ { "LedgerIndex", "/result/ledger_index" } };
+    auto validator                      = Validator{};
+    auto store                          = json::object();
+    if(not validator.validate_stream(expectations, raw, captures, store).first)
+        return state.SkipWithError("Response does not match its expectations");
+
+    for(auto _ : state) {
+        auto result = validator.validate_stream(expectations, raw, captures, store);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(raw.size()));
+}
+
+// what a response step does: parse the response and the rendered expectations, then match them
+void BM_ParseAndValidate(benchmark::State &state) {
+    auto const [expectations, incoming] = response_of(static_cast<std::size_t>(state.range(0)));
+    auto const expected_text            = expectations.dump();
+    auto const raw                      = incoming.dump();
+    auto validator                      = Validator{};
+
+    for(auto _ : state) {
+        auto result = validator.validate(json::parse(expected_text), json::parse(raw));
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(raw.size()));
+}
+
+void BM_ParseAndValidateArena(benchmark::State &state) {
+    auto const [expectations, incoming] = response_of(static_cast<std::size_t>(state.range(0)));
+    auto const expected_text            = expectations.dump();
+    auto const raw                      = incoming.dump();
+    auto validator                      = Validator{};
+
+    for(auto _ : state) {
+        auto const arena = util::Arena::Scope{};
+        auto result      = validator.validate(util::ArenaJson::parse(expected_text), util::ArenaJson::parse(raw));
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(raw.size()));
+}
+} // namespace
+
+BENCHMARK(BM_Validate)->ArgName("objects")->Arg(1)->Arg(200)->Arg(20000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ValidateStream)->ArgName("objects")->Arg(1)->Arg(200)->Arg(20000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ParseAndValidate)->ArgName("objects")->Arg(1)->Arg(200)->Arg(20000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ParseAndValidateArena)->ArgName("objects")->Arg(1)->Arg(200)->Arg(20000)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,190 @@
+#include <bundle/bundle.hpp>
+
+#include <fmt/format.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <system_error>
+
+namespace bundle {
+
+namespace {
+std::unique_ptr<Bundle> active_bundle;
+
+std::filesystem::path normalized(std::filesystem::path const &path) {
+    auto result = path.lexically_normal();
+    if(not result.has_filename()) // "dir/" and "dir" are the same root
+        result = result.parent_path();
+    return result;
+}
+} // namespace
+
+Bundle::Bundle(std::filesystem::path const &path)
+    : root_{ normalized(path) } {
+    auto const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        throw std::system_error{ errno, std::generic_category(), fmt::format("Could not open bundle {}", path.string()) };
+
+    struct stat st;
+    if(::fstat(fd, &st) != 0) {
+        auto const err = errno;
+        ::close(fd);
+        throw std::system_error{ err, std::generic_category(), fmt::format("Could not stat bundle {}", path.string()) };
+    }
+
+    size_ = static_cast<std::size_t>(st.st_size);
+    if(size_ < header_size) {
+        ::close(fd);
+        throw FormatError{ fmt::format("{} is too small to be a bundle", path.string()) };
+    }
+
+    mapping_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+    if(mapping_ == MAP_FAILED) {
+        mapping_ = nullptr;
+        throw std::system_error{ errno, std::generic_category(), fmt::format("Could not map bundle {}", path.string()) };
+    }
+
+    try {
+        auto const data = std::string_view{ static_cast<char const *>(mapping_), size_ };
+        auto header     = Reader{ data.substr(0, header_size) };
+        if(header.raw(magic.size()) != magic)
+            throw FormatError{ fmt::format("{} is not a cliot bundle", path.string()) };
+        if(auto const v = header.u32(); v != version)
+            throw FormatError{ fmt::format("{} has bundle version {}, expected {}", path.string(), v, version) };
+
+        auto count        = header.u32();
+        auto const offset = header.u64();
+        if(offset < header_size or offset > size_)
+            throw FormatError{ fmt::format("{} has a corrupt index", path.string()) };
+
+        // every entry takes at least its fixed-size fields, so a corrupt count can't ask for more than fits
+        constexpr auto min_entry_size = std::size_t{ 1 + 4 + 8 + 8 + 4 };
+        if(count > (size_ - offset) / min_entry_size)
+            throw FormatError{ fmt::format("{} has a corrupt index", path.string()) };
+
+        auto index = Reader{ data.substr(offset) };
+        index_.reserve(count);
+        while(count-- > 0) {
+            auto entry       = Entry{};
+            entry.kind       = static_cast<Kind>(index.u8());
+            auto const key   = index.str();
+            auto const begin = index.u64();
+            auto const size  = index.u64();
+            if(begin < header_size or begin > offset or size > offset - begin)
+                throw FormatError{ fmt::format("{} has a corrupt entry for {}", path.string(), key) };
+
+            entry.data = data.substr(begin, size);
+            for(auto n = index.u32(); n > 0; --n)
+                entry.includes.push_back(index.str());
+            index_.emplace(std::string{ key }, std::move(entry));
+        }
+    } catch(...) {
+        ::munmap(mapping_, size_);
+        throw;
+    }
+}
+
+Bundle::~Bundle() {
+    if(mapping_)
+        ::munmap(mapping_, size_);
+}
+
+bool Bundle::is_bundle(std::filesystem::path const &path) {
+    if(not std::filesystem::is_regular_file(path))
+        return false;
+
+    auto in     = std::ifstream{ path, std::ios::binary };
+    auto buffer = std::array<char, magic.size()>{};
+    return in.read(buffer.data(), buffer.size()) and std::string_view{ buffer.data(), buffer.size() } == magic;
+}
+
+void Bundle::activate(std::filesystem::path const &path) {
+    active_bundle = std::make_unique<Bundle>(path);
+}
+
+Bundle const *Bundle::active() {
+    return active_bundle.get();
+}
+
+Bundle::Entry const *Bundle::find(std::filesystem::path const &path) const {
+    auto const key = key_of(path);
+    if(not key)
+        return nullptr;
+
+    auto const it = index_.find(*key);
+    return it == std::end(index_) ? nullptr : &it->second;
+}
+
+std::vector<std::string> Bundle::flows() const {
+    auto names = std::vector<std::string>{};
+    for(auto const &[key, entry] : index_) {
+        auto const path = std::filesystem::path{ key };
+        if(entry.kind == Kind::STEPS and path.parent_path().parent_path() == "flows")
+            names.push_back(path.parent_path().filename().string());
+    }
+
+    std::sort(std::begin(names), std::end(names));
+    return names;
+}
+
+descriptor::Script Bundle::script(std::filesystem::path const &script_path) const {
+    auto const *entry = find(script_path);
+    if(not entry or entry->kind != Kind::STEPS)
+        throw std::runtime_error{ fmt::format("Bundle has no script {}", script_path.string()) };
+    return decode_script(entry->data);
+}
+
+inja::Template Bundle::parse_template(inja::Environment &env, std::filesystem::path const &path) const {
+    auto const *entry = find(path);
+    if(not entry or entry->kind != Kind::FILE)
+        throw std::runtime_error{ fmt::format("Bundle has no template {}", path.string()) };
+
+    register_includes(env, *entry);
+    return env.parse(entry->data);
+}
+
+std::optional<std::string> Bundle::key_of(std::filesystem::path const &path) const {
+    auto const relative = normalized(path).lexically_relative(root_);
+    if(relative.empty() or *std::begin(relative) == "..")
+        return std::nullopt;
+    return relative.generic_string();
+}
+
+void Bundle::register_includes(inja::Environment &env, Entry const &entry) const {
+    // includes were rewritten to bundle keys by pack(), so registering them under their
+    // key is all inja needs to resolve them without looking at the file system
+    for(auto const &include : entry.includes) {
+        auto const it = index_.find(std::string{ include });
+        if(it == std::end(index_))
+            throw FormatError{ fmt::format("Bundle is missing included template {}", include) };
+
+        register_includes(env, it->second);
+        env.include_template(std::string{ include }, env.parse(it->second.data));
+    }
+}
+
+std::optional<inja::json> load_json(std::filesystem::path const &path) {
+    if(auto const *bundle = Bundle::active()) {
+        if(auto const *entry = bundle->find(path))
+            return inja::json::parse(entry->data);
+        return std::nullopt;
+    }
+
+    if(not std::filesystem::exists(path))
+        return std::nullopt;
+
+    auto in = std::ifstream{ path };
+    return inja::json::parse(in);
+}
+
+} // namespace bundle
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <bundle/format.hpp>
+#include <flow/descriptors.hpp>
+
+#include <inja/inja.hpp>
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace bundle {
+
+/**
+ * @brief A suite packed into a single file by `cliot pack`, memory-mapped for the lifetime of the object
+ *
+ * The bundle stands in for the data directory it was packed from: paths below root() are
+ * looked up in the index instead of on disk. Entries point straight into the mapping.
+ */
+class Bundle {
+public:
+    struct Entry {
+        Kind kind;
+        std::string_view data;
+        std::vector<std::string_view> includes; // keys of the templates this one includes
+    };
+
+    explicit Bundle(std::filesystem::path const &path);
+    ~Bundle();
+
+    Bundle(Bundle const &)            = delete;
+    Bundle &operator=(Bundle const &) = delete;
+
+    /**
+     * @brief Whether the file at path starts with the bundle magic
+     */
+    static bool is_bundle(std::filesystem::path const &path);
+
+    /**
+     * @brief Maps the bundle at path and makes it the one used by all lookups below
+     */
+    static void activate(std::filesystem::path const &path);
+
+    /**
+     * @brief The active bundle or nullptr when running from a data directory
+     */
+    static Bundle const *active();
+
+    std::filesystem::path const &root() const {
+        return root_;
+    }
+
+    Entry const *find(std::filesystem::path const &path) const;
+
+    /**
+     * @brief Names of all flows that have a script, ordered by name
+     */
+    std::vector<std::string> flows() const;
+
+    descriptor::Script script(std::filesystem::path const &script_path) const;
+
+    /**
+     * @brief Parses the template at path, registering everything it includes with env first
+     */
+    inja::Template parse_template(inja::Environment &env, std::filesystem::path const &path) const;
+
+private:
+    std::optional<std::string> key_of(std::filesystem::path const &path) const;
+    void register_includes(inja::Environment &env, Entry const &entry) const;
+
+    std::filesystem::path root_;
+    void *mapping_    = nullptr;
+    std::size_t size_ = 0;
+    std::unordered_map<std::string, Entry> index_;
+};
+
+/**
+ * @brief Writes the data directory at data_path into a single bundle at output_path
+ */
+void pack(std::filesystem::path const &data_path, std::filesystem::path const &output_path);
+
+/**
+ * @brief env.parse_template(path), served from the active bundle if there is one
+ */
+inline inja::Template parse_template(inja::Environment &env, std::string const &path) {
+    if(auto const *bundle = Bundle::active())
+        return bundle->parse_template(env, path);
+    return env.parse_template(path);
+}
+
+/**
+ * @brief Loads the JSON file at path from the active bundle or disk; nullopt if it does not exist
+ */
+std::optional<inja::json> load_json(std::filesystem::path const &path);
+
+} // namespace bundle
@@ -0,0 +1,199 @@
+#include <bundle/format.hpp>
+#include <util/overloaded.hpp>
+
+#include <chrono>
+#include <variant>
+
+namespace bundle {
+
+namespace {
+enum class StepType : std::uint8_t {
+    REQUEST  = 1,
+    RESPONSE = 2,
+    RUN_FLOW = 3,
+    BLOCK    = 4
+};
+
+void encode(Writer &out, std::vector<descriptor::Step> const &steps) {
+    out.u32(static_cast<std::uint32_t>(steps.size()));
+    for(auto const &step : steps) {
+        // clang-format off
+        std::visit(overloaded {
+            [&out](descriptor::Request const &req) {
+                out.u8(static_cast<std::uint8_t>(StepType::REQUEST));
+                out.str(req.file);
+                out.u32(static_cast<std::uint32_t>(req.timeout.count()));
+            },
+            [&out](descriptor::Response const &resp) {
+                out.u8(static_cast<std::uint8_t>(StepType::RESPONSE));
+                out.str(resp.file);
+                out.u8(resp.stream);
+                out.u32(static_cast<std::uint32_t>(resp.store.size()));
+                for(auto const &[var, pointer] : resp.store) {
+                    out.str(var);
+                    out.str(pointer);
+                }
+                out.u32(static_cast<std::uint32_t>(resp.timeout.count()));
+            },
+            [&out](descriptor::RunFlow const &flow) {
+                out.u8(static_cast<std::uint8_t>(StepType::RUN_FLOW));
+                out.str(flow.name);
+                out.u8(flow.fixture);
+                out.u32(static_cast<std::uint32_t>(flow.keys.size()));
+                for(auto const &key : flow.keys)
+                    out.str(key);
+            },
+            [&out](descriptor::RepeatBlock const &block) {
+                out.u8(static_cast<std::uint8_t>(StepType::BLOCK));
+                out.u32(block.repeat);
+                out.u32(static_cast<std::uint32_t>(block.timeout.count()));
+                encode(out, block.steps);
+            }},
+        step);
+        // clang-format on
+    }
+}
+
+std::vector<descriptor::Step> decode(Reader &in) {
+    auto steps = std::vector<descriptor::Step>{};
+    auto count = in.u32();
+
+    // the smallest step is a request with an empty file name (tag, name, timeout), so a corrupt count can't ask for more than fits
+    constexpr auto min_step_size = std::size_t{ 1 + 4 + 4 };
+    if(count > in.remaining() / min_step_size)
+        throw FormatError{ "Corrupt step count in bundle" };
+    steps.reserve(count);
+
+    while(count-- > 0) {
+        switch(static_cast<StepType>(in.u8())) {
+        case StepType::REQUEST: {
+            auto req    = descriptor::Request{ std::string{ in.str() } };
+            req.timeout = std::chrono::milliseconds{ in.u32() };
+            steps.push_back(std::move(req));
+            break;
+        }
+        case StepType::RESPONSE: {
+            auto resp   = descriptor::Response{};
+            resp.file   = in.str();
+            resp.stream = in.u8() != 0;
+            for(auto n = in.u32(); n > 0; --n) {
+                auto var        = std::string{ in.str() };
+                resp.store[var] = in.str();
+            }
+            resp.timeout = std::chrono::milliseconds{ in.u32() };
+            steps.push_back(std::move(resp));
+            break;
+        }
+        case StepType::RUN_FLOW: {
+            auto flow    = descriptor::RunFlow{};
+            flow.name    = in.str();
+            flow.fixture = in.u8() != 0;
+            for(auto n = in.u32(); n > 0; --n)
+                flow.keys.emplace_back(in.str());
+            steps.push_back(std::move(flow));
+            break;
+        }
+        case StepType::BLOCK: {
+            auto block    = descriptor::RepeatBlock{};
+            block.repeat  = in.u32();
+            block.timeout = std::chrono::milliseconds{ in.u32() };
+            block.steps   = decode(in);
+            steps.push_back(std::move(block));
+            break;
+        }
+        default:
+            throw FormatError{ "Unknown step type in bundle" };
+        }
+    }
+    return steps;
+}
+} // namespace
+
+void Writer::u8(std::uint8_t value) {
+    out_.push_back(static_cast<char>(value));
+}
+
+void Writer::u32(std::uint32_t value) {
+    for(auto i = 0; i < 4; ++i)
+        out_.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+void Writer::u64(std::uint64_t value) {
+    for(auto i = 0; i < 8; ++i)
+        out_.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+void Writer::str(std::string_view value) {
+    u32(static_cast<std::uint32_t>(value.size()));
+    raw(value);
+}
+
+void Writer::raw(std::string_view value) {
+    out_.append(value);
+}
+
+std::uint8_t Reader::u8() {
+    return static_cast<std::uint8_t>(raw(1).front());
+}
+
+std::uint32_t Reader::u32() {
+    auto const bytes = raw(4);
+    auto value       = std::uint32_t{ 0 };
+    for(auto i = 0; i < 4; ++i)
+        value |= std::uint32_t{ static_cast<std::uint8_t>(bytes[i]) } << (8 * i);
+    return value;
+}
+
+std::uint64_t Reader::u64() {
+    auto const bytes = raw(8);
+    auto value       = std::uint64_t{ 0 };
+    for(auto i = 0; i < 8; ++i)
+        value |= std::uint64_t{ static_cast<std::uint8_t>(bytes[i]) } << (8 * i);
+    return value;
+}
+
+std::string_view Reader::str() {
+    return raw(u32());
+}
+
+std::string_view Reader::raw(std::size_t size) {
+    if(size > in_.size() - pos_)
+        throw FormatError{ "Unexpected end of bundle data" };
+
+    auto const result = in_.substr(pos_, size);
+    pos_ += size;
+    return result;
+}
+
+std::string encode_steps(std::vector<descriptor::Step> const &steps) {
+    auto out = Writer{};
+    encode(out, steps);
+    return std::move(out.data());
+}
+
+std::vector<descriptor::Step> decode_steps(std::string_view data) {
+    auto in    = Reader{ data };
+    auto steps = decode(in);
+    if(not in.done())
+        throw FormatError{ "Trailing data after steps in bundle" };
+    return steps;
+}
+
+std::string encode_script(descriptor::Script const &script) {
+    auto out = Writer{};
+    out.u32(static_cast<std::uint32_t>(script.timeout.count()));
+    encode(out, script.steps);
+    return std::move(out.data());
+}
+
+descriptor::Script decode_script(std::string_view data) {
+    auto in        = Reader{ data };
+    auto script    = descriptor::Script{};
+    script.timeout = std::chrono::milliseconds{ in.u32() };
+    script.steps   = decode(in);
+    if(not in.done())
+        throw FormatError{ "Trailing data after script in bundle" };
+    return script;
+}
+
+} // namespace bundle
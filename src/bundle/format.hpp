@@ -0,0 +1,82 @@
+#pragma once
+
+#include <flow/descriptors.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bundle {
+
+/*
+ * Layout of a suite bundle (all integers little endian):
+ *
+ *   header  magic[8] "CLIOTPAK", u32 version, u32 entry count, u64 index offset
+ *   blobs   contents of all entries, back to back
+ *   index   per entry: u8 kind, str key, u64 offset, u64 size, u32 include count, str include...
+ *
+ * where str is a u32 length followed by that many bytes. Keys are paths relative to the
+ * data directory, e.g. "flows/issue263/request.json.j2".
+ *
+ * Scripts are stored as u32 timeout in milliseconds followed by their encoded steps.
+ */
+inline constexpr std::string_view magic  = "CLIOTPAK";
+inline constexpr std::uint32_t version   = 3;
+inline constexpr std::size_t header_size = 8 + 4 + 4 + 8;
+
+enum class Kind : std::uint8_t {
+    FILE  = 1, // raw file, templates have their includes rewritten to keys
+    STEPS = 2  // script.yaml, stored as encoded step descriptors
+};
+
+struct FormatError : public std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+class Writer {
+    std::string out_;
+
+public:
+    void u8(std::uint8_t value);
+    void u32(std::uint32_t value);
+    void u64(std::uint64_t value);
+    void str(std::string_view value);
+    void raw(std::string_view value);
+
+    std::string &data() {
+        return out_;
+    }
+};
+
+class Reader {
+    std::string_view in_;
+    std::size_t pos_ = 0;
+
+public:
+    explicit Reader(std::string_view in)
+        : in_{ in } { }
+
+    std::uint8_t u8();
+    std::uint32_t u32();
+    std::uint64_t u64();
+    std::string_view str();
+    std::string_view raw(std::size_t size);
+
+    bool done() const {
+        return pos_ == in_.size();
+    }
+
+    std::size_t remaining() const {
+        return in_.size() - pos_;
+    }
+};
+
+std::string encode_steps(std::vector<descriptor::Step> const &steps);
+std::vector<descriptor::Step> decode_steps(std::string_view data);
+
+std::string encode_script(descriptor::Script const &script);
+descriptor::Script decode_script(std::string_view data);
+
+} // namespace bundle
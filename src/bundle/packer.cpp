@@ -0,0 +1,124 @@
+#include <bundle/bundle.hpp>
+#include <flow/impl/yaml_file_loader.hpp>
+#include <util/state_file.hpp>
+#include <util/template_includes.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace bundle {
+
+namespace {
+struct PackedFile {
+    Kind kind;
+    std::string key;
+    std::string data;
+    std::vector<std::string> includes;
+};
+
+bool is_hidden(std::filesystem::path const &path) {
+    return path.filename().string().starts_with(".");
+}
+
+std::string read_file(std::filesystem::path const &path) {
+    auto in = std::ifstream{ path, std::ios::binary };
+    if(not in)
+        throw std::runtime_error{ fmt::format("Could not read {}", path.string()) };
+
+    auto ss = std::stringstream{};
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+std::string key_of(std::filesystem::path const &root, std::filesystem::path const &path) {
+    return path.lexically_normal().lexically_relative(root).generic_string();
+}
+
+/**
+ * @brief Rewrites every include to the key of the included file
+ *
+ * inja resolves includes relative to the including template; inside the bundle there is no
+ * such directory, so each include is turned into its key and registered under that name.
+ */
+PackedFile pack_template(std::filesystem::path const &root, std::filesystem::path const &path) {
+    auto file         = PackedFile{ Kind::FILE, key_of(root, path), {}, {} };
+    auto const source = read_file(path);
+    auto last         = std::size_t{ 0 };
+    for(auto const &include : util::find_includes(source)) {
+        auto const target = (path.parent_path() / include.name).lexically_normal();
+        auto const key    = key_of(root, target);
+        if(key.empty() or key.starts_with("..") or not std::filesystem::is_regular_file(target))
+            throw std::runtime_error{ fmt::format("{} includes {} which is not part of the suite", file.key, include.name) };
+
+        file.data.append(source, last, include.offset - last);
+        file.data.append(key);
+        last = include.offset + include.length;
+        if(std::find(std::begin(file.includes), std::end(file.includes), key) == std::end(file.includes))
+            file.includes.push_back(key);
+    }
+
+    file.data.append(source, last);
+    return file;
+}
+} // namespace
+
+void pack(std::filesystem::path const &data_path, std::filesystem::path const &output_path) {
+    auto root = data_path.lexically_normal();
+    if(not root.has_filename())
+        root = root.parent_path();
+    if(not std::filesystem::is_directory(root / "flows"))
+        throw std::runtime_error("given path does not appear to be valid: missing 'flows' sub directory");
+
+    auto const output = std::filesystem::weakly_canonical(output_path);
+    auto files        = std::vector<PackedFile>{};
+    for(auto it = std::filesystem::recursive_directory_iterator{ root }; it != std::filesystem::recursive_directory_iterator{}; ++it) {
+        if(is_hidden(it->path())) {
+            if(it->is_directory())
+                it.disable_recursion_pending();
+            continue;
+        }
+
+        if(not it->is_regular_file() or std::filesystem::weakly_canonical(it->path()) == output)
+            continue;
+
+        if(it->path().filename() == "script.yaml") {
+            auto const script = impl::YamlFileLoader{ it->path().parent_path() }.load();
+            files.push_back({ Kind::STEPS, key_of(root, it->path()), encode_script(script), {} });
+        } else {
+            files.push_back(pack_template(root, it->path()));
+        }
+    }
+
+    std::sort(std::begin(files), std::end(files), [](auto const &a, auto const &b) {
+        return a.key < b.key;
+    });
+
+    auto blobs = std::string{};
+    auto index = Writer{};
+    for(auto const &file : files) {
+        index.u8(static_cast<std::uint8_t>(file.kind));
+        index.str(file.key);
+        index.u64(header_size + blobs.size());
+        index.u64(file.data.size());
+        index.u32(static_cast<std::uint32_t>(file.includes.size()));
+        for(auto const &include : file.includes)
+            index.str(include);
+        blobs.append(file.data);
+    }
+
+    auto header = Writer{};
+    header.raw(magic);
+    header.u32(version);
+    header.u32(static_cast<std::uint32_t>(files.size()));
+    header.u64(header_size + blobs.size());
+
+    // runners never map a partial bundle
+    if(not util::write_file_atomically(output_path, { header.data(), blobs, index.data() }))
+        throw std::runtime_error{ fmt::format("Could not write bundle {}", output_path.string()) };
+}
+
+} // namespace bundle
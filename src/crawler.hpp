@@ -1,6 +1,8 @@
 #pragma once
 
+#include <bundle/bundle.hpp>
 #include <flow/flow.hpp>
+#include <flow/suite_manifest.hpp>
 #include <reporting/report_engine.hpp>
 #include <runner.hpp>
 
@@ -9,8 +11,8 @@
 
 #include <filesystem>
 #include <iostream>
-#include <queue>
-#include <set>
+#include <map>
+#include <string>
 
 template <typename ReportEngineType>
 class Crawler {
@@ -18,59 +20,51 @@ class Crawler {
     using reporting_t = ReportEngineType;
     using services_t  = di::Deps<reporting_t>;
 
-    using path_set_data_t = std::pair<std::string, std::filesystem::path>;
-
     services_t services_;
     std::filesystem::path path_;
     std::string filter_;
+    bool use_manifest_;
 
-    std::set<path_set_data_t> paths_;          // all paths ordered
     std::map<std::string, std::string> flows_; // ordered by name
 
 public:
-    Crawler(services_t services, std::filesystem::path path, std::string const &filter)
+    Crawler(services_t services, std::filesystem::path path, std::string const &filter, bool use_manifest = true)
         : services_{ services }
         , path_{ path }
-        , filter_{ filter } { }
+        , filter_{ filter }
+        , use_manifest_{ use_manifest } { }
 
     auto crawl() {
+        flows_.clear(); // crawled again for every run in watch mode
+        if(auto const *bundle = bundle::Bundle::active())
+            return crawl(*bundle);
+
         auto flows_path = path_ / "flows";
 
         if(not std::filesystem::exists(flows_path))
             throw std::runtime_error("given path does not appear to be valid: missing 'flows' sub directory");
 
-        for(auto const &entry : std::filesystem::directory_iterator{ flows_path }) {
-            crawl(entry.path());
-        }
-
-        for(auto const &[flow_name, path] : paths_) {
-            if(not is_passing_filter(flow_name))
-                continue;
+        auto manifest = SuiteManifest{ flows_path, use_manifest_ ? path_ / SuiteManifest::file_name : std::filesystem::path{} };
+        for(auto const &[flow_name, entry] : manifest.entries()) {
+            report_detected(flow_name);
 
-            if(path.filename() == "script.yaml") {
-                auto dir_path = path;
-                dir_path.remove_filename();
-                flows_.emplace(std::make_pair(flow_name, dir_path.string()));
-            }
+            if(entry.has_script and is_passing_filter(flow_name))
+                flows_.emplace(flow_name, (entry.dir / "").string());
         }
 
         return flows_;
     }
 
 private:
-    void crawl(std::filesystem::path flow_path) {
-        auto flow_name = flow_path.filename().string();
-        if(flow_name.starts_with("."))
-            return;
+    std::map<std::string, std::string> const &crawl(bundle::Bundle const &bundle) {
+        for(auto const &flow_name : bundle.flows()) {
+            report_detected(flow_name);
 
-        report_detected(flow_name);
-
-        for(auto const &entry : std::filesystem::directory_iterator{ flow_path }) {
-            if(not entry.is_regular_file() or entry.path().filename().string().starts_with("."))
-                continue;
-
-            paths_.emplace(flow_name, entry.path());
+            if(is_passing_filter(flow_name))
+                flows_.emplace(flow_name, (bundle.root() / "flows" / flow_name / "").string());
         }
+
+        return flows_;
     }
 
     void report_detected(std::string const &name) {
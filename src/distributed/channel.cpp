@@ -0,0 +1,112 @@
+#include <distributed/channel.hpp>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/write.hpp>
+#include <fmt/format.h>
+
+#include <poll.h>
+#include <sys/socket.h>
+
+#include <istream>
+#include <stdexcept>
+#include <system_error>
+
+namespace net = boost::asio;
+
+namespace distributed {
+
+protocol_t::endpoint parse_endpoint(net::io_context &ctx, std::string const &spec) {
+    if(spec.starts_with("unix:"))
+        return net::local::stream_protocol::endpoint{ spec.substr(5) };
+
+    auto const address = spec.starts_with("tcp:") ? spec.substr(4) : spec;
+    auto const colon   = address.rfind(':');
+    if(colon == std::string::npos)
+        throw std::runtime_error(fmt::format("endpoint must be unix:/path, tcp:host:port or host:port, got '{}'", spec));
+
+    auto resolver      = net::ip::tcp::resolver{ ctx };
+    auto const results = resolver.resolve(address.substr(0, colon), address.substr(colon + 1));
+    return results.begin()->endpoint();
+}
+
+Channel::Channel(std::string const &endpoint)
+    : ctx_{ std::make_unique<net::io_context>() }
+    , socket_{ *ctx_ } {
+    socket_.connect(parse_endpoint(*ctx_, endpoint));
+}
+
+Channel::Channel(protocol_t::socket &&socket)
+    : socket_{ std::move(socket) } {
+}
+
+bool Channel::send(inja::json const &message) {
+    auto line = message.dump(-1, ' ', false, inja::json::error_handler_t::replace);
+    line += '\n';
+
+    std::scoped_lock l{ send_mtx_ };
+    auto ec = boost::system::error_code{};
+    net::write(socket_, net::buffer(line), ec);
+    return not ec;
+}
+
+std::optional<inja::json> Channel::receive() {
+    auto ec = boost::system::error_code{};
+    net::read_until(socket_, buffer_, '\n', ec);
+    if(ec)
+        return std::nullopt;
+
+    auto in   = std::istream{ &buffer_ };
+    auto line = std::string{};
+    std::getline(in, line);
+    try {
+        return inja::json::parse(line);
+    } catch(inja::json::exception const &) {
+        return std::nullopt; // not speaking our protocol, treat like a lost connection
+    }
+}
+
+void Channel::shutdown() {
+    // only the descriptor is touched, so this is fine while another thread reads from the socket
+    ::shutdown(socket_.native_handle(), SHUT_RDWR);
+}
+
+Listener::Listener(std::string const &endpoint)
+    : acceptor_{ ctx_ } {
+    auto const ep = parse_endpoint(ctx_, endpoint);
+    acceptor_.open(ep.protocol());
+    if(endpoint.starts_with("unix:")) {
+        socket_path_ = endpoint.substr(5);
+        std::filesystem::remove(socket_path_); // left behind by a coordinator that did not exit cleanly
+    } else {
+        acceptor_.set_option(net::socket_base::reuse_address{ true });
+    }
+
+    acceptor_.bind(ep);
+    acceptor_.listen();
+}
+
+Listener::~Listener() {
+    auto ec = boost::system::error_code{};
+    acceptor_.close(ec);
+
+    auto fs_ec = std::error_code{};
+    if(not socket_path_.empty())
+        std::filesystem::remove(socket_path_, fs_ec);
+}
+
+std::unique_ptr<Channel> Listener::accept(std::chrono::milliseconds timeout) {
+    auto pfd = pollfd{ acceptor_.native_handle(), POLLIN, 0 };
+    if(::poll(&pfd, 1, static_cast<int>(timeout.count())) <= 0)
+        return nullptr;
+
+    auto ec     = boost::system::error_code{};
+    auto socket = acceptor_.accept(ec);
+    if(ec)
+        return nullptr;
+    return std::make_unique<Channel>(std::move(socket));
+}
+
+} // namespace distributed
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <boost/asio/basic_socket_acceptor.hpp>
+#include <boost/asio/generic/stream_protocol.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/streambuf.hpp>
+#include <inja/inja.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace distributed {
+
+using protocol_t = boost::asio::generic::stream_protocol;
+
+/**
+ * @brief Parses "unix:/path/to/socket", "tcp:host:port" or just "host:port"
+ */
+protocol_t::endpoint parse_endpoint(boost::asio::io_context &ctx, std::string const &spec);
+
+/**
+ * @brief A connection between coordinator and worker exchanging one JSON message per line
+ *
+ * Any number of threads may send; only one may receive.
+ */
+class Channel {
+    std::unique_ptr<boost::asio::io_context> ctx_; // only when connecting ourselves
+    protocol_t::socket socket_;
+    boost::asio::streambuf buffer_;
+    std::mutex send_mtx_;
+
+public:
+    /**
+     * @brief Connects to a listening coordinator
+     */
+    explicit Channel(std::string const &endpoint);
+    explicit Channel(protocol_t::socket &&socket);
+
+    Channel(Channel const &)            = delete;
+    Channel &operator=(Channel const &) = delete;
+
+    /**
+     * @brief Sends a message; returns false if the other side is gone
+     */
+    bool send(inja::json const &message);
+
+    /**
+     * @brief Blocks for the next message; nullopt once the other side is gone
+     */
+    std::optional<inja::json> receive();
+
+    /**
+     * @brief Makes a receive blocked on another thread return nullopt and further sends fail
+     */
+    void shutdown();
+};
+
+/**
+ * @brief Accepts channels on a Unix or TCP socket
+ */
+class Listener {
+    boost::asio::io_context ctx_;
+    boost::asio::basic_socket_acceptor<protocol_t> acceptor_;
+    std::filesystem::path socket_path_; // removed again for Unix sockets
+
+public:
+    explicit Listener(std::string const &endpoint);
+    ~Listener();
+
+    Listener(Listener const &)            = delete;
+    Listener &operator=(Listener const &) = delete;
+
+    /**
+     * @brief Waits up to timeout for the next connection; nullptr if there was none
+     */
+    std::unique_ptr<Channel> accept(std::chrono::milliseconds timeout);
+};
+
+} // namespace distributed
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <distributed/channel.hpp>
+#include <flow/duration_history.hpp>
+#include <metrics/registry.hpp>
+#include <reporting/event_json.hpp>
+#include <reporting/events.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace distributed {
+
+/**
+ * @brief Hands out flows to worker processes and collects their results
+ *
+ * Workers connect at any time and announce how many flows they run at once. Whenever a
+ * worker has a free slot it gets the next flow from a shared queue, so fast workers simply
+ * take more work. Results and latencies are streamed back and recorded as if the flows ran
+ * here. If a worker disappears, the flows it was running fail and the run goes on with the
+ * remaining workers. A worker that holds flows but sends nothing, not even its heartbeat, for
+ * longer than the lease timeout is dropped and its flows are handed to the other workers, which
+ * is why workers are only told to stop once every flow has a result.
+ *
+ * @tparam ReportEngineType
+ */
+template <typename ReportEngineType>
+class Coordinator {
+    using reporting_t = ReportEngineType;
+    using clock_t     = std::chrono::steady_clock;
+
+    static constexpr auto accept_timeout = std::chrono::milliseconds{ 100 };
+
+    /**
+     * @brief A connected worker as seen by the thread accepting new ones
+     */
+    struct Peer {
+        std::shared_ptr<Channel> channel;
+        std::atomic<clock_t::rep> last_heard = clock_t::now().time_since_epoch().count();
+        std::atomic_bool holds_flows         = false;
+        std::atomic_bool expired             = false; // its lease ran out, the flows go back to pending_
+
+        explicit Peer(std::shared_ptr<Channel> channel)
+            : channel{ std::move(channel) } { }
+
+        void heard() {
+            last_heard = clock_t::now().time_since_epoch().count();
+        }
+    };
+
+    reporting_t &reporting_;
+    std::string endpoint_;
+    DurationHistory *durations_;
+    std::chrono::milliseconds lease_timeout_;
+
+    std::mutex mtx_;
+    std::deque<std::string> pending_;
+    std::size_t remaining_ = 0;
+    std::vector<UsageSummaryEvent::Row> usage_rows_;
+
+public:
+    static constexpr auto default_lease_timeout = std::chrono::milliseconds{ 10000 };
+
+    /**
+     * @param reporting Where the results of all workers are recorded
+     * @param endpoint unix:/path or host:port to listen on
+     * @param flows Names of the flows to run, in the order they should be started
+     * @param durations Updated with the durations reported by workers; may be null
+     * @param lease_timeout How long a worker holding flows may stay silent
+     */
+    Coordinator(reporting_t &reporting, std::string endpoint, std::vector<std::string> const &flows, DurationHistory *durations = nullptr,
+        std::chrono::milliseconds lease_timeout = default_lease_timeout)
+        : reporting_{ reporting }
+        , endpoint_{ std::move(endpoint) }
+        , durations_{ durations }
+        , lease_timeout_{ lease_timeout }
+        , pending_{ std::begin(flows), std::end(flows) }
+        , remaining_{ flows.size() } { }
+
+    /**
+     * @brief Serves workers until every flow has a result
+     */
+    void run() {
+        auto listener = Listener{ endpoint_ };
+        reporting_.record(SimpleEvent{ "COORDINATE", fmt::format("{} flows, waiting for workers on {}", remaining_, endpoint_) });
+
+        auto peers   = std::vector<std::shared_ptr<Peer>>{};
+        auto workers = std::vector<std::thread>{};
+        while(not finished()) {
+            if(auto channel = listener.accept(accept_timeout)) {
+                peers.push_back(std::make_shared<Peer>(std::move(channel)));
+                workers.emplace_back([this, peer = peers.back()] {
+                    serve(*peer);
+                });
+            }
+            expire_silent(peers);
+        }
+
+        // peers that never said hello would keep their thread waiting; with nothing left to run
+        // a closed channel means the same to a worker as being told to stop
+        for(auto &peer : peers)
+            peer->channel->shutdown();
+        for(auto &worker : workers)
+            worker.join();
+
+        std::sort(std::begin(usage_rows_), std::end(usage_rows_), [](auto const &a, auto const &b) {
+            return a.flow_name < b.flow_name;
+        });
+        if(not usage_rows_.empty())
+            reporting_.record(UsageSummaryEvent{ std::move(usage_rows_) });
+        reporting_.summarize();
+        if(durations_)
+            durations_->store();
+    }
+
+private:
+    bool finished() {
+        std::scoped_lock l{ mtx_ };
+        return remaining_ == 0;
+    }
+
+    // the watchdog for workers that keep their connection open but stopped talking
+    void expire_silent(std::vector<std::shared_ptr<Peer>> &peers) {
+        auto const deadline = (clock_t::now() - lease_timeout_).time_since_epoch().count();
+        for(auto &peer : peers) {
+            if(peer->holds_flows and peer->last_heard < deadline and not peer->expired.exchange(true))
+                peer->channel->shutdown(); // its serve thread hands the flows back
+        }
+    }
+
+    void serve(Peer &peer) {
+        auto &channel = *peer.channel;
+        auto name     = std::string{ "worker" };
+        auto running  = std::set<std::string>{};
+        try {
+            auto const hello = channel.receive();
+            if(not hello or hello->value("type", "") != "hello")
+                return;
+
+            auto const slots = std::max<std::size_t>(1, hello->value("jobs", std::size_t{ 1 }));
+            name             = hello->value("name", name);
+            reporting_.record(SimpleEvent{ "WORKER", fmt::format("{} joined with {} slot(s)", name, slots) });
+
+            while(true) {
+                // taken under the lock, sent without it so that a slow worker doesn't hold up the others
+                auto handout = std::vector<std::string>{};
+                {
+                    std::scoped_lock l{ mtx_ };
+                    while(running.size() + handout.size() < slots and not pending_.empty()) {
+                        handout.push_back(std::move(pending_.front()));
+                        pending_.pop_front();
+                    }
+                }
+
+                // an idle worker stays until every flow has a result, flows of a worker that goes silent
+                // may still come back; its heartbeats bring it here again to look for them
+                if(running.empty() and handout.empty() and finished()) {
+                    channel.send({ { "type", "stop" } });
+                    return;
+                }
+
+                if(not handout.empty()) {
+                    peer.heard(); // the lease starts with the handout
+                    peer.holds_flows = true;
+                }
+                for(auto &flow : handout) {
+                    channel.send({ { "type", "run" }, { "flow", flow } });
+                    running.insert(std::move(flow));
+                }
+
+                auto const message = channel.receive();
+                if(not message and peer.expired)
+                    return requeue(running, name);
+                if(not message)
+                    return lost(running, fmt::format("Lost {} while it was running the flow", name));
+
+                peer.heard();
+                if(message->value("type", "") != "event")
+                    continue; // e.g. a heartbeat
+
+                auto const &event = message->at("event");
+                auto const type   = event.value("event", "");
+                if(type == "latency") {
+                    reporting_.record(event_json::to_latency(event));
+                } else if(type == "success" or type == "failure") {
+                    auto const flow = running.find(event.at("flow").template get<std::string>());
+                    if(flow == std::end(running))
+                        continue; // not handed to this worker, nothing to complete
+
+                    // converted before the flow is forgotten so that a malformed event still fails it
+                    if(type == "success") {
+                        auto ev = event_json::to_success(event);
+                        running.erase(flow);
+                        complete(std::move(ev));
+                    } else {
+                        auto ev = event_json::to_failure(event);
+                        running.erase(flow);
+                        complete(std::move(ev));
+                    }
+                    peer.holds_flows = not running.empty();
+                }
+            }
+        } catch(inja::json::exception const &) {
+            channel.shutdown();
+            lost(running, fmt::format("{} sent a malformed message while it was running the flow", name));
+        }
+    }
+
+    void requeue(std::set<std::string> const &running, std::string const &name) {
+        if(running.empty())
+            return;
+        {
+            std::scoped_lock l{ mtx_ };
+            pending_.insert(std::begin(pending_), std::begin(running), std::end(running));
+        }
+        reporting_.record(SimpleEvent{ "WORKER", fmt::format("{} went silent, handing {} flow(s) to other workers", name, running.size()) });
+    }
+
+    void lost(std::set<std::string> const &running, std::string const &reason) {
+        for(auto const &flow : running)
+            complete(FailureEvent{ flow, flow,
+                { { FailureEvent::Data::Type::LOGIC_ERROR, flow, reason } },
+                "No data" });
+    }
+
+    template <typename EventType>
+    void complete(EventType &&ev) {
+        constexpr auto passed = std::is_same_v<std::decay_t<EventType>, SuccessEvent>;
+        if constexpr(passed)
+            metrics::Registry::instance().flows_passed.fetch_add(1, std::memory_order_relaxed);
+        else
+            metrics::Registry::instance().flows_failed.fetch_add(1, std::memory_order_relaxed);
+
+        {
+            std::scoped_lock l{ mtx_ };
+            usage_rows_.push_back({ ev.flow_name, passed, ev.duration, ev.usage });
+            if(durations_ and passed)
+                durations_->record(ev.flow_name, ev.duration);
+            --remaining_;
+        }
+        reporting_.record(std::forward<EventType>(ev));
+    }
+};
+
+} // namespace distributed
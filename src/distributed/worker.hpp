@@ -0,0 +1,114 @@
+#pragma once
+
+#include <distributed/channel.hpp>
+#include <reporting/events.hpp>
+
+#include <fmt/format.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <map>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace distributed {
+
+/**
+ * @brief Runs the flows a coordinator hands out until it says stop
+ *
+ * Results reach the coordinator through the RemoteRenderer of the report engine, so the
+ * engine must render synchronously for a result to be sent before the slot is reused.
+ *
+ * @tparam SchedulerType
+ * @tparam ReportEngineType
+ */
+template <typename SchedulerType, typename ReportEngineType>
+class Worker {
+    using scheduler_t = SchedulerType;
+    using reporting_t = ReportEngineType;
+
+    // well within the lease timeout of the coordinator
+    static constexpr auto heartbeat_interval = std::chrono::seconds{ 1 };
+
+    scheduler_t &scheduler_;
+    reporting_t &reporting_;
+    Channel &channel_;
+    std::map<std::string, std::string> flows_;
+    std::size_t slots_;
+
+public:
+    /**
+     * @param flows Name -> directory of every flow of the local copy of the suite
+     * @param slots How many flows to run at once
+     */
+    Worker(scheduler_t &scheduler, reporting_t &reporting, Channel &channel, std::map<std::string, std::string> flows, std::size_t slots)
+        : scheduler_{ scheduler }
+        , reporting_{ reporting }
+        , channel_{ channel }
+        , flows_{ std::move(flows) }
+        , slots_{ std::max<std::size_t>(1, slots) } { }
+
+    void run() {
+        auto host = std::array<char, 256>{};
+        ::gethostname(host.data(), host.size() - 1);
+        channel_.send({ { "type", "hello" }, { "jobs", slots_ }, { "name", fmt::format("{}:{}", host.data(), ::getpid()) } });
+
+        // keeps the leases of our flows alive on the coordinator however long a flow takes
+        auto heartbeat = std::jthread{ [this](std::stop_token stop) {
+            auto mtx  = std::mutex{};
+            auto cv   = std::condition_variable_any{};
+            auto lock = std::unique_lock{ mtx };
+            while(not cv.wait_for(lock, stop, heartbeat_interval, [] { return false; }) and not stop.stop_requested())
+                channel_.send({ { "type", "heartbeat" } });
+        } };
+
+        // the coordinator never hands out more than slots_ flows at once, so one thread per flow is bounded
+        auto running = std::vector<std::future<void>>{};
+        while(auto message = channel_.receive()) {
+            auto const type = message->value("type", "");
+            if(type == "stop")
+                break;
+            if(type != "run")
+                continue;
+
+            std::erase_if(running, [](auto &flow) {
+                return flow.wait_for(std::chrono::seconds{ 0 }) == std::future_status::ready;
+            });
+            running.push_back(std::async(std::launch::async, [this, name = message->at("flow").template get<std::string>()] {
+                run_one(name);
+            }));
+        }
+
+        for(auto &flow : running)
+            flow.get();
+    }
+
+private:
+    void run_one(std::string const &name) {
+        auto const fail = [this, &name](std::string const &message) {
+            reporting_.record(FailureEvent{ name, name, { { FailureEvent::Data::Type::LOGIC_ERROR, name, message } }, "No data" });
+        };
+
+        auto const flow = flows_.find(name);
+        if(flow == std::end(flows_))
+            return fail("Flow is not part of the suite on this worker");
+
+        try {
+            scheduler_.run_one(name, flow->second);
+        } catch(std::exception const &e) {
+            // anything but a flow failure would otherwise leave the coordinator waiting for a result
+            fail(fmt::format("Flow aborted on worker: {}", e.what()));
+        }
+    }
+};
+
+} // namespace distributed
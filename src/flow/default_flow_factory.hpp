@@ -1,5 +1,6 @@
 #pragma once
 
+#include <flow/fixture_cache.hpp>
 #include <flow/flow.hpp>
 #include <flow/impl/steps_vec_loader.hpp>
 #include <flow/impl/yaml_file_loader.hpp>
@@ -21,6 +22,8 @@ public:
     using reporting_t = ReportEngineType;
     using flow_t      = Flow<con_man_t, reporting_t, Validator, DefaultFlowFactory<con_man_t, reporting_t>>;
 
+    using fixtures_t  = FixtureCache<store_t>;
+
     using services_t = di::Deps<con_man_t, reporting_t>;
 
     DefaultFlowFactory(services_t services)
@@ -44,6 +47,11 @@ public:
         };
     }
 
+    fixtures_t &fixtures() {
+        return fixtures_;
+    }
+
 private:
     services_t services_;
+    fixtures_t fixtures_;
 };
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+#include <map>
 #include <string>
 #include <variant>
 #include <vector>
@@ -18,21 +20,38 @@ struct Meta {
     std::vector<std::string> revisions;
 };
 
+// a timeout of zero means none was given
+
 struct Request {
     std::string file;
+    std::chrono::milliseconds timeout{}; // default for the responses to this request
 };
 
 struct Response {
     std::string file;
+    bool stream = false;
+    std::map<std::string, std::string> store; // variable -> JSON pointer; only used when streaming
+    std::chrono::milliseconds timeout{};      // how long to wait for the response
 };
 
 struct RunFlow {
     std::string name;
+    bool fixture = false;
+    std::vector<std::string> keys; // only for fixtures: what to copy from their store; empty for everything
 };
 
 struct RepeatBlock {
     std::vector<Step> steps;
     uint32_t repeat;
+    std::chrono::milliseconds timeout{}; // for all repetitions together
+};
+
+/**
+ * @brief Contents of a script.yaml
+ */
+struct Script {
+    std::vector<Step> steps;
+    std::chrono::milliseconds timeout{}; // for the whole flow
 };
 
 } // namespace descriptor
@@ -0,0 +1,90 @@
+#include <flow/duration_history.hpp>
+#include <util/state_file.hpp>
+
+#include <inja/inja.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <queue>
+
+DurationHistory::DurationHistory(std::filesystem::path path)
+    : path_{ std::move(path) } {
+    auto const ok = util::load_versioned_json(path_, version, [this](inja::json const &history) {
+        for(auto const &[flow, ms] : history.at("flows").items())
+            durations_[flow] = duration_t{ ms.get<duration_t::rep>() };
+        return true;
+    });
+    if(not ok)
+        durations_.clear(); // corrupt, start over
+}
+
+std::optional<DurationHistory::duration_t> DurationHistory::find(std::string const &flow) const {
+    if(auto it = durations_.find(flow); it != std::end(durations_))
+        return it->second;
+    return std::nullopt;
+}
+
+void DurationHistory::record(std::string const &flow, duration_t duration) {
+    if(frozen_)
+        return;
+    auto [it, inserted] = durations_.try_emplace(flow, duration);
+    if(not inserted)
+        it->second = duration_t{ static_cast<duration_t::rep>(weight * duration.count() + (1 - weight) * it->second.count()) };
+}
+
+void DurationHistory::freeze() {
+    frozen_ = true;
+}
+
+std::vector<DurationHistory::Prediction> DurationHistory::predict(std::vector<std::string> const &flows) const {
+    auto known = std::vector<duration_t>{};
+    for(auto const &flow : flows)
+        if(auto duration = find(flow))
+            known.push_back(*duration);
+
+    auto const average = known.empty()
+        ? duration_t{ 0 }
+        : std::accumulate(std::begin(known), std::end(known), duration_t{ 0 }) / static_cast<duration_t::rep>(known.size());
+
+    auto predictions = std::vector<Prediction>{};
+    for(auto const &flow : flows)
+        predictions.push_back({ flow, find(flow).value_or(average) });
+    return predictions;
+}
+
+void DurationHistory::store() const {
+    if(frozen_)
+        return;
+    auto flows = inja::json::object();
+    for(auto const &[flow, duration] : durations_)
+        flows[flow] = duration.count();
+
+    auto const history = inja::json{ { "version", version }, { "flows", std::move(flows) } };
+    util::write_file_atomically(path_, history.dump(2));
+}
+
+void sort_longest_first(std::vector<DurationHistory::Prediction> &flows) {
+    // ties broken by name so that the order is the same on every machine
+    std::sort(std::begin(flows), std::end(flows), [](auto const &a, auto const &b) {
+        return a.duration != b.duration ? a.duration > b.duration : a.name < b.name;
+    });
+}
+
+DurationHistory::duration_t makespan(std::vector<DurationHistory::Prediction> const &flows, std::size_t workers) {
+    using duration_t = DurationHistory::duration_t;
+
+    // time at which each worker becomes free, earliest on top
+    auto free_at = std::priority_queue<duration_t, std::vector<duration_t>, std::greater<>>{};
+    for(auto i = std::size_t{ 0 }; i < std::max<std::size_t>(workers, 1); ++i)
+        free_at.push(duration_t{ 0 });
+
+    auto end = duration_t{ 0 };
+    for(auto const &flow : flows) {
+        auto const start = free_at.top();
+        free_at.pop();
+        free_at.push(start + flow.duration);
+        end = std::max(end, start + flow.duration);
+    }
+    return end;
+}
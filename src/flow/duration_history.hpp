@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Durations of passed flows observed by previous runs
+ *
+ * Every flow keeps an exponentially weighted average so that a single slow run does not
+ * reshuffle the whole schedule. Stored as JSON; a missing or corrupt file is treated as empty.
+ */
+class DurationHistory {
+public:
+    using duration_t = std::chrono::milliseconds;
+
+    static constexpr auto file_name = ".cliot-durations.json";
+    static constexpr int version    = 1;
+    static constexpr double weight  = 0.3; // of the newest sample
+
+    struct Prediction {
+        std::string name;
+        duration_t duration;
+    };
+
+    explicit DurationHistory(std::filesystem::path path);
+
+    std::optional<duration_t> find(std::string const &flow) const;
+    void record(std::string const &flow, duration_t duration);
+
+    /**
+     * @brief Expected duration of every given flow; flows never seen before are assumed to take the average
+     */
+    std::vector<Prediction> predict(std::vector<std::string> const &flows) const;
+
+    /**
+     * @brief Writes the history back to disk; failing to do so only costs a worse schedule next time
+     */
+    void store() const;
+
+    /**
+     * @brief Makes record() and store() no-ops from now on
+     *
+     * Shards partition the suite by this history, so a shard must not change it for the
+     * shards that run after it.
+     */
+    void freeze();
+
+private:
+    std::filesystem::path path_;
+    bool frozen_ = false;
+    std::map<std::string, duration_t> durations_;
+};
+
+/**
+ * @brief Orders flows longest first (LPT) so that short flows fill the gaps at the end of a parallel run
+ */
+void sort_longest_first(std::vector<DurationHistory::Prediction> &flows);
+
+/**
+ * @brief Wall time of running the flows in the given order on the given number of workers,
+ * each worker picking the next flow as soon as it is free
+ */
+DurationHistory::duration_t makespan(std::vector<DurationHistory::Prediction> const &flows, std::size_t workers);
@@ -1,20 +1,30 @@
 #pragma once
 
+#include <reporting/artifact_store.hpp>
 #include <reporting/events.hpp>
 
 #include <exception>
 #include <string>
 #include <vector>
 
+/**
+ * @brief Thrown when a step fails
+ *
+ * Large responses and details are handed to the ArtifactStore on construction so that
+ * an exception travelling up through subflows and blocks only carries references.
+ */
 struct FlowException : public std::runtime_error {
     FlowException(
         std::string const &path,
-        std::vector<FailureEvent::Data> const &issues,
-        std::string const &response)
+        std::vector<FailureEvent::Data> issues,
+        std::string response)
         : std::runtime_error{ "FlowException" }
         , path{ path }
-        , issues{ issues }
-        , response{ response } { }
+        , issues{ std::move(issues) }
+        , response{ ArtifactStore::instance().spill(std::move(response)) } {
+        for(auto &issue : this->issues)
+            issue.detail = ArtifactStore::instance().spill(std::move(issue.detail));
+    }
 
     std::string path;
     std::vector<FailureEvent::Data> issues;
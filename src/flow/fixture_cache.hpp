@@ -0,0 +1,144 @@
+#pragma once
+
+#include <flow/exceptions.hpp>
+#include <flow/timeouts.hpp>
+#include <reporting/events.hpp>
+
+#include <fmt/format.h>
+
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Keeps the resulting store of every fixture subflow executed during this run
+ *
+ * A fixture is executed at most once; every other flow that depends on it waits for
+ * the first execution to finish and then receives the very same immutable snapshot.
+ * If the fixture fails, all dependents observe the same exception.
+ *
+ * Fixtures that end up waiting for themselves, directly or through fixtures running on other
+ * threads, fail instead of waiting forever. Dependents only wait as long as their own deadlines allow.
+ *
+ * @tparam StoreType
+ */
+template <typename StoreType>
+class FixtureCache {
+public:
+    using store_t    = StoreType;
+    using snapshot_t = std::shared_ptr<store_t const>;
+
+private:
+    std::mutex mtx_;
+    std::map<std::string, std::shared_future<snapshot_t>> fixtures_;
+    std::map<std::string, std::thread::id> running_; // fixture -> thread executing it
+    std::map<std::thread::id, std::string> waiting_; // thread -> fixture it waits for
+
+public:
+    /**
+     * @brief Returns the snapshot for the fixture at given path, executing it via fn if needed
+     *
+     * @param path Path of the fixture flow; used as the cache key
+     * @param fn Callable returning the resulting store of the fixture
+     * @return snapshot_t
+     * @throws FlowException if waiting for the fixture would never end or outlasts the caller's deadlines
+     */
+    template <typename Fn>
+    snapshot_t get_or_run(std::string const &path, Fn &&fn) {
+        auto const self = std::this_thread::get_id();
+        std::promise<snapshot_t> promise;
+        std::shared_future<snapshot_t> snapshot;
+        bool owner = false;
+        {
+            std::scoped_lock l{ mtx_ };
+            auto [it, inserted] = fixtures_.try_emplace(path);
+            if(inserted) {
+                it->second = promise.get_future().share();
+                running_.emplace(path, self);
+            } else if(waits_for_itself(path, self)) {
+                throw FlowException(path, { { FailureEvent::Data::Type::LOGIC_ERROR, path, fmt::format("Fixture {} depends on itself", path) } }, "No data");
+            } else {
+                waiting_.insert_or_assign(self, path);
+            }
+            snapshot = it->second;
+            owner    = inserted;
+        }
+
+        if(owner) {
+            try {
+                promise.set_value(std::make_shared<store_t const>(fn()));
+            } catch(...) {
+                promise.set_exception(std::current_exception());
+            }
+            std::scoped_lock l{ mtx_ };
+            running_.erase(path);
+        } else {
+            auto const budget = Timeouts::remaining();
+            if(budget.wait.count() == 0)
+                snapshot.wait();
+            auto const ready = snapshot.wait_for(budget.wait) == std::future_status::ready;
+            {
+                std::scoped_lock l{ mtx_ };
+                waiting_.erase(self);
+            }
+            if(not ready)
+                throw FlowException(path, { { FailureEvent::Data::Type::TIMEOUT, path, budget.reason } }, "No data");
+        }
+
+        return snapshot.get(); // rethrows if the fixture failed
+    }
+
+    /**
+     * @brief Copies a snapshot into the store of a dependent flow
+     *
+     * Only the given keys are copied, or everything but the last response ($res) if there are none.
+     * A fixture without env.json that stored nothing leaves a null snapshot, which adds nothing.
+     *
+     * @throws FlowException if the fixture at path did not store one of the keys
+     */
+    static void fork(std::string const &path, store_t &store, snapshot_t const &snapshot, std::vector<std::string> const &keys = {}) {
+        if(keys.empty()) {
+            if(snapshot->is_object())
+                for(auto const &[key, value] : snapshot->items())
+                    if(key != "$res")
+                        store[key] = value;
+            return;
+        }
+
+        for(auto const &key : keys) {
+            if(not snapshot->is_object() or not snapshot->contains(key))
+                throw FlowException(path, { { FailureEvent::Data::Type::LOGIC_ERROR, path, fmt::format("Fixture {} did not store {}", path, key) } }, "No data");
+            store[key] = snapshot->at(key);
+        }
+    }
+
+    /**
+     * @brief Forgets all fixtures so that the next run executes them again
+     */
+    void clear() {
+        std::scoped_lock l{ mtx_ };
+        fixtures_.clear();
+    }
+
+private:
+    // follows the threads running the fixture and whatever they wait for in turn
+    bool waits_for_itself(std::string path, std::thread::id self) const {
+        for(auto steps = running_.size(); steps > 0; --steps) {
+            auto const owner = running_.find(path);
+            if(owner == std::end(running_))
+                return false;
+            if(owner->second == self)
+                return true;
+
+            auto const next = waiting_.find(owner->second);
+            if(next == std::end(waiting_))
+                return false;
+            path = next->second;
+        }
+        return false;
+    }
+};
@@ -17,6 +17,7 @@
 #include <fmt/compile.h>
 #include <inja/inja.hpp>
 
+#include <chrono>
 #include <filesystem>
 #include <iostream>
 #include <optional>
@@ -49,34 +50,46 @@ public:
 private:
     services_t services_;
     std::vector<step_t> steps_;
+    std::chrono::milliseconds timeout_;
 
 public:
     template <typename Loader>
     explicit Flow(services_t services, Loader const &loader)
-        : services_{ services }
-        , steps_{ load_from(loader.load(), loader.base_path()) } { }
+        : Flow{ services, loader.load(), loader.base_path() } { }
 
     std::vector<step_t> const &steps() const {
         return steps_;
     }
 
+    /**
+     * @brief Time the whole flow may take; zero if none was given
+     */
+    std::chrono::milliseconds timeout() const {
+        return timeout_;
+    }
+
 private:
+    Flow(services_t services, descriptor::Script const &script, std::filesystem::path const &base_path)
+        : services_{ services }
+        , steps_{ load_from(script.steps, base_path) }
+        , timeout_{ script.timeout } { }
+
     std::vector<step_t> load_from(std::vector<descriptor::Step> const &descriptors, std::filesystem::path const &base_path) {
         std::vector<step_t> steps;
         for(auto const &step : descriptors) {
             // clang-format off
             std::visit( overloaded {
                 [this, &steps, &base_path](descriptor::Request const &req) {
-                    steps.push_back(request_step_t{ services_, base_path / req.file });
+                    steps.push_back(request_step_t{ services_, base_path / req.file, req.timeout });
                 },
                 [this, &steps, &base_path](descriptor::Response const &resp) {
-                    steps.push_back(response_step_t{ services_, base_path / resp.file });
+                    steps.push_back(response_step_t{ services_, base_path / resp.file, resp.stream, resp.store, resp.timeout });
                 },
                 [this, &steps, &base_path](descriptor::RunFlow const &flow) {
-                    steps.push_back(run_flow_step_t{ services_, base_path.parent_path().parent_path() / flow.name });
+                    steps.push_back(run_flow_step_t{ services_, base_path.parent_path().parent_path() / flow.name, flow.fixture, flow.keys });
                 },
                 [this, &steps, &base_path](descriptor::RepeatBlock const &block) {
-                    steps.push_back(repeat_block_step_t{ services_, base_path, block.repeat, block.steps });
+                    steps.push_back(repeat_block_step_t{ services_, base_path, block.repeat, block.steps, block.timeout });
                 }},
             step);
             // clang-format on
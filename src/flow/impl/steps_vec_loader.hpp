@@ -16,8 +16,8 @@ public:
         : base_path_{ base_path }
         , steps_{ steps } { }
 
-    std::vector<descriptor::Step> load() const {
-        return steps_;
+    descriptor::Script load() const {
+        return { steps_ }; // a block's timeout is enforced by the block itself
     }
 
     std::filesystem::path base_path() const {
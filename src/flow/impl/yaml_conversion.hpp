@@ -4,12 +4,24 @@
 
 #include <yaml-cpp/yaml.h>
 
+#include <chrono>
+
 namespace YAML {
 
+template <>
+struct convert<std::chrono::milliseconds> {
+    static bool decode(const Node &node, std::chrono::milliseconds &rhs) {
+        rhs = std::chrono::milliseconds{ node.as<std::chrono::milliseconds::rep>() };
+        return rhs.count() >= 0;
+    }
+};
+
 template <>
 struct convert<descriptor::Request> {
     static bool decode(const Node &node, descriptor::Request &rhs) {
         rhs.file = node["file"].as<std::string>();
+        if(node["timeout"])
+            rhs.timeout = node["timeout"].as<std::chrono::milliseconds>();
         return true;
     }
 };
@@ -18,6 +30,12 @@ template <>
 struct convert<descriptor::Response> {
     static bool decode(const Node &node, descriptor::Response &rhs) {
         rhs.file = node["file"].as<std::string>();
+        if(node["stream"])
+            rhs.stream = node["stream"].as<bool>();
+        if(node["store"])
+            rhs.store = node["store"].as<std::map<std::string, std::string>>();
+        if(node["timeout"])
+            rhs.timeout = node["timeout"].as<std::chrono::milliseconds>();
         return true;
     }
 };
@@ -26,6 +44,10 @@ template <>
 struct convert<descriptor::RunFlow> {
     static bool decode(const Node &node, descriptor::RunFlow &rhs) {
         rhs.name = node["name"].as<std::string>();
+        if(node["fixture"])
+            rhs.fixture = node["fixture"].as<bool>();
+        if(node["keys"])
+            rhs.keys = node["keys"].as<std::vector<std::string>>();
         return true;
     }
 };
@@ -35,6 +57,8 @@ struct convert<descriptor::RepeatBlock> {
     static bool decode(const Node &node, descriptor::RepeatBlock &rhs) {
         if(node["repeat"])
             rhs.repeat = node["repeat"].as<uint32_t>();
+        if(node["timeout"])
+            rhs.timeout = node["timeout"].as<std::chrono::milliseconds>();
         rhs.steps = node["steps"].as<std::vector<descriptor::Step>>();
         return true;
     }
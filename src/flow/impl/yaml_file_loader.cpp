@@ -1,3 +1,4 @@
+#include <bundle/bundle.hpp>
 #include <flow/impl/yaml_conversion.hpp>
 #include <flow/impl/yaml_file_loader.hpp>
 
@@ -11,15 +12,21 @@ namespace impl {
 
 YamlFileLoader::YamlFileLoader(std::filesystem::path const &base_path)
     : base_path_{ base_path } {
-    assert(std::filesystem::is_directory(base_path));
+    assert(bundle::Bundle::active() or std::filesystem::is_directory(base_path));
 }
 
-std::vector<descriptor::Step> YamlFileLoader::load() const {
+descriptor::Script YamlFileLoader::load() const {
     auto script_path = base_path_ / "script.yaml";
+    if(auto const *bundle = bundle::Bundle::active())
+        return bundle->script(script_path);
+
     assert(std::filesystem::exists(script_path));
 
     YAML::Node doc = YAML::LoadFile(script_path.string());
-    return doc["steps"].as<std::vector<descriptor::Step>>();
+    auto script    = descriptor::Script{ doc["steps"].as<std::vector<descriptor::Step>>() };
+    if(doc["timeout"])
+        script.timeout = doc["timeout"].as<std::chrono::milliseconds>();
+    return script;
 }
 
 std::filesystem::path YamlFileLoader::base_path() const {
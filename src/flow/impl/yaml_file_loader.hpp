@@ -12,7 +12,7 @@ class YamlFileLoader {
 
 public:
     YamlFileLoader(std::filesystem::path const &base_path);
-    std::vector<descriptor::Step> load() const;
+    descriptor::Script load() const;
     std::filesystem::path base_path() const;
 };
 
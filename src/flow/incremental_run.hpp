@@ -0,0 +1,58 @@
+#pragma once
+
+#include <flow/input_hasher.hpp>
+#include <flow/results_db.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+
+/**
+ * @brief Decides which flows need to run again and remembers how they went
+ *
+ * A flow is skipped if it passed last time against the same server and none of its
+ * transitive inputs changed since.
+ */
+class IncrementalRun {
+    ResultsDb db_;
+    std::string server_;
+    InputHasher hasher_;
+    std::map<std::string, std::uint64_t> hashes_; // of the flows checked during this run
+
+public:
+    /**
+     * @param db_path Where the results of previous runs are kept
+     * @param server Identity of the server the flows run against, e.g. "host:port"
+     */
+    IncrementalRun(std::filesystem::path const &db_path, std::string server)
+        : db_{ db_path }
+        , server_{ std::move(server) } { }
+
+    /**
+     * @brief Starts a new run; inputs are hashed afresh from here on
+     */
+    void begin() {
+        hasher_ = InputHasher{};
+        hashes_.clear();
+    }
+
+    bool is_up_to_date(std::string const &name, std::filesystem::path const &dir) {
+        auto const hash     = hasher_.flow(dir);
+        auto const previous = db_.find(server_, name);
+        hashes_[name]       = hash;
+        return previous and previous->passed and previous->hash == hash;
+    }
+
+    /**
+     * @brief Records the result of a flow checked by is_up_to_date() during this run
+     */
+    void record(std::string const &name, bool passed) {
+        if(auto it = hashes_.find(name); it != std::end(hashes_))
+            db_.update(server_, name, { it->second, passed });
+    }
+
+    void finish() const {
+        db_.store();
+    }
+};
@@ -0,0 +1,111 @@
+#include <bundle/bundle.hpp>
+#include <flow/impl/yaml_file_loader.hpp>
+#include <flow/input_hasher.hpp>
+#include <util/hash.hpp>
+#include <util/overloaded.hpp>
+#include <util/template_includes.hpp>
+
+#include <fmt/format.h>
+
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <variant>
+
+namespace {
+std::string key_of(std::filesystem::path const &path) {
+    auto key = path.lexically_normal();
+    if(not key.has_filename())
+        key = key.parent_path();
+    return key.string();
+}
+
+std::optional<std::string> read(std::filesystem::path const &path) {
+    if(auto const *bundle = bundle::Bundle::active()) {
+        if(auto const *entry = bundle->find(path))
+            return std::string{ entry->data };
+        return std::nullopt;
+    }
+
+    auto in = std::ifstream{ path, std::ios::binary };
+    if(not in)
+        return std::nullopt;
+
+    auto ss = std::stringstream{};
+    ss << in.rdbuf();
+    return ss.str();
+}
+} // namespace
+
+std::uint64_t InputHasher::flow(std::filesystem::path const &dir) {
+    auto const key = key_of(dir);
+    if(auto it = flows_.find(key); it != std::end(flows_))
+        return it->second;
+    if(not visiting_.insert(key).second)
+        return 0; // the flow runs itself; the cycle fails at run time either way
+
+    // every input is added as "<what>:<hash>;" so that moving content between files changes the result
+    auto inputs = std::string{};
+    auto script = read(dir / "script.yaml");
+    fmt::format_to(std::back_inserter(inputs), "script:{:016x};", script ? util::fnv1a(*script) : 0);
+    fmt::format_to(std::back_inserter(inputs), "env:{:016x};", file(dir / "env.json"));
+    if(script) {
+        try {
+            add_steps(inputs, dir, impl::YamlFileLoader{ dir }.load().steps);
+        } catch(std::exception const &) {
+            // a script that does not load fails when it runs; its own hash already marks it as changed
+        }
+    }
+
+    visiting_.erase(key);
+    return flows_[key] = util::fnv1a(inputs);
+}
+
+std::uint64_t InputHasher::file(std::filesystem::path const &path) {
+    auto const key = key_of(path);
+    if(auto it = files_.find(key); it != std::end(files_))
+        return it->second;
+
+    auto const source = read(path);
+    if(not source)
+        return files_[key] = 0;
+    if(not visiting_.insert(key).second)
+        return 0;
+
+    auto inputs = fmt::format("{:016x};", util::fnv1a(*source));
+    if(auto const *bundle = bundle::Bundle::active()) {
+        // includes were already resolved to keys relative to the root when packing
+        for(auto const &include : bundle->find(path)->includes)
+            fmt::format_to(std::back_inserter(inputs), "{}:{:016x};", include, file(bundle->root() / include));
+    } else {
+        for(auto const &include : util::find_includes(*source))
+            fmt::format_to(std::back_inserter(inputs), "{}:{:016x};", include.name, file(path.parent_path() / include.name));
+    }
+
+    visiting_.erase(key);
+    return files_[key] = util::fnv1a(inputs);
+}
+
+void InputHasher::add_steps(std::string &inputs, std::filesystem::path const &dir, std::vector<descriptor::Step> const &steps) {
+    auto out = std::back_inserter(inputs);
+    for(auto const &step : steps) {
+        // clang-format off
+        std::visit(overloaded {
+            [&, this](descriptor::Request const &req) {
+                fmt::format_to(out, "{}:{:016x};", req.file, file(dir / req.file));
+            },
+            [&, this](descriptor::Response const &resp) {
+                fmt::format_to(out, "{}:{:016x};", resp.file, file(dir / resp.file));
+            },
+            [&, this](descriptor::RunFlow const &subflow) {
+                // same resolution as step::RunFlow: a sibling of this flow's directory
+                auto const subflow_dir = std::filesystem::path{ key_of(dir) }.parent_path() / subflow.name;
+                fmt::format_to(out, "flow {}:{:016x};", subflow.name, flow(subflow_dir));
+            },
+            [&, this](descriptor::RepeatBlock const &block) {
+                add_steps(inputs, dir, block.steps);
+            }},
+        step);
+        // clang-format on
+    }
+}
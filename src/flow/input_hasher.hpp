@@ -0,0 +1,34 @@
+#pragma once
+
+#include <flow/descriptors.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Hashes everything a flow reads: its script, templates with all their includes,
+ * env.json and, recursively, the same for every subflow it runs
+ *
+ * Results are memoized, so create a new hasher whenever the files may have changed.
+ * Reads from the active bundle if there is one.
+ */
+class InputHasher {
+public:
+    /**
+     * @brief Hash of the transitive inputs of the flow in the given directory
+     */
+    std::uint64_t flow(std::filesystem::path const &dir);
+
+private:
+    std::uint64_t file(std::filesystem::path const &path);
+    void add_steps(std::string &inputs, std::filesystem::path const &dir, std::vector<descriptor::Step> const &steps);
+
+    std::map<std::string, std::uint64_t> flows_;
+    std::map<std::string, std::uint64_t> files_;
+    std::set<std::string> visiting_; // flows and templates being hashed, to survive cycles
+};
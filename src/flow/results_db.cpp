@@ -0,0 +1,47 @@
+#include <flow/results_db.hpp>
+#include <util/state_file.hpp>
+
+#include <fmt/format.h>
+#include <inja/inja.hpp>
+
+#include <string>
+
+ResultsDb::ResultsDb(std::filesystem::path path)
+    : path_{ std::move(path) } {
+    auto const ok = util::load_versioned_json(path_, version, [this](inja::json const &db) {
+        for(auto const &[server, flows] : db.at("servers").items())
+            for(auto const &[flow, result] : flows.items())
+                results_[server][flow] = Result{
+                    std::stoull(result.at("hash").get<std::string>(), nullptr, 16),
+                    result.at("passed").get<bool>()
+                };
+        return true;
+    });
+    if(not ok)
+        results_.clear(); // corrupt, start over
+}
+
+std::optional<ResultsDb::Result> ResultsDb::find(std::string const &server, std::string const &flow) const {
+    auto const flows = results_.find(server);
+    if(flows == std::end(results_))
+        return std::nullopt;
+
+    auto const result = flows->second.find(flow);
+    if(result == std::end(flows->second))
+        return std::nullopt;
+    return result->second;
+}
+
+void ResultsDb::update(std::string const &server, std::string const &flow, Result result) {
+    results_[server][flow] = result;
+}
+
+void ResultsDb::store() const {
+    auto servers = inja::json::object();
+    for(auto const &[server, flows] : results_)
+        for(auto const &[flow, result] : flows)
+            servers[server][flow] = { { "hash", fmt::format("{:016x}", result.hash) }, { "passed", result.passed } };
+
+    auto const db = inja::json{ { "version", version }, { "servers", std::move(servers) } };
+    util::write_file_atomically(path_, db.dump(2));
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+
+/**
+ * @brief Last result of every flow per server, together with the hash of the inputs it ran with
+ *
+ * Stored as JSON; a missing, corrupt or outdated file is treated as empty.
+ */
+class ResultsDb {
+public:
+    static constexpr auto file_name = ".cliot-results.json";
+    static constexpr int version    = 1;
+
+    struct Result {
+        std::uint64_t hash = 0;
+        bool passed        = false;
+    };
+
+    explicit ResultsDb(std::filesystem::path path);
+
+    std::optional<Result> find(std::string const &server, std::string const &flow) const;
+    void update(std::string const &server, std::string const &flow, Result result);
+
+    /**
+     * @brief Writes all results back to disk; failing to do so only costs a full run next time
+     */
+    void store() const;
+
+private:
+    std::filesystem::path path_;
+    std::map<std::string, std::map<std::string, Result>> results_; // server -> flow -> result
+};
@@ -0,0 +1,158 @@
+#include <bundle/bundle.hpp>
+#include <flow/impl/yaml_file_loader.hpp>
+#include <flow/sharding.hpp>
+#include <util/overloaded.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <numeric>
+#include <stdexcept>
+#include <variant>
+
+namespace {
+// minimal union-find over flow names
+class Groups {
+    std::map<std::string, std::string> parent_;
+
+public:
+    std::string const &find(std::string const &name) {
+        auto [it, inserted] = parent_.try_emplace(name, name);
+        if(it->second == name)
+            return it->first;
+        return it->second = find(it->second);
+    }
+
+    void join(std::string const &a, std::string const &b) {
+        auto const root_a = find(a);
+        auto const root_b = find(b);
+        if(root_a != root_b) // the smaller name becomes the root so the result does not depend on the order of joins
+            parent_[std::max(root_a, root_b)] = std::min(root_a, root_b);
+    }
+};
+
+// steps of the flow in dir, none if it has no script
+std::vector<descriptor::Step> steps_of(std::filesystem::path const &dir) {
+    auto const *bundle = bundle::Bundle::active();
+    if(bundle ? bundle->find(dir / "script.yaml") == nullptr : not std::filesystem::exists(dir / "script.yaml"))
+        return {};
+    return impl::YamlFileLoader{ dir }.load().steps;
+}
+
+// adds the names of all fixtures that running the given steps may use
+void collect_fixtures(std::filesystem::path const &flows_path,
+    std::vector<descriptor::Step> const &steps,
+    std::set<std::string> &fixtures,
+    std::set<std::string> &visited) {
+    for(auto const &step : steps) {
+        // clang-format off
+        std::visit(overloaded {
+            [&](descriptor::RunFlow const &subflow) {
+                if(subflow.fixture)
+                    fixtures.insert(subflow.name);
+                if(not visited.insert(subflow.name).second)
+                    return;
+                try {
+                    collect_fixtures(flows_path, steps_of(flows_path / subflow.name), fixtures, visited);
+                } catch(std::exception const &) {
+                    // a broken subflow fails wherever it runs
+                }
+            },
+            [&](descriptor::RepeatBlock const &block) {
+                collect_fixtures(flows_path, block.steps, fixtures, visited);
+            },
+            [](auto const &) { }},
+        step);
+        // clang-format on
+    }
+}
+} // namespace
+
+Shard Shard::parse(std::string_view spec) {
+    auto const slash = spec.find('/');
+    auto shard       = Shard{ 0, 0 };
+    auto const parse = [](std::string_view text, std::size_t &value) {
+        auto const [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return ec == std::errc{} and end == text.data() + text.size();
+    };
+
+    if(slash == std::string_view::npos
+        or not parse(spec.substr(0, slash), shard.index)
+        or not parse(spec.substr(slash + 1), shard.count)
+        or shard.index < 1 or shard.index > shard.count)
+        throw std::runtime_error(fmt::format("shard must be given as i/N with 1 <= i <= N, got '{}'", spec));
+    return shard;
+}
+
+std::vector<std::vector<std::string>> group_by_fixtures(std::map<std::string, std::string> const &flows) {
+    auto groups = Groups{};
+    for(auto const &[name, dir] : flows) {
+        groups.find(name);
+
+        auto flow_path = std::filesystem::path{ dir }.lexically_normal();
+        if(not flow_path.has_filename())
+            flow_path = flow_path.parent_path();
+
+        auto fixtures = std::set<std::string>{};
+        auto visited  = std::set<std::string>{ name };
+        try {
+            collect_fixtures(flow_path.parent_path(), steps_of(flow_path), fixtures, visited);
+        } catch(std::exception const &) {
+            // the flow fails when it runs; it still needs a shard to fail in
+        }
+
+        for(auto const &fixture : fixtures)
+            groups.join(name, fixture);
+    }
+
+    auto members = std::map<std::string, std::vector<std::string>>{};
+    for(auto const &[name, dir] : flows)
+        members[groups.find(name)].push_back(name);
+
+    auto result = std::vector<std::vector<std::string>>{};
+    for(auto &[root, names] : members)
+        result.push_back(std::move(names));
+    return result;
+}
+
+std::set<std::string> select_shard(std::map<std::string, std::string> const &flows, Shard shard, DurationHistory const &durations) {
+    using duration_t = DurationHistory::duration_t;
+
+    auto names = std::vector<std::string>{};
+    for(auto const &[name, dir] : flows)
+        names.push_back(name);
+
+    // without any history every flow weighs the same and shards are balanced by count
+    auto weights = std::map<std::string, duration_t>{};
+    for(auto const &prediction : durations.predict(names))
+        weights[prediction.name] = std::max(prediction.duration, duration_t{ 1 });
+
+    struct Group {
+        std::vector<std::string> names;
+        duration_t weight;
+    };
+
+    auto groups = std::vector<Group>{};
+    for(auto &members : group_by_fixtures(flows)) {
+        auto const weight = std::accumulate(std::begin(members), std::end(members), duration_t{ 0 }, [&weights](auto sum, auto const &name) {
+            return sum + weights.at(name);
+        });
+        groups.push_back({ std::move(members), weight });
+    }
+
+    std::sort(std::begin(groups), std::end(groups), [](auto const &a, auto const &b) {
+        return a.weight != b.weight ? a.weight > b.weight : a.names.front() < b.names.front();
+    });
+
+    auto load     = std::vector<duration_t>(shard.count, duration_t{ 0 });
+    auto selected = std::set<std::string>{};
+    for(auto const &group : groups) {
+        auto const lightest = std::distance(std::begin(load), std::min_element(std::begin(load), std::end(load)));
+        load[lightest] += group.weight;
+        if(static_cast<std::size_t>(lightest) + 1 == shard.index)
+            selected.insert(std::begin(group.names), std::end(group.names));
+    }
+    return selected;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <flow/duration_history.hpp>
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief One of count equal parts of a suite, as given by --shard index/count
+ */
+struct Shard {
+    std::size_t index; // 1-based
+    std::size_t count;
+
+    /**
+     * @brief Parses "i/N" with 1 <= i <= N; throws std::runtime_error otherwise
+     */
+    static Shard parse(std::string_view spec);
+};
+
+/**
+ * @brief Groups flows that share a fixture, directly or through their subflows
+ *
+ * A fixture runs once per process, so keeping its users together keeps every shard
+ * consistent and the fixture executed only once. Groups and their members are ordered by name.
+ *
+ * @param flows Flow name -> directory, as returned by the crawler
+ */
+std::vector<std::vector<std::string>> group_by_fixtures(std::map<std::string, std::string> const &flows);
+
+/**
+ * @brief The flows that belong to the given shard
+ *
+ * Groups are assigned longest first to the shard with the least predicted work, so the
+ * result only depends on the flows and the duration history. Every invocation must use
+ * the same history to get disjoint shards.
+ */
+std::set<std::string> select_shard(std::map<std::string, std::string> const &flows, Shard shard, DurationHistory const &durations);
@@ -1,11 +1,14 @@
 #pragma once
 
 #include <flow/exceptions.hpp>
+#include <flow/timeouts.hpp>
 #include <runner.hpp>
+#include <trace/tracer.hpp>
 
 #include <di.hpp>
 #include <fmt/compile.h>
 
+#include <chrono>
 #include <exception>
 #include <filesystem>
 #include <string>
@@ -26,19 +29,23 @@ class RepeatBlock {
     std::string path_;
     uint32_t repeat_;
     std::vector<descriptor::Step> steps_;
+    std::chrono::milliseconds timeout_;
 
 public:
-    RepeatBlock(services_t services, std::filesystem::path const &path, uint32_t repeat, std::vector<descriptor::Step> const &steps)
+    RepeatBlock(services_t services, std::filesystem::path const &path, uint32_t repeat, std::vector<descriptor::Step> const &steps, std::chrono::milliseconds timeout = {})
         : services_{ services }
         , path_{ path.string() }
         , repeat_{ repeat }
-        , steps_{ steps } { }
+        , steps_{ steps }
+        , timeout_{ timeout } { }
 
     RepeatBlock(RepeatBlock &&)      = default;
     RepeatBlock(RepeatBlock const &) = default;
 
     void run() {
+        auto deadline = Timeouts::Scope{ fmt::format("Block in {}", path_), timeout_ };
         for(uint32_t i = 0; i < repeat_; ++i) {
+            auto span = trace::Span{ "block", "{}[{}]", path_, i + 1 };
             try {
                 auto const &[env, store, factory] = services_.template get<env_t, store_t, flow_factory_t>();
                 auto flow                         = factory.get().make(path_, steps_, env, store);
@@ -47,11 +54,10 @@ public:
                 };
                 runner.run(env.get(), store.get(), flow);
             } catch(FlowException const &e) {
-                auto issues = std::vector<FailureEvent::Data>{
-                    { FailureEvent::Data::Type::LOGIC_ERROR, path_, "Block execution failed" }
-                };
-                issues.insert(std::begin(issues), std::begin(e.issues), std::end(e.issues));
-                throw FlowException(path_, issues, "No data");
+                // the inner issues come first, this level only adds its own on top
+                auto issues = e.issues;
+                issues.emplace_back(FailureEvent::Data::Type::LOGIC_ERROR, path_, "Block execution failed");
+                throw FlowException(path_, std::move(issues), "No data");
             }
         }
     }
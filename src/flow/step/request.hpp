@@ -1,10 +1,16 @@
 #pragma once
 
+#include <bundle/bundle.hpp>
 #include <flow/exceptions.hpp>
+#include <metrics/usage.hpp>
 #include <reporting/events.hpp> // probably should not be here, should use report engine public member func instead
+#include <trace/tracer.hpp>
+#include <util/arena.hpp>
+#include <util/arena_json.hpp>
 
 #include <di.hpp>
 
+#include <chrono>
 #include <exception>
 #include <string>
 #include <vector>
@@ -21,11 +27,14 @@ class Request {
 
     services_t services_;
     std::string path_;
+    std::string method_;
+    std::chrono::milliseconds timeout_;
 
 public:
-    Request(services_t services, std::filesystem::path const &path)
+    Request(services_t services, std::filesystem::path const &path, std::chrono::milliseconds timeout = {})
         : services_{ services }
-        , path_{ path.string() } {
+        , path_{ path.string() }
+        , timeout_{ timeout } {
     }
 
     Request(Request &&)      = default;
@@ -34,10 +43,14 @@ public:
     auto perform() {
         try {
             auto const &[env, con_man, store] = services_.template get<env_t, con_man_t, store_t>();
-            auto temp                         = env.get().parse_template(path_);
-            auto res                          = env.get().render(temp, store);
+            auto res                          = render(env.get(), store.get());
 
-            report(RequestEvent{ path_, store, inja::json::parse(res).dump(4) });
+            auto const arena  = util::Arena::Scope{}; // the parsed request is only needed right here
+            auto const parsed = util::ArenaJson::parse(res);
+            method_           = method_of(parsed);
+
+            if(reporting().template wants<RequestEvent>()) // copying the store is not worth it if nobody looks
+                report(RequestEvent{ path_, store, std::string{ parsed.dump(4) } });
             return con_man.get().request(std::move(res));
         } catch(std::exception const &e) {
             auto const issues = std::vector<FailureEvent::Data>{
@@ -47,10 +60,45 @@ public:
         }
     }
 
+    std::string const &path() const {
+        return path_;
+    }
+
+    /**
+     * @brief Default timeout of the responses to this request; zero if none was given
+     */
+    std::chrono::milliseconds timeout() const {
+        return timeout_;
+    }
+
+    /**
+     * @brief The API method of the last performed request; empty if the request has none
+     */
+    std::string const &method() const {
+        return method_;
+    }
+
 private:
+    std::string render(env_t &env, store_t const &store) const {
+        auto span  = trace::Span{ "render", "{}", path_ };
+        auto timed = metrics::Timed{ &metrics::Usage::render };
+        auto temp  = bundle::parse_template(env, path_);
+        return env.render(temp, store);
+    }
+
+    static std::string method_of(util::ArenaJson const &request) {
+        for(auto const *key : { "method", "command" })
+            if(auto it = request.find(key); it != request.end() and it->is_string())
+                return std::string{ it->template get_ref<util::ArenaString const &>() };
+        return {};
+    }
+
+    reporting_t &reporting() {
+        return services_.template get<reporting_t>().get();
+    }
+
     void report(auto &&ev) {
-        auto const &reporting = services_.template get<reporting_t>();
-        reporting.get().record(std::move(ev));
+        reporting().record(std::move(ev));
     }
 };
 
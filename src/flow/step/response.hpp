@@ -1,12 +1,22 @@
 #pragma once
 
+#include <bundle/bundle.hpp>
 #include <flow/exceptions.hpp>
+#include <metrics/registry.hpp>
+#include <metrics/usage.hpp>
 #include <reporting/events.hpp> // probably should not be here, should use report engine public member func instead
+#include <trace/tracer.hpp>
+#include <util/arena.hpp>
+#include <util/arena_json.hpp>
 
 #include <di.hpp>
+#include <fmt/format.h>
 
+#include <chrono>
 #include <exception>
+#include <map>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace step {
@@ -19,63 +29,154 @@ class Response {
     using reporting_t = ReportEngineType;
     using services_t  = di::Deps<env_t, store_t, con_man_t, reporting_t>;
 
+public:
+    using captures_t = std::map<std::string, std::string>;
+
+private:
     services_t services_;
     std::string path_;
+    bool stream_;
+    captures_t captures_;
+    std::chrono::milliseconds timeout_;
     ValidatorType validator_;
 
 public:
-    Response(services_t services, std::filesystem::path const &path)
+    Response(services_t services, std::filesystem::path const &path, bool stream = false, captures_t const &captures = {}, std::chrono::milliseconds timeout = {})
         : services_{ services }
-        , path_{ path.string() } { }
+        , path_{ path.string() }
+        , stream_{ stream }
+        , captures_{ captures }
+        , timeout_{ timeout } { }
 
     Response(Response &&)      = default;
     Response(Response const &) = default;
 
-    void validate(store_t const &incoming) {
-        try {
-            auto const &[env, store] = services_.template get<env_t, store_t>();
-            store.get()["$res"]      = incoming;
+    std::string const &path() const {
+        return path_;
+    }
 
-            auto temp   = env.get().parse_template(path_);
-            auto result = env.get().render(temp, store);
+    /**
+     * @brief How long to wait for the response; zero if none was given
+     */
+    std::chrono::milliseconds timeout() const {
+        return timeout_;
+    }
 
-            try {
-                auto expectations = store_t::parse(result);
+    /**
+     * @brief Validates a raw response against the expectations of this step
+     *
+     * Whatever is parsed or rendered along the way lives in the arena of this call; only what
+     * goes into the store is copied out of it.
+     *
+     * @param raw Only needs to stay valid for the duration of the call
+     */
+    void validate(std::string_view raw) {
+        auto const arena = util::Arena::Scope{};
+        if(stream_)
+            return validate_stream(raw);
+
+        util::ArenaJson incoming;
+        try {
+            incoming = util::ArenaJson::parse(raw);
+        } catch(StoreException const &e) {
+            auto const issues = std::vector<FailureEvent::Data>{
+                { FailureEvent::Data::Type::LOGIC_ERROR, path_, fmt::format("Response is not valid JSON: {}", e.what()) }
+            };
 
-                report(ResponseEvent{ path_, incoming.dump(4), expectations.dump(4) });
-                auto [valid, issues] = validator_.validate(expectations, incoming);
+            throw FlowException(path_, issues, std::string{ raw });
+        }
+        validate(incoming);
+    }
 
-                if(not valid)
-                    throw FlowException(path_, issues, incoming.dump(4));
-            } catch(StoreException const &e) {
-                auto const issues = std::vector<FailureEvent::Data>{
-                    { FailureEvent::Data::Type::LOGIC_ERROR, path_, e.what(), result }
-                };
+private:
+    void validate(util::ArenaJson const &incoming) {
+        auto const response = [&incoming] { return std::string{ incoming.dump(4) }; };
+        guarded(response, [&, this](auto &env, auto &store) {
+            store["$res"] = util::promote<store_t>(incoming);
+
+            auto expectations = render_expectations<util::ArenaJson>(env, store, response);
+            if(reporting().template wants<ResponseEvent>())
+                report(ResponseEvent{ path_, std::string{ incoming.dump(4) }, std::string{ expectations.dump(4) } });
+
+            auto span            = trace::Span{ "validate", "{}", path_ };
+            auto timed           = metrics::Timed{ &metrics::Usage::validation };
+            auto [valid, issues] = validator_.validate(expectations, incoming);
+            if(not valid) {
+                metrics::Registry::instance().validation_failures.fetch_add(1, std::memory_order_relaxed);
+                throw FlowException(path_, issues, response());
+            }
+        });
+    }
 
-                throw FlowException(path_, issues, incoming.dump(4));
+    // the response is never materialized; only the captured values end up in the store
+    void validate_stream(std::string_view raw) {
+        auto const response = [&raw] { return std::string{ raw }; };
+        guarded(response, [&, this](auto &env, auto &store) {
+            if(store.is_object()) // still null in flows without env.json that stored nothing yet
+                store.erase("$res"); // don't let the template see a stale response
+
+            auto expectations = render_expectations<store_t>(env, store, response); // the streaming validator only takes regular documents
+            if(reporting().template wants<ResponseEvent>())
+                report(ResponseEvent{ path_, std::string{ raw }, expectations.dump(4) });
+
+            auto span            = trace::Span{ "validate", "{}", path_ };
+            auto timed           = metrics::Timed{ &metrics::Usage::validation };
+            auto [valid, issues] = validator_.validate_stream(expectations, raw, captures_, store);
+            if(not valid) {
+                metrics::Registry::instance().validation_failures.fetch_add(1, std::memory_order_relaxed);
+                throw FlowException(path_, issues, response());
             }
+        });
+    }
+
+    template <typename Json>
+    Json render_expectations(env_t &env, store_t &store, auto const &response) {
+        auto result = [&, this] {
+            auto span  = trace::Span{ "render", "{}", path_ };
+            auto timed = metrics::Timed{ &metrics::Usage::render };
+            auto temp  = bundle::parse_template(env, path_);
+            return env.render(temp, store);
+        }();
+
+        try {
+            return Json::parse(result);
+        } catch(StoreException const &e) {
+            auto const issues = std::vector<FailureEvent::Data>{
+                { FailureEvent::Data::Type::LOGIC_ERROR, path_, e.what(), result }
+            };
+
+            throw FlowException(path_, issues, response());
+        }
+    }
+
+    void guarded(auto const &response, auto &&fn) {
+        try {
+            auto const &[env, store] = services_.template get<env_t, store_t>();
+            fn(env.get(), store.get());
         } catch(EnvError const &e) {
             auto const issues = std::vector<FailureEvent::Data>{
                 { FailureEvent::Data::Type::LOGIC_ERROR, path_, e.message }
             };
 
-            throw FlowException(path_, issues, incoming.dump(4));
-        } catch(FlowException const &e) {
+            throw FlowException(path_, issues, response());
+        } catch(FlowException const &) {
             // just rethrow inner one
-            throw e;
+            throw;
         } catch(std::exception const &e) {
             auto const issues = std::vector<FailureEvent::Data>{
                 { FailureEvent::Data::Type::LOGIC_ERROR, path_, e.what() }
             };
 
-            throw FlowException(path_, issues, incoming.dump(4));
+            throw FlowException(path_, issues, response());
         }
     }
 
-private:
+    reporting_t &reporting() {
+        return services_.template get<reporting_t>().get();
+    }
+
     void report(auto &&ev) {
-        auto const &reporting = services_.template get<reporting_t>();
-        reporting.get().record(std::move(ev));
+        reporting().record(std::move(ev));
     }
 };
 
@@ -1,14 +1,17 @@
 #pragma once
 
 #include <flow/exceptions.hpp>
+#include <flow/timeouts.hpp>
 #include <reporting/events.hpp> // probably should not be here, should use report engine public member func instead
 #include <runner.hpp>
+#include <trace/tracer.hpp>
 
 #include <di.hpp>
 #include <fmt/compile.h>
 
 #include <filesystem>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace step {
@@ -24,30 +27,55 @@ class RunFlow {
 
     services_t services_;
     std::string path_;
+    bool fixture_;
+    std::vector<std::string> keys_;
 
 public:
-    RunFlow(services_t services, std::filesystem::path const &path)
+    RunFlow(services_t services, std::filesystem::path const &path, bool fixture = false, std::vector<std::string> keys = {})
         : services_{ services }
-        , path_{ path.string() } { }
+        , path_{ path.string() }
+        , fixture_{ fixture }
+        , keys_{ std::move(keys) } { }
 
     RunFlow(RunFlow &&)      = default;
     RunFlow(RunFlow const &) = default;
 
     void run() {
         try {
+            if(fixture_)
+                return run_fixture();
+
+            auto span                = trace::Span{ "subflow", "{}", path_ };
             auto const &[env, store] = services_.template get<env_t, store_t>();
             auto runner              = FlowRunner<flow_factory_t>{
                 services_, fmt::format("subflow[{}]", path_), path_
             };
             runner.run(env.get(), store.get());
         } catch(FlowException const &e) {
-            auto issues = std::vector<FailureEvent::Data>{
-                { FailureEvent::Data::Type::LOGIC_ERROR, path_, "Subflow execution failed" }
-            };
-            issues.insert(std::begin(issues), std::begin(e.issues), std::end(e.issues));
-            throw FlowException(path_, issues, "No data");
+            // the inner issues come first, this level only adds its own on top
+            auto issues = e.issues; // copied: a failed fixture rethrows the same object to every dependent
+            issues.emplace_back(FailureEvent::Data::Type::LOGIC_ERROR, path_, "Subflow execution failed");
+            throw FlowException(path_, std::move(issues), "No data");
         }
     }
+
+private:
+    void run_fixture() {
+        auto const &[store, factory] = services_.template get<store_t, flow_factory_t>();
+        auto &fixtures               = factory.get().fixtures();
+        auto snapshot                = fixtures.get_or_run(path_, [this]() {
+            // fixtures don't see the parent's environment or deadlines so that their result can be shared
+            auto detached = Timeouts::Detached{};
+            auto span     = trace::Span{ "fixture", "{}", path_ };
+            auto runner   = FlowRunner<flow_factory_t>{
+                services_, fmt::format("fixture[{}]", path_), path_
+            };
+            return runner.run_detached();
+        });
+
+        // fork the shared snapshot into the dependent flow's store
+        fixtures.fork(path_, store.get(), snapshot, keys_);
+    }
 };
 
 } // namespace step
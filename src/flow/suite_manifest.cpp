@@ -0,0 +1,165 @@
+#include <flow/suite_manifest.hpp>
+#include <util/state_file.hpp>
+
+#include <inja/inja.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <iterator>
+#include <thread>
+#include <utility>
+
+namespace {
+bool is_hidden(std::filesystem::path const &path) {
+    return path.filename().string().starts_with(".");
+}
+
+// runs fn(i) for every i in [0, count) on up to hardware_concurrency threads
+template <typename Fn>
+void parallel_for(std::size_t count, Fn &&fn) {
+    auto const threads = std::min<std::size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+    auto next          = std::atomic<std::size_t>{ 0 };
+
+    std::vector<std::future<void>> workers;
+    for(auto t = std::size_t{ 0 }; t < threads; ++t)
+        workers.push_back(std::async(std::launch::async, [&] {
+            for(auto i = next++; i < count; i = next++)
+                fn(i);
+        }));
+    for(auto &worker : workers)
+        worker.get();
+}
+} // namespace
+
+SuiteManifest::SuiteManifest(std::filesystem::path flows_path, std::filesystem::path manifest_path)
+    : flows_path_{ std::move(flows_path) }
+    , manifest_path_{ std::move(manifest_path) } {
+}
+
+SuiteManifest::entries_t const &SuiteManifest::entries() {
+    auto const flows_mtime  = mtime_of(flows_path_);
+    auto const cached_mtime = load();
+
+    // if no flow was added or removed the cached names are still complete
+    auto dirs = std::vector<std::filesystem::path>{};
+    if(cached_mtime == flows_mtime)
+        std::transform(std::begin(entries_), std::end(entries_), std::back_inserter(dirs), [](auto const &entry) {
+            return entry.second.dir;
+        });
+    else
+        dirs = list_flow_dirs();
+
+    auto results = std::vector<FlowEntry>(dirs.size());
+    auto walked  = std::atomic<std::size_t>{ 0 };
+    parallel_for(dirs.size(), [&](std::size_t i) {
+        auto const name = dirs[i].filename().string();
+        if(auto it = entries_.find(name); it != std::end(entries_) and it->second.mtime == mtime_of(dirs[i])) {
+            results[i] = it->second;
+            return;
+        }
+
+        results[i] = walk(dirs[i]);
+        ++walked;
+    });
+
+    auto const changed = walked > 0 or cached_mtime != flows_mtime or results.size() != entries_.size();
+    walked_            = walked;
+
+    entries_.clear();
+    for(auto &entry : results)
+        entries_.emplace(entry.name, std::move(entry));
+
+    if(changed)
+        store(flows_mtime);
+    return entries_;
+}
+
+FlowEntry SuiteManifest::walk(std::filesystem::path const &dir) {
+    auto entry  = FlowEntry{};
+    entry.name  = dir.filename().string();
+    entry.dir   = dir;
+    entry.mtime = mtime_of(dir); // before listing so that concurrent changes invalidate the entry
+    for(auto const &file : std::filesystem::directory_iterator{ dir }) {
+        if(is_hidden(file.path()) or not file.is_regular_file())
+            continue;
+
+        auto name = file.path().filename().string();
+        if(name == "script.yaml")
+            entry.has_script = true;
+        else if(name == "env.json")
+            entry.has_env = true;
+        else
+            entry.templates.push_back(std::move(name));
+    }
+
+    std::sort(std::begin(entry.templates), std::end(entry.templates));
+    return entry;
+}
+
+std::int64_t SuiteManifest::mtime_of(std::filesystem::path const &path) {
+    return std::filesystem::last_write_time(path).time_since_epoch().count();
+}
+
+std::vector<std::filesystem::path> SuiteManifest::list_flow_dirs() const {
+    auto dirs = std::vector<std::filesystem::path>{};
+    for(auto const &entry : std::filesystem::directory_iterator{ flows_path_ })
+        if(not is_hidden(entry.path()) and entry.is_directory())
+            dirs.push_back(entry.path());
+    return dirs;
+}
+
+std::optional<std::int64_t> SuiteManifest::load() {
+    entries_.clear();
+    if(manifest_path_.empty())
+        return std::nullopt;
+
+    auto mtime    = std::int64_t{};
+    auto const ok = util::load_versioned_json(manifest_path_, version, [this, &mtime](inja::json const &manifest) {
+        if(manifest.at("flows_path").get<std::string>() != flows_path_.string())
+            return false;
+
+        for(auto const &flow : manifest.at("flows")) {
+            auto entry = FlowEntry{
+                flow.at("name").get<std::string>(),
+                flow.at("dir").get<std::string>(),
+                flow.at("mtime").get<std::int64_t>(),
+                flow.at("has_script").get<bool>(),
+                flow.at("has_env").get<bool>(),
+                flow.at("templates").get<std::vector<std::string>>()
+            };
+            entries_.emplace(entry.name, std::move(entry));
+        }
+        mtime = manifest.at("mtime").get<std::int64_t>();
+        return true;
+    });
+
+    if(ok)
+        return mtime;
+    entries_.clear(); // corrupt or from an incompatible version, just walk again
+    return std::nullopt;
+}
+
+void SuiteManifest::store(std::int64_t flows_mtime) const {
+    if(manifest_path_.empty())
+        return;
+
+    auto flows = inja::json::array();
+    for(auto const &[name, entry] : entries_)
+        flows.push_back({ { "name", name },
+            { "dir", entry.dir.string() },
+            { "mtime", entry.mtime },
+            { "has_script", entry.has_script },
+            { "has_env", entry.has_env },
+            { "templates", entry.templates } });
+
+    auto const manifest = inja::json{
+        { "version", version },
+        { "flows_path", flows_path_.string() },
+        { "mtime", flows_mtime },
+        { "flows", std::move(flows) }
+    };
+
+    // failing to write (e.g. a read-only checkout) only means the next start is cold again
+    util::write_file_atomically(manifest_path_, manifest.dump());
+}
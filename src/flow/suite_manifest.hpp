@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief What the crawler knows about a single flow directory
+ */
+struct FlowEntry {
+    std::string name;
+    std::filesystem::path dir;
+    std::int64_t mtime = 0; // of the directory; changes whenever files are added, removed or renamed
+    bool has_script    = false;
+    bool has_env       = false;
+    std::vector<std::string> templates; // every other regular file, sorted
+};
+
+/**
+ * @brief Cached listing of all flow directories of a suite
+ *
+ * Stored next to the flows as .cliot-manifest.json. An entry is reused as long as the
+ * mtime of its directory did not change, so a warm start costs one stat per flow instead
+ * of a directory listing. Changed or new flows are walked in parallel.
+ */
+class SuiteManifest {
+public:
+    static constexpr auto file_name = ".cliot-manifest.json";
+    static constexpr int version    = 1;
+
+    using entries_t = std::map<std::string, FlowEntry>; // ordered by name
+
+    /**
+     * @param flows_path The flows directory of the suite
+     * @param manifest_path Where to load the manifest from and store it to; empty disables caching
+     */
+    SuiteManifest(std::filesystem::path flows_path, std::filesystem::path manifest_path);
+
+    /**
+     * @brief Up to date entries of all flows, refreshing the manifest on disk if anything changed
+     */
+    entries_t const &entries();
+
+    /**
+     * @brief How many flow directories had to be walked by the last call to entries()
+     */
+    std::size_t walked() const {
+        return walked_;
+    }
+
+    static FlowEntry walk(std::filesystem::path const &dir);
+    static std::int64_t mtime_of(std::filesystem::path const &path);
+
+private:
+    std::optional<std::int64_t> load();
+    void store(std::int64_t flows_mtime) const;
+    std::vector<std::filesystem::path> list_flow_dirs() const;
+
+    std::filesystem::path flows_path_;
+    std::filesystem::path manifest_path_;
+    entries_t entries_;
+    std::size_t walked_ = 0;
+};
@@ -0,0 +1,92 @@
+#include <flow/timeouts.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace {
+struct Deadline {
+    Timeouts::clock_t::time_point at;
+    std::string what;
+    std::chrono::milliseconds timeout;
+};
+
+std::vector<Deadline> &deadlines() {
+    thread_local auto stack = std::vector<Deadline>{};
+    return stack;
+}
+
+// deadlines below this index belong to flows hidden by a Detached scope
+thread_local auto visible_from = std::size_t{ 0 };
+
+std::span<Deadline const> enclosing() {
+    return std::span<Deadline const>{ deadlines() }.subspan(visible_from);
+}
+
+std::atomic<std::chrono::milliseconds::rep> default_ms = 0;
+
+std::string exceeded(Deadline const &deadline) {
+    return fmt::format("{} did not finish within its timeout of {}ms", deadline.what, deadline.timeout.count());
+}
+} // namespace
+
+Timeouts::Scope::Scope(std::string const &what, std::chrono::milliseconds timeout)
+    : active_{ timeout.count() > 0 } {
+    if(active_)
+        deadlines().push_back({ clock_t::now() + timeout, what, timeout });
+}
+
+Timeouts::Scope::~Scope() {
+    if(active_)
+        deadlines().pop_back();
+}
+
+Timeouts::Detached::Detached()
+    : previous_{ std::exchange(visible_from, deadlines().size()) } {
+}
+
+Timeouts::Detached::~Detached() {
+    visible_from = previous_;
+}
+
+void Timeouts::set_default(std::chrono::milliseconds timeout) {
+    default_ms = timeout.count();
+}
+
+std::chrono::milliseconds Timeouts::default_timeout() {
+    return std::chrono::milliseconds{ default_ms.load() };
+}
+
+Timeouts::Budget Timeouts::budget(std::string const &path, std::chrono::milliseconds timeout) {
+    if(timeout.count() == 0)
+        timeout = default_timeout();
+
+    auto const result = remaining();
+    if(timeout.count() > 0 and (result.wait.count() == 0 or timeout <= result.wait))
+        return { timeout, fmt::format("No response to {} within {}ms", path, timeout.count()) };
+    return result;
+}
+
+Timeouts::Budget Timeouts::remaining() {
+    auto result    = Budget{};
+    auto const now = clock_t::now();
+    for(auto const &deadline : enclosing()) {
+        // an expired deadline still gets a minimal wait, zero would mean no limit at all
+        auto const left = std::max(std::chrono::ceil<std::chrono::milliseconds>(deadline.at - now), std::chrono::milliseconds{ 1 });
+        if(result.wait.count() == 0 or left < result.wait)
+            result = { left, exceeded(deadline) };
+    }
+    return result;
+}
+
+std::optional<std::string> Timeouts::expired() {
+    auto const now = clock_t::now();
+    for(auto const &deadline : enclosing())
+        if(deadline.at <= now)
+            return exceeded(deadline);
+    return std::nullopt;
+}
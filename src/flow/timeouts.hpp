@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+
+/**
+ * @brief Deadlines of the flows and blocks running on the calling thread
+ *
+ * A flow runs its steps, subflows and blocks on a single thread, so the enclosing deadlines
+ * are kept on a thread local stack. Waiting for a response is limited by the timeout of the
+ * step and by every deadline on the stack, whichever runs out first.
+ */
+class Timeouts {
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    /**
+     * @brief How long a single wait may take and what to report if it runs out
+     */
+    struct Budget {
+        std::chrono::milliseconds wait; // zero for no limit
+        std::string reason;
+    };
+
+    /**
+     * @brief Puts a deadline on the stack for the lifetime of a flow or block; a zero timeout adds none
+     */
+    class Scope {
+        bool active_;
+
+    public:
+        Scope(std::string const &what, std::chrono::milliseconds timeout);
+        ~Scope();
+
+        Scope(Scope const &)            = delete;
+        Scope &operator=(Scope const &) = delete;
+    };
+
+    /**
+     * @brief Hides the deadlines already on the stack for its lifetime
+     *
+     * Used for work that runs on behalf of several flows, like a fixture, so that it is not
+     * cut short by the deadlines of whichever flow happened to start it.
+     */
+    class Detached {
+        std::size_t previous_;
+
+    public:
+        Detached();
+        ~Detached();
+
+        Detached(Detached const &)            = delete;
+        Detached &operator=(Detached const &) = delete;
+    };
+
+    /**
+     * @brief Timeout of responses that neither they nor their request specify; zero for none
+     */
+    static void set_default(std::chrono::milliseconds timeout);
+    static std::chrono::milliseconds default_timeout();
+
+    /**
+     * @brief Budget for waiting on the step at path, falling back to the default if its timeout is zero
+     */
+    static Budget budget(std::string const &path, std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Budget left by the enclosing deadlines alone; a zero wait if there are none
+     */
+    static Budget remaining();
+
+    /**
+     * @brief What exceeded its deadline if any of the enclosing deadlines already passed
+     */
+    static std::optional<std::string> expired();
+};
@@ -0,0 +1,282 @@
+#include <isolation/fork_server.hpp>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <set>
+#include <system_error>
+
+namespace isolation {
+
+namespace {
+constexpr auto max_request = std::size_t{ 8192 };
+constexpr auto header_size = std::size_t{ 4 };
+
+[[noreturn]] void fail(char const *what) {
+    throw std::system_error{ errno, std::generic_category(), what };
+}
+
+bool write_all(int fd, std::uint8_t const *data, std::size_t size) {
+    while(size > 0) {
+        auto const written = ::write(fd, data, size);
+        if(written < 0 and errno == EINTR)
+            continue;
+        if(written <= 0)
+            return false;
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+enum class Kind : char {
+    RUN  = 'r', // "r<name>\0<dir>" together with the write end of the result pipe
+    KILL = 'k'  // "k<pid>" of a child that should be killed
+};
+
+struct Request {
+    Kind kind;
+    std::string name;
+    std::string dir;
+    int fd      = -1;
+    pid_t child = -1;
+};
+
+bool send_request(int socket, std::string const &name, std::string const &dir, int fd) {
+    auto payload = std::string{ static_cast<char>(Kind::RUN) };
+    payload += name;
+    payload.push_back('\0');
+    payload += dir;
+    if(payload.size() > max_request)
+        return false;
+
+    auto iov     = iovec{ payload.data(), payload.size() };
+    auto control = std::array<char, CMSG_SPACE(sizeof(int))>{};
+    auto msg     = msghdr{};
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = control.data();
+    msg.msg_controllen = control.size();
+
+    auto *cmsg       = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type  = SCM_RIGHTS;
+    cmsg->cmsg_len   = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+    return ::sendmsg(socket, &msg, MSG_NOSIGNAL) == static_cast<ssize_t>(payload.size());
+}
+
+void send_kill(int socket, pid_t child) {
+    auto payload = std::array<char, 1 + sizeof(pid_t)>{ static_cast<char>(Kind::KILL) };
+    std::memcpy(payload.data() + 1, &child, sizeof(pid_t));
+    ::send(socket, payload.data(), payload.size(), MSG_NOSIGNAL);
+}
+
+// returns false once the owner of the server is gone
+bool receive_request(int socket, Request &request) {
+    auto payload = std::array<char, max_request>{};
+    auto iov     = iovec{ payload.data(), payload.size() };
+    auto control = std::array<char, CMSG_SPACE(sizeof(int))>{};
+    auto msg     = msghdr{};
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = control.data();
+    msg.msg_controllen = control.size();
+
+    auto received = ssize_t{};
+    do {
+        received = ::recvmsg(socket, &msg, 0);
+    } while(received < 0 and errno == EINTR);
+    if(received <= 0)
+        return false;
+
+    request.kind = static_cast<Kind>(payload[0]);
+    if(request.kind == Kind::KILL) {
+        if(static_cast<std::size_t>(received) != 1 + sizeof(pid_t))
+            return false;
+        std::memcpy(&request.child, payload.data() + 1, sizeof(pid_t));
+        return true;
+    }
+
+    auto *cmsg = CMSG_FIRSTHDR(&msg);
+    if(request.kind != Kind::RUN or cmsg == nullptr or cmsg->cmsg_type != SCM_RIGHTS)
+        return false;
+    std::memcpy(&request.fd, CMSG_DATA(cmsg), sizeof(int));
+
+    auto const body      = std::string_view{ payload.data() + 1, static_cast<std::size_t>(received) - 1 };
+    auto const separator = body.find('\0');
+    request.name         = body.substr(0, separator);
+    request.dir          = separator == std::string_view::npos ? std::string{} : std::string{ body.substr(separator + 1) };
+    return true;
+}
+
+void reap(std::set<pid_t> &children) {
+    auto child = pid_t{};
+    while((child = ::waitpid(-1, nullptr, WNOHANG)) > 0)
+        children.erase(child);
+}
+} // namespace
+
+bool FrameWriter::write(std::span<std::uint8_t const> payload) {
+    auto const size   = static_cast<std::uint32_t>(payload.size());
+    auto const header = std::array<std::uint8_t, header_size>{
+        static_cast<std::uint8_t>(size), static_cast<std::uint8_t>(size >> 8), static_cast<std::uint8_t>(size >> 16), static_cast<std::uint8_t>(size >> 24)
+    };
+    return write_all(fd_, header.data(), header.size()) and write_all(fd_, payload.data(), payload.size());
+}
+
+ForkServer::ForkServer(runner_t runner) {
+    auto sockets = std::array<int, 2>{};
+    if(::socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sockets.data()) != 0)
+        fail("Could not create the fork server socket");
+
+    server_ = ::fork();
+    if(server_ < 0) {
+        ::close(sockets[0]);
+        ::close(sockets[1]);
+        fail("Could not start the fork server");
+    }
+
+    if(server_ == 0) {
+        ::close(sockets[0]);
+        socket_ = sockets[1];
+        serve(runner);
+    }
+
+    ::close(sockets[1]);
+    socket_ = sockets[0];
+}
+
+ForkServer::~ForkServer() {
+    ::close(socket_); // the server exits once it reads the end of the socket
+    while(::waitpid(server_, nullptr, 0) < 0 and errno == EINTR) { }
+}
+
+ForkServer::Exit ForkServer::run(std::string const &name, std::string const &dir, std::chrono::milliseconds limit, sink_t const &sink) {
+    // close-on-exec from the start, another thread may fork in between otherwise
+    auto pipe = std::array<int, 2>{};
+    if(::pipe2(pipe.data(), O_CLOEXEC) != 0)
+        fail("Could not create the result pipe");
+
+    auto child = pid_t{ -1 };
+    {
+        std::scoped_lock l{ mtx_ };
+        if(send_request(socket_, name, dir, pipe[1]))
+            while(::recv(socket_, &child, sizeof(child), 0) < 0 and errno == EINTR) { }
+    }
+    ::close(pipe[1]); // only the child writes from now on, so the end of the pipe is the end of the child
+    if(child <= 0) {
+        ::close(pipe[0]);
+        throw std::runtime_error{ "The fork server could not start a process for " + name };
+    }
+
+    try {
+        auto const exit = read_frames(pipe[0], child, limit, sink);
+        ::close(pipe[0]);
+        return exit;
+    } catch(...) {
+        kill(child);
+        ::close(pipe[0]);
+        throw;
+    }
+}
+
+void ForkServer::kill(pid_t child) {
+    std::scoped_lock l{ mtx_ };
+    send_kill(socket_, child);
+}
+
+ForkServer::Exit ForkServer::read_frames(int fd, pid_t child, std::chrono::milliseconds limit, sink_t const &sink) {
+    auto const deadline = std::chrono::steady_clock::now() + limit;
+    auto buffer         = std::vector<std::uint8_t>{};
+    auto chunk          = std::array<std::uint8_t, 16384>{};
+    auto pfd            = pollfd{ fd, POLLIN, 0 };
+
+    while(true) {
+        auto timeout = -1;
+        if(limit.count() > 0) {
+            auto const left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            timeout         = static_cast<int>(std::max<std::chrono::milliseconds::rep>(0, left.count()));
+        }
+
+        auto const ready = ::poll(&pfd, 1, timeout);
+        if(ready < 0 and errno == EINTR)
+            continue;
+        if(ready == 0) {
+            kill(child);
+            return Exit::TIMED_OUT;
+        }
+
+        auto const received = ::read(fd, chunk.data(), chunk.size());
+        if(received < 0 and errno == EINTR)
+            continue;
+        if(received <= 0)
+            break;
+        buffer.insert(std::end(buffer), std::begin(chunk), std::begin(chunk) + received);
+
+        auto consumed = std::size_t{ 0 };
+        while(buffer.size() - consumed >= header_size) {
+            auto const *header = buffer.data() + consumed;
+            auto const size    = std::size_t{ header[0] } | std::size_t{ header[1] } << 8 | std::size_t{ header[2] } << 16 | std::size_t{ header[3] } << 24;
+            if(buffer.size() - consumed - header_size < size)
+                break;
+
+            auto const begin = std::begin(buffer) + static_cast<std::ptrdiff_t>(consumed + header_size);
+            sink({ begin, begin + static_cast<std::ptrdiff_t>(size) });
+            consumed += header_size + size;
+        }
+        buffer.erase(std::begin(buffer), std::begin(buffer) + static_cast<std::ptrdiff_t>(consumed));
+    }
+    return Exit::COMPLETED;
+}
+
+void ForkServer::serve(runner_t const &runner) {
+#ifdef __linux__
+    ::prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+
+    // children stay zombies until reaped here, so a pid in this set can't belong to anyone else yet
+    auto children = std::set<pid_t>{};
+    auto request  = Request{};
+    while(receive_request(socket_, request)) {
+        reap(children);
+        if(request.kind == Kind::KILL) {
+            if(children.contains(request.child))
+                ::kill(request.child, SIGKILL);
+            continue;
+        }
+
+        auto const child = ::fork();
+        if(child == 0) {
+            ::close(socket_);
+            try {
+                auto out = FrameWriter{ request.fd };
+                runner(request.name, request.dir, out);
+            } catch(...) {
+                // nothing more can be reported; the parent notices the missing result
+            }
+            ::_exit(EXIT_SUCCESS); // never run the destructors and exit handlers of the parent
+        }
+
+        ::close(request.fd);
+        if(child > 0)
+            children.insert(child);
+        ::send(socket_, &child, sizeof(child), MSG_NOSIGNAL);
+    }
+    ::_exit(EXIT_SUCCESS);
+}
+
+} // namespace isolation
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace isolation {
+
+/**
+ * @brief Writes length-prefixed frames into the result pipe of a flow process
+ */
+class FrameWriter {
+    int fd_;
+
+public:
+    explicit FrameWriter(int fd)
+        : fd_{ fd } { }
+
+    /**
+     * @brief Writes one frame; returns false once nobody reads the pipe anymore
+     */
+    bool write(std::span<std::uint8_t const> payload);
+};
+
+/**
+ * @brief Runs flows in child processes forked from a process that was started before any threads
+ *
+ * The server process is forked when this is constructed, so it only holds what was set up
+ * until then - options, the memory-mapped bundle - and no io or reporting threads that a
+ * fork could leave in a broken state. Every flow runs in a fresh child of the server and
+ * sends its results back as frames over a pipe. A child that crashes only loses its own
+ * flow, one that exceeds the wall-clock limit is killed.
+ */
+class ForkServer {
+public:
+    /**
+     * @brief Runs a single flow in the child process, writing its results into the pipe
+     */
+    using runner_t = std::function<void(std::string const &name, std::string const &dir, FrameWriter &out)>;
+
+    /**
+     * @brief Receives every frame the child wrote, in order
+     */
+    using sink_t = std::function<void(std::vector<std::uint8_t> const &frame)>;
+
+    enum class Exit {
+        COMPLETED, // the child closed its pipe, normally or because it crashed
+        TIMED_OUT  // the child was killed after the wall-clock limit
+    };
+
+    explicit ForkServer(runner_t runner);
+    ~ForkServer();
+
+    ForkServer(ForkServer const &)            = delete;
+    ForkServer &operator=(ForkServer const &) = delete;
+
+    /**
+     * @brief Runs one flow in a new child; safe to call from several threads at once
+     *
+     * @param limit Wall-clock limit of the child; zero for none
+     * @throws std::runtime_error if no child could be started for the flow
+     */
+    Exit run(std::string const &name, std::string const &dir, std::chrono::milliseconds limit, sink_t const &sink);
+
+private:
+    [[noreturn]] void serve(runner_t const &runner);
+    Exit read_frames(int fd, pid_t child, std::chrono::milliseconds limit, sink_t const &sink);
+    void kill(pid_t child); // done by the server, which knows whether the pid is still its child
+
+    int socket_   = -1;
+    pid_t server_ = -1;
+    std::mutex mtx_; // one request and its reply at a time
+};
+
+} // namespace isolation
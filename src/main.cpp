@@ -1,9 +1,26 @@
+#include <bundle/bundle.hpp>
 #include <crawler.hpp>
+#include <distributed/channel.hpp>
+#include <distributed/coordinator.hpp>
+#include <distributed/worker.hpp>
 #include <flow/default_flow_factory.hpp>
+#include <flow/duration_history.hpp>
+#include <flow/incremental_run.hpp>
+#include <flow/timeouts.hpp>
+#include <isolation/fork_server.hpp>
+#include <metrics/server.hpp>
+#include <reporting/artifact_store.hpp>
 #include <reporting/default_report_renderer.hpp>
+#include <reporting/json_lines_renderer.hpp>
+#include <reporting/junit_renderer.hpp>
+#include <reporting/merge.hpp>
+#include <reporting/pipe_renderer.hpp>
+#include <reporting/remote_renderer.hpp>
 #include <reporting/report_engine.hpp>
 #include <runner.hpp>
 #include <scheduler.hpp>
+#include <trace/tracer.hpp>
+#include <util/directory_watcher.hpp>
 #include <validation/validator.hpp>
 #include <web/async_connection_pool.hpp>
 #include <web/connection_manager.hpp>
@@ -13,16 +30,34 @@
 #include <di.hpp>
 #include <fmt/compile.h>
 
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
 using rep_renderer_t = DefaultReportRenderer;
-using reporting_t    = ReportEngine<rep_renderer_t>;
+using reporting_t    = ReportEngine<rep_renderer_t, JsonLinesRenderer, JUnitRenderer, RemoteRenderer>;
 using fetcher_t      = OnDemandFetcher;
 using con_man_t      = ConnectionManager<AsyncConnectionPool, fetcher_t>;
 using flow_factory_t = DefaultFlowFactory<con_man_t, reporting_t>;
 using crawler_t      = Crawler<reporting_t>;
 using scheduler_t    = Scheduler<flow_factory_t, con_man_t, reporting_t, crawler_t>;
 
+// the same stack inside an isolated flow process, reporting to its parent only
+using isolated_reporting_t    = ReportEngine<PipeRenderer>;
+using isolated_flow_factory_t = DefaultFlowFactory<con_man_t, isolated_reporting_t>;
+using isolated_crawler_t      = Crawler<isolated_reporting_t>;
+using isolated_scheduler_t    = Scheduler<isolated_flow_factory_t, con_man_t, isolated_reporting_t, isolated_crawler_t>;
+
 void usage(std::string msg) {
-    fmt::print("{}\nThe first positional argument must be a path to the data folder\n", msg);
+    fmt::print("{}\nThe first positional argument must be a path to the data folder or a bundle\n"
+               "Use `cliot pack <data folder> <bundle>` to pack a data folder into a single bundle\n"
+               "Use `cliot merge <output.jsonl> <shard.jsonl>...` to combine the results of several shards\n"
+               "Use `cliot coordinate --endpoint <ep> <data folder>` to hand out the suite to workers started with\n"
+               "`cliot worker --endpoint <ep> <data folder>`; <ep> is unix:/path or host:port\n",
+        msg);
     exit(EXIT_SUCCESS);
 }
 
@@ -36,6 +71,27 @@ auto parse_options(int argc, char **argv) {
       ("H,host", "Clio server ip address", cxxopts::value<std::string>()->default_value("127.0.0.1"))
       ("P,port", "The port Clio is running on", cxxopts::value<uint16_t>()->default_value("51233"))
       ("f,filter", "Filter flows for execution", cxxopts::value<std::string>()->default_value(""))
+      ("async-output", "Render output on a background thread")
+      ("report-queue", "Capacity of the output queue when using async output", cxxopts::value<std::size_t>()->default_value("4096"))
+      ("report-overflow", "What to do when the output queue is full: block or drop", cxxopts::value<std::string>()->default_value("block"))
+      ("trace", "Write a Chrome trace of the run into this file", cxxopts::value<std::string>())
+      ("jsonl", "Also write every event as JSON Lines into this file", cxxopts::value<std::string>()->default_value(""))
+      ("junit", "Also write flow results as JUnit XML into this file", cxxopts::value<std::string>()->default_value(""))
+      ("artifacts", "Write large failure payloads into this directory instead of keeping them in memory", cxxopts::value<std::string>()->default_value(""))
+      ("max-payload", "Failure payloads larger than this are spilled to artifacts or truncated", cxxopts::value<std::size_t>()->default_value("65536"))
+      ("no-manifest", "Always walk the flows directory instead of using the cached suite manifest")
+      ("incremental", "Only run flows whose inputs changed or which did not pass last time against this server")
+      ("results-db", "Where incremental runs keep their results; defaults to a file in the data folder", cxxopts::value<std::string>()->default_value(""))
+      ("j,jobs", "Number of flows to run concurrently, longest first based on previous runs", cxxopts::value<std::size_t>()->default_value("1"))
+      ("shard", "Only run part i of N of the suite, e.g. 2/4, balanced by the duration history", cxxopts::value<std::string>())
+      ("durations", "Duration history to schedule and shard by; defaults to a file in the data folder", cxxopts::value<std::string>()->default_value(""))
+      ("watch", "Keep running and re-run affected flows whenever files of the suite change; implies --incremental")
+      ("metrics-port", "Serve live metrics in OpenMetrics format on this local port", cxxopts::value<uint16_t>())
+      ("timeout", "Milliseconds to wait for a response whose step sets no timeout; 0 waits forever", cxxopts::value<uint64_t>()->default_value("60000"))
+      ("isolate", "Run every flow in its own process so that crashes and hangs only fail that flow")
+      ("flow-timeout", "With --isolate, kill flows running longer than this many milliseconds; 0 for no limit", cxxopts::value<uint64_t>()->default_value("0"))
+      ("endpoint", "Where the coordinator listens and workers connect to: unix:/path or host:port", cxxopts::value<std::string>()->default_value(""))
+      ("lease-timeout", "Coordinator hands the flows of a worker silent for this many milliseconds to other workers", cxxopts::value<uint64_t>()->default_value("10000"))
     ;
     options.parse_positional({"path"});
     // clang-format on
@@ -47,7 +103,72 @@ auto parse_options(int argc, char **argv) {
     return result;
 }
 
+void run_isolated(std::string const &host, uint16_t port, std::string const &name, std::string const &dir, isolation::FrameWriter &out) {
+    PipeRenderer pipe{ &out };
+    auto reporting_deps = di::Deps<PipeRenderer>{ pipe };
+    isolated_reporting_t reporting{ reporting_deps, true };
+
+    di::Deps<isolated_reporting_t> base_deps{ reporting };
+
+    fetcher_t fetcher{};
+    con_man_t con_man{ host, std::to_string(port), 1, fetcher }; // the child runs a single flow
+    isolated_crawler_t crawler{ base_deps, dir, "" };
+
+    auto flow_deps = di::combine(base_deps, di::Deps<con_man_t>{ con_man });
+    isolated_flow_factory_t flow_factory{ flow_deps };
+
+    auto scheduler_deps = di::combine(flow_deps, di::Deps<isolated_flow_factory_t, isolated_crawler_t>{ flow_factory, crawler });
+    isolated_scheduler_t scheduler{ scheduler_deps };
+
+    try {
+        scheduler.run_one(name, dir);
+    } catch(std::exception const &e) {
+        reporting.record(FailureEvent{ name, name, { { FailureEvent::Data::Type::LOGIC_ERROR, name, fmt::format("Flow aborted: {}", e.what()) } }, "No data" });
+    }
+}
+
+int pack(int argc, char **argv) {
+    if(argc != 4)
+        usage("Usage: cliot pack <data folder> <bundle>");
+
+    bundle::pack(argv[2], argv[3]);
+    fmt::print("Packed {} into {}\n", argv[2], argv[3]);
+    return EXIT_SUCCESS;
+}
+
+int merge(int argc, char **argv) {
+    if(argc < 4)
+        usage("Usage: cliot merge <output.jsonl> <shard.jsonl>...");
+
+    auto const summary = merge_json_lines({ argv + 3, argv + argc }, argv[2]);
+    fmt::print("Merged {} shard(s) into {}: {} flow(s) passed, {} failed\n", argc - 3, argv[2], summary.passed, summary.failed);
+    return EXIT_SUCCESS;
+}
+
+enum class Mode {
+    LOCAL,
+    COORDINATE,
+    WORKER
+};
+
 int main(int argc, char **argv) try {
+    if(argc > 1 and std::string_view{ argv[1] } == "pack")
+        return pack(argc, argv);
+    if(argc > 1 and std::string_view{ argv[1] } == "merge")
+        return merge(argc, argv);
+
+    // coordinator and workers take the usual options, so only the subcommand itself is dropped
+    auto mode = Mode::LOCAL;
+    if(argc > 1 and std::string_view{ argv[1] } == "coordinate")
+        mode = Mode::COORDINATE;
+    if(argc > 1 and std::string_view{ argv[1] } == "worker")
+        mode = Mode::WORKER;
+    if(mode != Mode::LOCAL) {
+        argv[1] = argv[0];
+        --argc;
+        ++argv;
+    }
+
     auto result  = parse_options(argc, argv);
     auto path    = result["path"].as<std::string>();
     auto host    = result["host"].as<std::string>();
@@ -55,24 +176,150 @@ int main(int argc, char **argv) try {
     auto filter  = result["filter"].as<std::string>();
     auto verbose = result["verbose"].as<uint16_t>();
 
+    auto const async_output = result["async-output"].as<bool>();
+    auto const queue_size   = result["report-queue"].as<std::size_t>();
+    auto const overflow     = [&result]() {
+        auto const policy = result["report-overflow"].as<std::string>();
+        if(policy == "block")
+            return ReportOverflow::BLOCK;
+        if(policy == "drop")
+            return ReportOverflow::DROP;
+        throw std::runtime_error("report-overflow must be either 'block' or 'drop'");
+    }();
+
+    auto const is_bundle = bundle::Bundle::is_bundle(path);
+    if(is_bundle)
+        bundle::Bundle::activate(path);
+
+    // results of previous runs are kept in the data folder like the manifest, or next to a bundle
+    auto const state_path = is_bundle ? std::filesystem::path{ path }.parent_path() : std::filesystem::path{ path };
+
+    auto const endpoint = result["endpoint"].as<std::string>();
+    if(mode != Mode::LOCAL and endpoint.empty())
+        throw std::runtime_error("coordinate and worker need an --endpoint");
+
+    auto const watch = result["watch"].as<bool>();
+    if(watch and mode != Mode::LOCAL)
+        throw std::runtime_error("--watch only works with local runs");
+    auto incremental = std::optional<IncrementalRun>{};
+    if(watch and is_bundle)
+        throw std::runtime_error("--watch needs a data folder, not a bundle");
+    if(watch and (result.count("trace") or not result["junit"].as<std::string>().empty()))
+        throw std::runtime_error("--trace and --junit are written when cliot exits, which --watch never does");
+    if(watch or result["incremental"].as<bool>()) {
+        auto db_path = std::filesystem::path{ result["results-db"].as<std::string>() };
+        if(db_path.empty())
+            db_path = state_path / ResultsDb::file_name;
+        incremental.emplace(db_path, fmt::format("{}:{}", host, port));
+    }
+
+    // shards only partition the suite the same way if they all read the same history
+    auto durations_path = std::filesystem::path{ result["durations"].as<std::string>() };
+    if(durations_path.empty())
+        durations_path = state_path / DurationHistory::file_name;
+    auto durations = DurationHistory{ durations_path };
+    auto shard     = result.count("shard") ? std::optional<Shard>{ Shard::parse(result["shard"].as<std::string>()) } : std::nullopt;
+    if(shard)
+        durations.freeze(); // still used to order the flows, but the next shard has to see the same history
+
+    auto const trace_path = result.count("trace") ? result["trace"].as<std::string>() : std::string{};
+    if(not trace_path.empty())
+        trace::Tracer::instance().enable();
+
+    ArtifactStore::instance().configure(result["artifacts"].as<std::string>(), result["max-payload"].as<std::size_t>());
+    Timeouts::set_default(std::chrono::milliseconds{ result["timeout"].as<uint64_t>() });
+
+    // forked before any io or reporting thread exists; every isolated flow is a child of this process
+    auto fork_server = std::optional<isolation::ForkServer>{};
+    if(result["isolate"].as<bool>())
+        fork_server.emplace([host, port](std::string const &name, std::string const &dir, isolation::FrameWriter &out) {
+            run_isolated(host, port, name, dir, out);
+        });
+
+    auto metrics_server = std::optional<metrics::Server>{};
+    if(result.count("metrics-port"))
+        metrics_server.emplace(result["metrics-port"].as<uint16_t>());
+
+    // a worker sends its results as they are recorded, so the coordinator has them before the next flow is handed out
+    auto channel = mode == Mode::WORKER ? std::make_unique<distributed::Channel>(endpoint) : nullptr;
+
     rep_renderer_t renderer{ verbose };
-    auto reporting_deps = di::Deps<rep_renderer_t>{ renderer };
-    reporting_t reporting{ reporting_deps, true };
+    JsonLinesRenderer json_lines{ result["jsonl"].as<std::string>() };
+    JUnitRenderer junit{ result["junit"].as<std::string>() };
+    RemoteRenderer remote{ channel.get() };
+    auto reporting_deps = di::Deps<rep_renderer_t, JsonLinesRenderer, JUnitRenderer, RemoteRenderer>{ renderer, json_lines, junit, remote };
+    reporting_t reporting{ reporting_deps, mode == Mode::WORKER or not async_output, queue_size, overflow };
 
     di::Deps<reporting_t> base_deps{ reporting };
 
+    // every flow running at once holds one connection at a time, so the pool has to keep up with --jobs
+    auto const connections = std::max(AsyncConnectionPool::default_size, result["jobs"].as<std::size_t>());
+
     fetcher_t fetcher{};
-    con_man_t con_man{ host, std::to_string(port), fetcher };
-    crawler_t crawler{ base_deps, path, filter };
+    con_man_t con_man{ host, std::to_string(port), connections, fetcher };
+    crawler_t crawler{ base_deps, path, filter, not result["no-manifest"].as<bool>() };
 
     auto flow_deps = di::combine(base_deps, di::Deps<con_man_t>{ con_man });
     flow_factory_t flow_factory{ flow_deps };
 
     // todo: find out why di::extend() does not work
     auto scheduler_deps = di::combine(flow_deps, di::Deps<flow_factory_t, crawler_t>{ flow_factory, crawler });
-    scheduler_t scheduler{ scheduler_deps };
+    scheduler_t scheduler{ scheduler_deps,
+        { incremental ? &*incremental : nullptr,
+            &durations,
+            result["jobs"].as<std::size_t>(),
+            shard,
+            fork_server ? &*fork_server : nullptr,
+            std::chrono::milliseconds{ result["flow-timeout"].as<uint64_t>() } } };
+
+    if(mode == Mode::COORDINATE) {
+        auto flow_dirs = crawler.crawl();
+        if(shard) {
+            auto const selected = select_shard(flow_dirs, *shard, durations);
+            std::erase_if(flow_dirs, [&selected](auto const &flow) {
+                return not selected.contains(flow.first);
+            });
+        }
+
+        // same order as a local run with --jobs: workers pull the longest flows first
+        auto names = std::vector<std::string>{};
+        for(auto const &[name, dir] : flow_dirs)
+            names.push_back(name);
+        auto plan = durations.predict(names);
+        sort_longest_first(plan);
+        names.clear();
+        std::transform(std::begin(plan), std::end(plan), std::back_inserter(names), [](auto const &p) {
+            return p.name;
+        });
+
+        auto const lease_timeout = std::chrono::milliseconds{ result["lease-timeout"].as<uint64_t>() };
+        distributed::Coordinator<reporting_t>{ reporting, endpoint, names, &durations, lease_timeout }.run();
+    } else if(mode == Mode::WORKER) {
+        auto const slots = result["jobs"].as<std::size_t>();
+        distributed::Worker<scheduler_t, reporting_t>{ scheduler, reporting, *channel, crawler.crawl(), slots }.run();
+    }
+
+    if(mode != Mode::LOCAL) {
+        if(not trace_path.empty())
+            trace::Tracer::instance().write(trace_path);
+        return EXIT_SUCCESS;
+    }
+
+    // watching starts before the first run so that edits made while it runs are not missed
+    auto watcher = watch ? std::optional<util::DirectoryWatcher>{ std::in_place, path } : std::nullopt;
+    auto status  = scheduler.run();
+    if(watcher) {
+        // only returns when interrupted; every change re-runs the flows it affects
+        while(true) {
+            auto const changed = watcher->wait();
+            reporting.record(SimpleEvent{ "WATCH", fmt::format("{} file(s) changed, running affected flows", changed.size()) });
+            status = scheduler.run();
+        }
+    }
 
-    return scheduler.run();
+    if(not trace_path.empty())
+        trace::Tracer::instance().write(trace_path);
+    return status;
 } catch(std::exception const &e) {
     fmt::print("{}\n", e.what());
     return EXIT_FAILURE;
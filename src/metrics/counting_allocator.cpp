@@ -0,0 +1,31 @@
+// Replaces the global operator new/delete to count allocations per thread.
+// Only linked into the cliot executable and the tests; everything else sees zero allocations.
+
+#include <metrics/usage.hpp>
+
+#include <cstdlib>
+#include <new>
+
+void *operator new(std::size_t size) {
+    auto &current = metrics::usage();
+    ++current.allocations;
+    current.allocated += size;
+
+    for(;;) {
+        if(auto *ptr = std::malloc(size == 0 ? 1 : size); ptr != nullptr)
+            return ptr;
+        if(auto handler = std::get_new_handler(); handler != nullptr)
+            handler();
+        else
+            throw std::bad_alloc{};
+    }
+}
+
+// the array and nothrow forms end up in these by default
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, [[maybe_unused]] std::size_t size) noexcept {
+    std::free(ptr);
+}
@@ -0,0 +1,112 @@
+#include <metrics/registry.hpp>
+
+#include <fmt/format.h>
+
+#include <iterator>
+
+namespace metrics {
+
+namespace {
+constexpr auto relaxed = std::memory_order_relaxed;
+
+void render_counter(std::string &out, std::string const &name, std::string const &help, std::uint64_t value) {
+    fmt::format_to(std::back_inserter(out), "# TYPE {0} counter\n# HELP {0} {1}\n{0}_total {2}\n", name, help, value);
+}
+
+void render_gauge(std::string &out, std::string const &name, std::string const &help, std::int64_t value) {
+    fmt::format_to(std::back_inserter(out), "# TYPE {0} gauge\n# HELP {0} {1}\n{0} {2}\n", name, help, value);
+}
+
+std::string escaped(std::string const &label) {
+    std::string result;
+    for(auto c : label) {
+        if(c == '"' or c == '\\')
+            result += '\\';
+        if(c == '\n')
+            result += "\\n";
+        else
+            result += c;
+    }
+    return result;
+}
+} // namespace
+
+void Histogram::observe(std::chrono::microseconds value) {
+    auto const seconds = value.count() / 1'000'000.0;
+
+    auto bucket = std::size_t{ 0 };
+    while(bucket < bounds.size() and seconds > bounds[bucket])
+        ++bucket;
+
+    buckets_[bucket].fetch_add(1, relaxed);
+    count_.fetch_add(1, relaxed);
+    sum_us_.fetch_add(static_cast<std::uint64_t>(value.count()), relaxed);
+}
+
+void Histogram::render(std::string &out, std::string const &name, std::string const &help) const {
+    auto it = std::back_inserter(out);
+    fmt::format_to(it, "# TYPE {0} histogram\n# HELP {0} {1}\n", name, help);
+
+    // buckets are stored individually and rendered cumulatively
+    auto cumulative = std::uint64_t{ 0 };
+    for(auto i = std::size_t{ 0 }; i < bounds.size(); ++i) {
+        cumulative += buckets_[i].load(relaxed);
+        fmt::format_to(it, "{}_bucket{{le=\"{}\"}} {}\n", name, bounds[i], cumulative);
+    }
+    cumulative += buckets_.back().load(relaxed);
+    fmt::format_to(it, "{}_bucket{{le=\"+Inf\"}} {}\n", name, cumulative);
+    fmt::format_to(it, "{}_count {}\n", name, count_.load(relaxed));
+    fmt::format_to(it, "{}_sum {}\n", name, sum_us_.load(relaxed) / 1'000'000.0);
+}
+
+Registry &Registry::instance() {
+    static Registry registry;
+    return registry;
+}
+
+void Registry::response(std::string const &method) {
+    // every thread keeps the counters it used, so only the first response to a method takes the lock
+    thread_local std::map<std::string, std::atomic<std::uint64_t> *, std::less<>> cache;
+
+    auto it = cache.find(method);
+    if(it == std::end(cache))
+        it = cache.emplace(method, &responses(method)).first;
+    it->second->fetch_add(1, relaxed);
+}
+
+std::atomic<std::uint64_t> &Registry::responses(std::string_view method) {
+    auto const key = method.empty() ? std::string_view{ "<none>" } : method;
+
+    std::scoped_lock l{ mtx_ };
+    auto it = responses_.find(key);
+    if(it == std::end(responses_))
+        it = responses_.emplace(key, std::make_unique<std::atomic<std::uint64_t>>(0)).first;
+    return *it->second;
+}
+
+std::string Registry::render() const {
+    std::string out;
+    render_counter(out, "cliot_requests", "Requests sent", requests_sent.load(relaxed));
+
+    {
+        std::scoped_lock l{ mtx_ };
+        fmt::format_to(std::back_inserter(out), "# TYPE cliot_responses counter\n# HELP cliot_responses Responses received per method\n");
+        for(auto const &[method, counter] : responses_)
+            fmt::format_to(std::back_inserter(out), "cliot_responses_total{{method=\"{}\"}} {}\n", escaped(method), counter->load(relaxed));
+    }
+
+    render_counter(out, "cliot_validation_failures", "Responses that did not match their expectations", validation_failures.load(relaxed));
+    render_counter(out, "cliot_flows_passed", "Flows that passed", flows_passed.load(relaxed));
+    render_counter(out, "cliot_flows_failed", "Flows that failed", flows_failed.load(relaxed));
+    render_gauge(out, "cliot_requests_in_flight", "Requests waiting for a response", in_flight.load(relaxed));
+    render_gauge(out, "cliot_pool_connections", "Connections in the pool", pool_size.load(relaxed));
+    render_gauge(out, "cliot_pool_connections_borrowed", "Connections currently borrowed from the pool", pool_borrowed.load(relaxed));
+    render_counter(out, "cliot_sent_bytes", "Bytes written to Clio", bytes_sent.load(relaxed));
+    render_counter(out, "cliot_received_bytes", "Bytes read from Clio", bytes_received.load(relaxed));
+    latency.render(out, "cliot_response_latency_seconds", "Time from sending a request until its response was read");
+
+    out += "# EOF\n";
+    return out;
+}
+
+} // namespace metrics
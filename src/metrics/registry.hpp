@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace metrics {
+
+/**
+ * @brief Cumulative histogram with fixed buckets, safe to observe from any thread
+ */
+class Histogram {
+public:
+    static constexpr std::array<double, 13> bounds = { 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10 }; // seconds
+
+    void observe(std::chrono::microseconds value);
+
+    /**
+     * @brief Appends the histogram in OpenMetrics text format
+     */
+    void render(std::string &out, std::string const &name, std::string const &help) const;
+
+private:
+    std::array<std::atomic<std::uint64_t>, bounds.size() + 1> buckets_ = {}; // last one is +Inf
+    std::atomic<std::uint64_t> count_                                  = 0;
+    std::atomic<std::uint64_t> sum_us_                                 = 0;
+};
+
+/**
+ * @brief Process-wide live counters of a run
+ *
+ * Everything is a relaxed atomic so updating is cheap enough to be always on;
+ * the values are only rendered when scraped. Counters per method are created
+ * under a lock the first time a thread sees the method and looked up without
+ * one after that.
+ */
+class Registry {
+public:
+    static Registry &instance();
+
+    std::atomic<std::uint64_t> requests_sent       = 0;
+    std::atomic<std::uint64_t> validation_failures = 0;
+    std::atomic<std::uint64_t> flows_passed        = 0;
+    std::atomic<std::uint64_t> flows_failed        = 0;
+    std::atomic<std::int64_t> in_flight            = 0;
+    std::atomic<std::int64_t> pool_size            = 0;
+    std::atomic<std::int64_t> pool_borrowed        = 0;
+    std::atomic<std::uint64_t> bytes_sent          = 0;
+    std::atomic<std::uint64_t> bytes_received      = 0;
+    Histogram latency;
+
+    /**
+     * @brief Counts a response to a request with the given method
+     */
+    void response(std::string const &method);
+
+    /**
+     * @brief All metrics in OpenMetrics text format
+     */
+    std::string render() const;
+
+private:
+    Registry() = default;
+
+    mutable std::mutex mtx_;
+    std::map<std::string, std::unique_ptr<std::atomic<std::uint64_t>>, std::less<>> responses_; // never erased, counters stay put
+
+    std::atomic<std::uint64_t> &responses(std::string_view method);
+};
+
+} // namespace metrics
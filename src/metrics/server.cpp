@@ -0,0 +1,99 @@
+#include <metrics/registry.hpp>
+#include <metrics/server.hpp>
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/version.hpp>
+#include <fmt/format.h>
+
+#include <chrono>
+#include <exception>
+#include <memory>
+
+namespace beast = boost::beast;
+namespace http  = beast::http;
+namespace net   = boost::asio;
+using tcp       = net::ip::tcp;
+
+namespace metrics {
+
+namespace {
+constexpr auto io_timeout = std::chrono::seconds{ 5 };
+
+// one scrape: read a request, answer it and close
+class Connection : public std::enable_shared_from_this<Connection> {
+    beast::tcp_stream stream_;
+    beast::flat_buffer buffer_;
+    http::request<http::string_body> req_;
+    http::response<http::string_body> res_;
+
+public:
+    explicit Connection(tcp::socket &&socket)
+        : stream_{ std::move(socket) } { }
+
+    void run() {
+        stream_.expires_after(io_timeout);
+        http::async_read(stream_, buffer_, req_, beast::bind_front_handler(&Connection::on_read, shared_from_this()));
+    }
+
+private:
+    void on_read(beast::error_code ec, [[maybe_unused]] std::size_t bytes_transferred) {
+        if(ec)
+            return;
+
+        res_.version(req_.version());
+        res_.keep_alive(false);
+        res_.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+        if(req_.method() == http::verb::get) {
+            res_.result(http::status::ok);
+            res_.set(http::field::content_type, "application/openmetrics-text; version=1.0.0; charset=utf-8");
+            res_.body() = Registry::instance().render();
+        } else {
+            res_.result(http::status::method_not_allowed);
+        }
+        res_.prepare_payload();
+
+        stream_.expires_after(io_timeout);
+        http::async_write(stream_, res_, beast::bind_front_handler(&Connection::on_write, shared_from_this()));
+    }
+
+    void on_write(beast::error_code ec, [[maybe_unused]] std::size_t bytes_transferred) {
+        if(not ec)
+            stream_.socket().shutdown(tcp::socket::shutdown_send, ec);
+    }
+};
+} // namespace
+
+Server::Server(std::uint16_t port)
+    : acceptor_{ ctx_, tcp::endpoint{ net::ip::make_address("127.0.0.1"), port } } {
+    accept();
+    worker_ = std::thread{ [this] {
+        try {
+            ctx_.run();
+        } catch(std::exception const &e) {
+            fmt::print("Exception on metrics thread: {}\n", e.what());
+        }
+    } };
+}
+
+Server::~Server() {
+    ctx_.stop();
+    worker_.join();
+}
+
+std::uint16_t Server::port() const {
+    return acceptor_.local_endpoint().port();
+}
+
+void Server::accept() {
+    acceptor_.async_accept([this](beast::error_code ec, tcp::socket socket) {
+        if(ec == net::error::operation_aborted)
+            return;
+
+        if(not ec)
+            std::make_shared<Connection>(std::move(socket))->run();
+        accept();
+    });
+}
+
+} // namespace metrics
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+
+#include <cstdint>
+#include <thread>
+
+namespace metrics {
+
+/**
+ * @brief Serves the metrics Registry over HTTP on its own thread
+ *
+ * Every GET request is answered with the current metrics in OpenMetrics text format.
+ */
+class Server {
+    boost::asio::io_context ctx_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    std::thread worker_;
+
+public:
+    /**
+     * @param port Local port to listen on; 0 picks a free one
+     */
+    explicit Server(std::uint16_t port);
+    ~Server();
+
+    Server(Server const &)            = delete;
+    Server &operator=(Server const &) = delete;
+
+    std::uint16_t port() const;
+
+private:
+    void accept();
+};
+
+} // namespace metrics
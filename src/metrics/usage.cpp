@@ -0,0 +1,24 @@
+#include <metrics/usage.hpp>
+
+#include <sys/resource.h>
+
+namespace metrics {
+
+std::uint64_t peak_rss_kb() {
+    rusage ru{};
+    if(getrusage(RUSAGE_SELF, &ru) != 0)
+        return 0;
+#ifdef __APPLE__
+    return static_cast<std::uint64_t>(ru.ru_maxrss) / 1024; // bytes on macos
+#else
+    return static_cast<std::uint64_t>(ru.ru_maxrss);
+#endif
+}
+
+Usage snapshot() {
+    auto result        = usage();
+    result.peak_rss_kb = peak_rss_kb();
+    return result;
+}
+
+} // namespace metrics
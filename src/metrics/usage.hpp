@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+namespace metrics {
+
+/**
+ * @brief Resources used by the calling thread
+ *
+ * Flows run on a single thread, so the difference of two snapshots taken on that thread
+ * before and after a flow is what the flow used. Allocations are only counted when the
+ * executable links the counting operator new.
+ */
+struct Usage {
+    using duration_t = std::chrono::microseconds;
+
+    std::uint64_t requests       = 0;
+    std::uint64_t frames         = 0;
+    std::uint64_t bytes_sent     = 0;
+    std::uint64_t bytes_received = 0;
+    std::uint64_t allocations    = 0;
+    std::uint64_t allocated      = 0; // bytes
+    duration_t pool_wait         = {};
+    duration_t render            = {};
+    duration_t validation        = {};
+    std::uint64_t peak_rss_kb    = 0; // high-water mark of the whole process, not a difference
+
+    Usage &operator+=(Usage const &other) {
+        requests += other.requests;
+        frames += other.frames;
+        bytes_sent += other.bytes_sent;
+        bytes_received += other.bytes_received;
+        allocations += other.allocations;
+        allocated += other.allocated;
+        pool_wait += other.pool_wait;
+        render += other.render;
+        validation += other.validation;
+        peak_rss_kb = std::max(peak_rss_kb, other.peak_rss_kb);
+        return *this;
+    }
+
+    // the peak rss of lhs is kept as is
+    friend Usage operator-(Usage lhs, Usage const &rhs) {
+        lhs.requests -= rhs.requests;
+        lhs.frames -= rhs.frames;
+        lhs.bytes_sent -= rhs.bytes_sent;
+        lhs.bytes_received -= rhs.bytes_received;
+        lhs.allocations -= rhs.allocations;
+        lhs.allocated -= rhs.allocated;
+        lhs.pool_wait -= rhs.pool_wait;
+        lhs.render -= rhs.render;
+        lhs.validation -= rhs.validation;
+        return lhs;
+    }
+};
+
+/**
+ * @brief Running totals of the calling thread
+ */
+inline Usage &usage() noexcept {
+    thread_local Usage current; // trivially destructible so it is safe to use from operator new
+    return current;
+}
+
+/**
+ * @brief Peak resident set size of the process in kilobytes
+ */
+std::uint64_t peak_rss_kb();
+
+/**
+ * @brief Snapshot of the calling thread's usage with the current peak RSS filled in
+ */
+Usage snapshot();
+
+/**
+ * @brief Adds the time between construction and destruction to one of the usage durations
+ */
+class Timed {
+    Usage::duration_t Usage::*field_;
+    std::chrono::steady_clock::time_point started_ = std::chrono::steady_clock::now();
+
+public:
+    explicit Timed(Usage::duration_t Usage::*field)
+        : field_{ field } { }
+
+    ~Timed() {
+        usage().*field_ += std::chrono::duration_cast<Usage::duration_t>(std::chrono::steady_clock::now() - started_);
+    }
+
+    Timed(Timed const &)            = delete;
+    Timed &operator=(Timed const &) = delete;
+};
+
+} // namespace metrics
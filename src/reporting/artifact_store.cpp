@@ -0,0 +1,78 @@
+#include <reporting/artifact_store.hpp>
+#include <util/hash.hpp>
+#include <util/state_file.hpp>
+
+#include <fmt/format.h>
+
+#include <string_view>
+#include <utility>
+
+ArtifactStore &ArtifactStore::instance() {
+    static ArtifactStore store;
+    return store;
+}
+
+void ArtifactStore::configure(std::filesystem::path const &dir, std::size_t max_inline) {
+    std::scoped_lock l{ mtx_ };
+    if(not dir.empty())
+        std::filesystem::create_directories(dir);
+
+    dir_        = dir;
+    max_inline_ = max_inline;
+    written_.clear();
+}
+
+namespace {
+constexpr auto truncation_notice = std::string_view{ " more bytes truncated, " };
+
+// the notice counts against max_inline, so the result fits unless the notice alone doesn't
+std::string truncated(std::string &&payload, std::size_t max_inline, std::string_view hint) {
+    auto const longest = fmt::formatted_size("\n... {}{}{}", payload.size(), truncation_notice, hint);
+    auto const kept    = max_inline > longest ? max_inline - longest : 0;
+    auto const dropped = payload.size() - kept;
+    payload.resize(kept);
+    payload.shrink_to_fit();
+    payload += fmt::format("\n... {}{}{}", dropped, truncation_notice, hint);
+    return std::move(payload);
+}
+
+// a reference or truncation spill returned earlier, e.g. the detail of an issue rethrown by a subflow
+bool is_spilled(std::string_view payload) {
+    if(payload.starts_with("<artifact ") and payload.ends_with(" bytes)>"))
+        return true;
+    auto const notice = payload.rfind("\n... ");
+    return notice != std::string_view::npos and payload.find(truncation_notice, notice) != std::string_view::npos;
+}
+} // namespace
+
+std::string ArtifactStore::spill(std::string &&payload) {
+    auto [dir, max_inline] = [this] {
+        std::scoped_lock l{ mtx_ };
+        return std::make_pair(dir_, max_inline_);
+    }();
+
+    if(payload.size() <= max_inline or is_spilled(payload))
+        return std::move(payload);
+
+    if(dir.empty())
+        return truncated(std::move(payload), max_inline, "use --artifacts to keep complete payloads");
+
+    auto const digest = util::sha256_hex(payload);
+    auto const path   = dir / fmt::format("{}.txt", digest);
+    auto const ref    = fmt::format("<artifact {} ({} bytes)>", path.string(), payload.size());
+
+    {
+        std::scoped_lock l{ mtx_ };
+        if(written_.contains(digest))
+            return ref; // same payload seen before
+    }
+
+    // threads spilling the same payload may both get here, each renames a complete file over path;
+    // a failure is reported no matter what, so an unwritable artifact only costs the complete payload
+    if(not util::write_file_atomically(path, payload))
+        return truncated(std::move(payload), max_inline, fmt::format("could not write artifact {}", path.string()));
+
+    std::scoped_lock l{ mtx_ };
+    written_.insert(digest);
+    return ref;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+/**
+ * @brief Keeps large failure payloads (responses, rendered expectations) out of memory
+ *
+ * Payloads above the inline limit are written once into a content-addressed directory and
+ * replaced by a short reference to the file. Identical payloads share one file. Without an
+ * artifact directory large payloads are truncated instead so memory stays bounded either way.
+ */
+class ArtifactStore {
+public:
+    static constexpr std::size_t default_max_inline = 64 * 1024;
+
+    static ArtifactStore &instance();
+
+    /**
+     * @param dir Where to write artifacts; empty to truncate large payloads instead
+     * @param max_inline Payloads up to this size are kept as is
+     */
+    void configure(std::filesystem::path const &dir, std::size_t max_inline = default_max_inline);
+
+    /**
+     * @brief Returns the payload itself if it is small enough, a reference to its artifact otherwise
+     *
+     * Never throws for an artifact that can't be written; the payload is truncated instead.
+     * Truncated payloads fit max_inline where the truncation notice leaves room for content, and
+     * what spill returned is returned unchanged when spilled again, e.g. by an enclosing subflow.
+     */
+    std::string spill(std::string &&payload);
+
+private:
+    ArtifactStore() = default;
+
+    std::mutex mtx_;
+    std::filesystem::path dir_;
+    std::size_t max_inline_ = default_max_inline;
+    std::unordered_set<std::string> written_; // SHA-256 of the artifacts written
+};
@@ -5,27 +5,45 @@
 #include <fmt/compile.h>
 
 #include <algorithm>
+#include <iterator>
 #include <string>
+#include <string_view>
 #include <vector>
 
-DefaultReportRenderer::DefaultReportRenderer(uint16_t verbose)
-    : verbose{ verbose } {
+namespace {
+std::string ms(LatencyEvent::duration_t d) {
+    return fmt::format("{:.3f}ms", d.count() / 1000.0);
+}
+} // namespace
+
+DefaultReportRenderer::DefaultReportRenderer(uint16_t verbose, std::FILE *out)
+    : verbose{ verbose }
+    , out_{ out } {
 }
 
 void DefaultReportRenderer::operator()(SimpleEvent const &ev) const {
     if(verbose < 1)
         return;
-    fmt::print(fg(fmt::color::ghost_white), "? | ");
-    fmt::print(fg(fmt::color::pale_green) | fmt::emphasis::bold, "{} ", ev.label);
-    fmt::print(fg(fmt::color::sky_blue) | fmt::emphasis::bold, "{}\n", ev.message);
+
+    fmt::memory_buffer buf;
+    auto out = std::back_inserter(buf);
+    fmt::format_to(out, fg(fmt::color::ghost_white), "? | ");
+    fmt::format_to(out, fg(fmt::color::pale_green) | fmt::emphasis::bold, "{} ", ev.label);
+    fmt::format_to(out, fg(fmt::color::sky_blue) | fmt::emphasis::bold, "{}\n", ev.message);
+    write(buf);
 }
 
 void DefaultReportRenderer::operator()(SuccessEvent const &ev) const {
     if(verbose < 1)
         return;
-    fmt::print(fg(fmt::color::ghost_white), "+ | ");
-    fmt::print(fg(fmt::color::pale_green) | fmt::emphasis::bold, "SUCCESS ");
-    fmt::print(fg(fmt::color::sky_blue) | fmt::emphasis::bold, "{}\n", ev.flow_name);
+
+    fmt::memory_buffer buf;
+    auto out = std::back_inserter(buf);
+    fmt::format_to(out, fg(fmt::color::ghost_white), "+ | ");
+    fmt::format_to(out, fg(fmt::color::pale_green) | fmt::emphasis::bold, "SUCCESS ");
+    fmt::format_to(out, fg(fmt::color::sky_blue) | fmt::emphasis::bold, "{} ", ev.flow_name);
+    fmt::format_to(out, fg(fmt::color::ghost_white), "({}ms)\n", ev.duration.count());
+    write(buf);
 }
 
 void DefaultReportRenderer::operator()(FailureEvent const &ev) const {
@@ -46,37 +64,117 @@ void DefaultReportRenderer::operator()(FailureEvent const &ev) const {
     auto response   = fmt::format(fg(fmt::color::medium_violet_red) | fmt::emphasis::italic, "{}", ev.response);
     auto message    = fmt::format("\n [-] {}\n\nIssues:\n{}\n\nLive response:\n---\n{}\n---", title, all_issues, response);
 
-    fmt::print(fg(fmt::color::ghost_white), "- | ");
-    fmt::print(fg(fmt::color::red) | fmt::emphasis::bold, "FAIL ");
-    fmt::print("'{}': {}\n",
+    fmt::memory_buffer buf;
+    auto out = std::back_inserter(buf);
+    fmt::format_to(out, fg(fmt::color::ghost_white), "- | ");
+    fmt::format_to(out, fg(fmt::color::red) | fmt::emphasis::bold, "FAIL ");
+    fmt::format_to(out, "'{}': {}\n",
         fmt::format(fg(fmt::color::sky_blue) | fmt::emphasis::bold, "{}", ev.flow_name),
         message);
+    write(buf);
 }
 
 void DefaultReportRenderer::operator()(RequestEvent const &ev) const {
     if(verbose < 2)
         return;
 
-    fmt::print(fg(fmt::color::ghost_white), "? | ");
-    fmt::print(fg(fmt::color::pale_green) | fmt::emphasis::bold, "REQUEST ");
-    fmt::print(fg(fmt::color::sky_blue) | fmt::emphasis::bold, "{}\n", ev.path);
+    fmt::memory_buffer buf;
+    auto out = std::back_inserter(buf);
+    fmt::format_to(out, fg(fmt::color::ghost_white), "? | ");
+    fmt::format_to(out, fg(fmt::color::pale_green) | fmt::emphasis::bold, "REQUEST ");
+    fmt::format_to(out, fg(fmt::color::sky_blue) | fmt::emphasis::bold, "{}\n", ev.path);
 
-    fmt::print("Request data:\n---\n{}\n---\nStore state:\n---\n{}\n---\n",
+    fmt::format_to(out, "Request data:\n---\n{}\n---\nStore state:\n---\n{}\n---\n",
         fmt::format(fg(fmt::color::sky_blue) | fmt::emphasis::italic, "{}", ev.data),
         fmt::format(fg(fmt::color::blue_violet) | fmt::emphasis::italic, "{}", ev.store.dump(4)));
+    write(buf);
 }
 
 void DefaultReportRenderer::operator()(ResponseEvent const &ev) const {
     if(verbose < 2)
         return;
 
-    fmt::print(fg(fmt::color::ghost_white), "? | ");
-    fmt::print(fg(fmt::color::pale_green) | fmt::emphasis::bold, "RESPONSE ");
-    fmt::print(fg(fmt::color::sky_blue) | fmt::emphasis::bold, "{}\n", ev.path);
+    fmt::memory_buffer buf;
+    auto out = std::back_inserter(buf);
+    fmt::format_to(out, fg(fmt::color::ghost_white), "? | ");
+    fmt::format_to(out, fg(fmt::color::pale_green) | fmt::emphasis::bold, "RESPONSE ");
+    fmt::format_to(out, fg(fmt::color::sky_blue) | fmt::emphasis::bold, "{}\n", ev.path);
 
-    fmt::print("Response:\n---\n{}\n---\nExpectations:\n---\n{}\n---\n",
+    fmt::format_to(out, "Response:\n---\n{}\n---\nExpectations:\n---\n{}\n---\n",
         fmt::format(fg(fmt::color::sky_blue) | fmt::emphasis::italic, "{}", ev.response),
         fmt::format(fg(fmt::color::blue_violet) | fmt::emphasis::italic, "{}", ev.expectations));
+    write(buf);
+}
+
+void DefaultReportRenderer::operator()(LatencyEvent const &ev) const {
+    if(verbose < 2)
+        return;
+
+    fmt::memory_buffer buf;
+    auto out = std::back_inserter(buf);
+    fmt::format_to(out, fg(fmt::color::ghost_white), "? | ");
+    fmt::format_to(out, fg(fmt::color::pale_green) | fmt::emphasis::bold, "LATENCY ");
+    fmt::format_to(out, fg(fmt::color::sky_blue) | fmt::emphasis::bold, "{} ", ev.path);
+    fmt::format_to(out, "write {} first byte {} total {} ({} bytes out, {} bytes in)\n",
+        ms(ev.write), ms(ev.first_byte), ms(ev.total), ev.bytes_sent, ev.bytes_received);
+    write(buf);
+}
+
+void DefaultReportRenderer::operator()(LatencySummaryEvent const &ev) const {
+    if(verbose < 1)
+        return;
+
+    fmt::memory_buffer buf;
+    auto out = std::back_inserter(buf);
+    fmt::format_to(out, fg(fmt::color::ghost_white), "? | ");
+    fmt::format_to(out, fg(fmt::color::pale_green) | fmt::emphasis::bold, "LATENCY SUMMARY\n");
+
+    auto table = [&out](std::string_view title, std::vector<LatencySummaryEvent::Row> const &rows) {
+        fmt::format_to(out, fg(fmt::color::sky_blue) | fmt::emphasis::bold, "{}:\n", title);
+        fmt::format_to(out, "  {:>8} {:>12} {:>12} {:>12} {:>12}  {}\n", "count", "p50", "p90", "p99", "max", "name");
+        for(auto const &row : rows)
+            fmt::format_to(out, "  {:>8} {:>12} {:>12} {:>12} {:>12}  {}\n",
+                row.count, ms(row.p50), ms(row.p90), ms(row.p99), ms(row.max), row.key);
+    };
+    table("Per flow", ev.flows);
+    table("Per template", ev.templates);
+    table("Per method", ev.methods);
+
+    fmt::format_to(out, fg(fmt::color::sky_blue) | fmt::emphasis::bold, "Slowest:\n");
+    for(auto const &slow : ev.slowest)
+        fmt::format_to(out, "  {:>12}  {} ({})\n", ms(slow.total), slow.path, slow.flow);
+    write(buf);
+}
+
+void DefaultReportRenderer::operator()(UsageSummaryEvent const &ev) const {
+    if(verbose < 1)
+        return;
+
+    fmt::memory_buffer buf;
+    auto out = std::back_inserter(buf);
+    fmt::format_to(out, fg(fmt::color::ghost_white), "? | ");
+    fmt::format_to(out, fg(fmt::color::pale_green) | fmt::emphasis::bold, "RESOURCE USAGE\n");
+
+    // the peak rss is that of the whole process, so it only means something for the suite as a whole
+    auto row = [&out](std::string_view result, std::string_view name, std::chrono::milliseconds duration, metrics::Usage const &usage, bool with_rss) {
+        fmt::format_to(out, "  {:<4} {:>10} {:>6} {:>6} {:>12} {:>12} {:>12} {:>12} {:>12} {:>10} {:>12} {:>10}  {}\n",
+            result, fmt::format("{}ms", duration.count()), usage.requests, usage.frames, usage.bytes_sent, usage.bytes_received,
+            ms(usage.pool_wait), ms(usage.render), ms(usage.validation), usage.allocations, usage.allocated,
+            with_rss ? fmt::format("{}KiB", usage.peak_rss_kb) : std::string{}, name);
+    };
+
+    fmt::format_to(out, "  {:<4} {:>10} {:>6} {:>6} {:>12} {:>12} {:>12} {:>12} {:>12} {:>10} {:>12} {:>10}  {}\n",
+        "", "time", "reqs", "frames", "bytes out", "bytes in", "pool wait", "render", "validation", "allocs", "alloc bytes", "peak rss", "flow");
+
+    auto total    = metrics::Usage{};
+    auto duration = std::chrono::milliseconds{};
+    for(auto const &flow : ev.rows) {
+        row(flow.passed ? "ok" : "FAIL", flow.flow_name, flow.duration, flow.usage, false);
+        total += flow.usage;
+        duration += flow.duration;
+    }
+    row("", "total", duration, total, true);
+    write(buf);
 }
 
 std::string DefaultReportRenderer::operator()(FailureEvent::Data::Type type) const {
@@ -89,6 +187,8 @@ std::string DefaultReportRenderer::operator()(FailureEvent::Data::Type type) con
         return fmt::format(fg(fmt::color::indian_red) | fmt::emphasis::bold, "NOT EQUAL");
     case FailureEvent::Data::Type::TYPE_CHECK:
         return fmt::format(fg(fmt::color::indian_red) | fmt::emphasis::bold, "WRONG TYPE");
+    case FailureEvent::Data::Type::TIMEOUT:
+        return fmt::format(fg(fmt::color::orange_red) | fmt::emphasis::bold, "TIMEOUT");
     }
 }
 
@@ -105,3 +205,19 @@ std::string DefaultReportRenderer::operator()(FailureEvent::Data const &failure)
         fmt::format(fg(fmt::color::red) | fmt::emphasis::bold, "-"),
         this->operator()(failure.type), path, failure.message, detail);
 }
+
+void DefaultReportRenderer::flush() const {
+    std::scoped_lock l{ mtx_ };
+    std::fwrite(pending_.data(), 1, pending_.size(), out_);
+    std::fflush(out_);
+    pending_.clear();
+}
+
+void DefaultReportRenderer::write(fmt::memory_buffer const &buf) const {
+    std::scoped_lock l{ mtx_ };
+    pending_.append(buf.data(), buf.data() + buf.size());
+    if(pending_.size() >= flush_threshold) {
+        std::fwrite(pending_.data(), 1, pending_.size(), out_);
+        pending_.clear();
+    }
+}
@@ -2,19 +2,58 @@
 
 #include <reporting/events.hpp>
 
+#include <fmt/format.h>
+
+#include <cstdio>
+#include <mutex>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+/**
+ * @brief Renders events as colored text
+ *
+ * Every event is formatted in memory and appended to an output buffer in one go so that
+ * concurrently rendered events never interleave. The buffer is written out on flush() or
+ * whenever it grows past flush_threshold.
+ */
 struct DefaultReportRenderer {
+    static constexpr std::size_t flush_threshold = 64 * 1024;
+
     uint16_t verbose;
-    DefaultReportRenderer(uint16_t verbose);
+    DefaultReportRenderer(uint16_t verbose, std::FILE *out = stdout);
 
     void operator()(SimpleEvent const &ev) const;
     void operator()(SuccessEvent const &ev) const;
     void operator()(FailureEvent const &ev) const;
     void operator()(RequestEvent const &ev) const;
     void operator()(ResponseEvent const &ev) const;
+    void operator()(LatencyEvent const &ev) const;
+    void operator()(LatencySummaryEvent const &ev) const;
+    void operator()(UsageSummaryEvent const &ev) const;
+
+    /**
+     * @brief Requests and responses are only shown from verbosity 2 on
+     */
+    bool wants(std::type_identity<RequestEvent>) const {
+        return verbose >= 2;
+    }
+    bool wants(std::type_identity<ResponseEvent>) const {
+        return verbose >= 2;
+    }
 
     std::string operator()(FailureEvent::Data::Type type) const;
     std::string operator()(FailureEvent::Data const &failure) const;
+
+    /**
+     * @brief Writes out everything rendered so far
+     */
+    void flush() const;
+
+private:
+    void write(fmt::memory_buffer const &buf) const;
+
+    std::FILE *out_;
+    mutable std::mutex mtx_;
+    mutable fmt::memory_buffer pending_;
 };
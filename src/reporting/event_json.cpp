@@ -0,0 +1,207 @@
+#include <reporting/event_json.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+namespace event_json {
+
+namespace {
+using duration_t = LatencyEvent::duration_t;
+
+constexpr auto failure_types = std::array{
+    std::pair{ FailureEvent::Data::Type::LOGIC_ERROR, "logic_error" },
+    std::pair{ FailureEvent::Data::Type::NO_MATCH, "no_match" },
+    std::pair{ FailureEvent::Data::Type::NOT_EQUAL, "not_equal" },
+    std::pair{ FailureEvent::Data::Type::TYPE_CHECK, "type_check" },
+    std::pair{ FailureEvent::Data::Type::TIMEOUT, "timeout" }
+};
+
+inja::json micros(duration_t d) {
+    return d.count();
+}
+
+duration_t micros_of(inja::json const &data, char const *key) {
+    return duration_t{ data.at(key).get<duration_t::rep>() };
+}
+
+inja::json rows(std::vector<LatencySummaryEvent::Row> const &rows) {
+    auto result = inja::json::array();
+    for(auto const &row : rows)
+        result.push_back({ { "key", row.key },
+            { "count", row.count },
+            { "p50_us", micros(row.p50) },
+            { "p90_us", micros(row.p90) },
+            { "p99_us", micros(row.p99) },
+            { "max_us", micros(row.max) } });
+    return result;
+}
+
+inja::json usage_of(metrics::Usage const &usage) {
+    return { { "requests", usage.requests },
+        { "frames", usage.frames },
+        { "bytes_sent", usage.bytes_sent },
+        { "bytes_received", usage.bytes_received },
+        { "pool_wait_us", micros(usage.pool_wait) },
+        { "render_us", micros(usage.render) },
+        { "validation_us", micros(usage.validation) },
+        { "allocations", usage.allocations },
+        { "allocated_bytes", usage.allocated },
+        { "peak_rss_kb", usage.peak_rss_kb } };
+}
+
+metrics::Usage to_usage(inja::json const &data) {
+    auto usage           = metrics::Usage{};
+    usage.requests       = data.at("requests").get<std::uint64_t>();
+    usage.frames         = data.at("frames").get<std::uint64_t>();
+    usage.bytes_sent     = data.at("bytes_sent").get<std::uint64_t>();
+    usage.bytes_received = data.at("bytes_received").get<std::uint64_t>();
+    usage.pool_wait      = micros_of(data, "pool_wait_us");
+    usage.render         = micros_of(data, "render_us");
+    usage.validation     = micros_of(data, "validation_us");
+    usage.allocations    = data.at("allocations").get<std::uint64_t>();
+    usage.allocated      = data.at("allocated_bytes").get<std::uint64_t>();
+    usage.peak_rss_kb    = data.at("peak_rss_kb").get<std::uint64_t>();
+    return usage;
+}
+
+std::string type_name(FailureEvent::Data::Type type) {
+    auto const it = std::find_if(std::begin(failure_types), std::end(failure_types), [type](auto const &entry) {
+        return entry.first == type;
+    });
+    return it == std::end(failure_types) ? "unknown" : it->second;
+}
+
+FailureEvent::Data::Type type_of(std::string const &name) {
+    auto const it = std::find_if(std::begin(failure_types), std::end(failure_types), [&name](auto const &entry) {
+        return entry.second == name;
+    });
+    return it == std::end(failure_types) ? FailureEvent::Data::Type::LOGIC_ERROR : it->first;
+}
+} // namespace
+
+inja::json to_json(SimpleEvent const &ev) {
+    return { { "event", "simple" }, { "label", ev.label }, { "message", ev.message } };
+}
+
+inja::json to_json(SuccessEvent const &ev) {
+    return { { "event", "success" }, { "flow", ev.flow_name }, { "duration_ms", ev.duration.count() }, { "usage", usage_of(ev.usage) } };
+}
+
+inja::json to_json(FailureEvent const &ev) {
+    auto issues = inja::json::array();
+    std::transform(std::begin(ev.issues), std::end(ev.issues), std::back_inserter(issues), [](auto const &issue) {
+        return inja::json{ { "type", type_name(issue.type) },
+            { "path", issue.path },
+            { "message", issue.message },
+            { "detail", issue.detail } };
+    });
+
+    return { { "event", "failure" },
+        { "flow", ev.flow_name },
+        { "path", ev.path },
+        { "duration_ms", ev.duration.count() },
+        { "usage", usage_of(ev.usage) },
+        { "issues", std::move(issues) },
+        { "response", ev.response } };
+}
+
+inja::json to_json(RequestEvent const &ev) {
+    return { { "event", "request" }, { "path", ev.path }, { "data", ev.data } };
+}
+
+inja::json to_json(ResponseEvent const &ev) {
+    return { { "event", "response" }, { "path", ev.path }, { "response", ev.response }, { "expectations", ev.expectations } };
+}
+
+inja::json to_json(LatencyEvent const &ev) {
+    return { { "event", "latency" },
+        { "flow", ev.flow },
+        { "path", ev.path },
+        { "method", ev.method },
+        { "write_us", micros(ev.write) },
+        { "first_byte_us", micros(ev.first_byte) },
+        { "total_us", micros(ev.total) },
+        { "bytes_sent", ev.bytes_sent },
+        { "bytes_received", ev.bytes_received } };
+}
+
+inja::json to_json(LatencySummaryEvent const &ev) {
+    auto slowest = inja::json::array();
+    for(auto const &slow : ev.slowest)
+        slowest.push_back({ { "flow", slow.flow }, { "path", slow.path }, { "method", slow.method }, { "total_us", micros(slow.total) } });
+
+    return { { "event", "latency_summary" },
+        { "flows", rows(ev.flows) },
+        { "templates", rows(ev.templates) },
+        { "methods", rows(ev.methods) },
+        { "slowest", std::move(slowest) } };
+}
+
+inja::json to_json(UsageSummaryEvent const &ev) {
+    auto flows = inja::json::array();
+    for(auto const &row : ev.rows)
+        flows.push_back({ { "flow", row.flow_name },
+            { "passed", row.passed },
+            { "duration_ms", row.duration.count() },
+            { "usage", usage_of(row.usage) } });
+
+    return { { "event", "usage_summary" }, { "flows", std::move(flows) } };
+}
+
+SimpleEvent to_simple(inja::json const &data) {
+    return SimpleEvent{ data.at("label").get<std::string>(), data.at("message").get<std::string>() };
+}
+
+SuccessEvent to_success(inja::json const &data) {
+    return SuccessEvent{
+        data.at("flow").get<std::string>(),
+        std::chrono::milliseconds{ data.at("duration_ms").get<std::chrono::milliseconds::rep>() },
+        to_usage(data.at("usage"))
+    };
+}
+
+FailureEvent to_failure(inja::json const &data) {
+    auto issues = std::vector<FailureEvent::Data>{};
+    for(auto const &issue : data.at("issues"))
+        issues.emplace_back(type_of(issue.at("type").get<std::string>()),
+            issue.at("path").get<std::string>(),
+            issue.at("message").get<std::string>(),
+            issue.at("detail").get<std::string>());
+
+    return FailureEvent{
+        data.at("flow").get<std::string>(),
+        data.at("path").get<std::string>(),
+        std::move(issues),
+        data.at("response").get<std::string>(),
+        std::chrono::milliseconds{ data.at("duration_ms").get<std::chrono::milliseconds::rep>() },
+        to_usage(data.at("usage"))
+    };
+}
+
+RequestEvent to_request(inja::json const &data) {
+    return RequestEvent{ data.at("path").get<std::string>(), inja::json{}, data.at("data").get<std::string>() };
+}
+
+ResponseEvent to_response(inja::json const &data) {
+    return ResponseEvent{ data.at("path").get<std::string>(), data.at("response").get<std::string>(), data.at("expectations").get<std::string>() };
+}
+
+LatencyEvent to_latency(inja::json const &data) {
+    return LatencyEvent{
+        data.at("flow").get<std::string>(),
+        data.at("path").get<std::string>(),
+        data.at("method").get<std::string>(),
+        micros_of(data, "write_us"),
+        micros_of(data, "first_byte_us"),
+        micros_of(data, "total_us"),
+        data.at("bytes_sent").get<std::size_t>(),
+        data.at("bytes_received").get<std::size_t>()
+    };
+}
+
+} // namespace event_json
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <reporting/events.hpp>
+
+#include <inja/inja.hpp>
+
+/**
+ * @brief JSON representation of events as written by --jsonl and exchanged between coordinator and workers
+ *
+ * Every object carries its type in "event". Only the events that need to travel between
+ * processes can be read back.
+ */
+namespace event_json {
+
+inja::json to_json(SimpleEvent const &ev);
+inja::json to_json(SuccessEvent const &ev);
+inja::json to_json(FailureEvent const &ev);
+inja::json to_json(RequestEvent const &ev);
+inja::json to_json(ResponseEvent const &ev);
+inja::json to_json(LatencyEvent const &ev);
+inja::json to_json(LatencySummaryEvent const &ev);
+inja::json to_json(UsageSummaryEvent const &ev);
+
+SimpleEvent to_simple(inja::json const &data);
+SuccessEvent to_success(inja::json const &data);
+FailureEvent to_failure(inja::json const &data);
+RequestEvent to_request(inja::json const &data); // without the store, which is not serialized
+ResponseEvent to_response(inja::json const &data);
+LatencyEvent to_latency(inja::json const &data);
+
+} // namespace event_json
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <metrics/usage.hpp>
+
 #include <inja/inja.hpp>
 
 #include <chrono>
+#include <cstddef>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 struct MetaEvent {
@@ -23,10 +27,16 @@ struct SimpleEvent : public MetaEvent {
 
 struct SuccessEvent : public MetaEvent {
     SuccessEvent(
-        std::string const &flow_name)
+        std::string const &flow_name,
+        std::chrono::milliseconds duration = {},
+        metrics::Usage const &usage        = {})
         : MetaEvent{}
-        , flow_name{ flow_name } { }
+        , flow_name{ flow_name }
+        , duration{ duration }
+        , usage{ usage } { }
     std::string flow_name;
+    std::chrono::milliseconds duration;
+    metrics::Usage usage;
 };
 
 struct FailureEvent : public MetaEvent {
@@ -35,7 +45,8 @@ struct FailureEvent : public MetaEvent {
             LOGIC_ERROR,
             NO_MATCH,
             NOT_EQUAL,
-            TYPE_CHECK
+            TYPE_CHECK,
+            TIMEOUT
         };
         Data(
             Type type,
@@ -55,17 +66,23 @@ struct FailureEvent : public MetaEvent {
     FailureEvent(
         std::string const &flow_name,
         std::string const &path,
-        std::vector<Data> const &issues,
-        std::string const &response)
+        std::vector<Data> issues,
+        std::string response,
+        std::chrono::milliseconds duration = {},
+        metrics::Usage const &usage        = {})
         : MetaEvent{}
         , flow_name{ flow_name }
         , path{ path }
-        , issues{ issues }
-        , response{ response } { }
+        , issues{ std::move(issues) }
+        , response{ std::move(response) }
+        , duration{ duration }
+        , usage{ usage } { }
     std::string flow_name;
     std::string path;
     std::vector<Data> issues;
     std::string response;
+    std::chrono::milliseconds duration;
+    metrics::Usage usage;
 };
 
 struct RequestEvent : public MetaEvent {
@@ -96,6 +113,77 @@ struct ResponseEvent : public MetaEvent {
     std::string expectations;
 };
 
+struct LatencyEvent : public MetaEvent {
+    using duration_t = std::chrono::microseconds;
+
+    LatencyEvent(
+        std::string const &flow,
+        std::string const &path,
+        std::string const &method,
+        duration_t write,
+        duration_t first_byte,
+        duration_t total,
+        std::size_t bytes_sent,
+        std::size_t bytes_received)
+        : MetaEvent{}
+        , flow{ flow }
+        , path{ path }
+        , method{ method }
+        , write{ write }
+        , first_byte{ first_byte }
+        , total{ total }
+        , bytes_sent{ bytes_sent }
+        , bytes_received{ bytes_received } { }
+    std::string flow;
+    std::string path;      // request template
+    std::string method;    // empty if the request has no method/command
+    duration_t write;      // from write start to write completion
+    duration_t first_byte; // from write start to the first byte of the response
+    duration_t total;      // from write start to the complete response frame
+    std::size_t bytes_sent;
+    std::size_t bytes_received;
+};
+
+struct LatencySummaryEvent : public MetaEvent {
+    struct Row {
+        std::string key;
+        std::size_t count;
+        LatencyEvent::duration_t p50;
+        LatencyEvent::duration_t p90;
+        LatencyEvent::duration_t p99;
+        LatencyEvent::duration_t max;
+    };
+
+    LatencySummaryEvent(
+        std::vector<Row> const &flows,
+        std::vector<Row> const &templates,
+        std::vector<Row> const &methods,
+        std::vector<LatencyEvent> const &slowest)
+        : MetaEvent{}
+        , flows{ flows }
+        , templates{ templates }
+        , methods{ methods }
+        , slowest{ slowest } { }
+    std::vector<Row> flows;
+    std::vector<Row> templates;
+    std::vector<Row> methods;
+    std::vector<LatencyEvent> slowest;
+};
+
+struct UsageSummaryEvent : public MetaEvent {
+    struct Row {
+        std::string flow_name;
+        bool passed;
+        std::chrono::milliseconds duration;
+        metrics::Usage usage;
+    };
+
+    UsageSummaryEvent(std::vector<Row> rows)
+        : MetaEvent{}
+        , rows{ std::move(rows) } { }
+    std::vector<Row> rows;
+};
+
 class AnyEvent {
 public:
     template <typename T, typename Renderer>
@@ -0,0 +1,80 @@
+#include <reporting/event_json.hpp>
+#include <reporting/json_lines_renderer.hpp>
+
+#include <chrono>
+#include <stdexcept>
+
+JsonLinesRenderer::JsonLinesRenderer(std::string const &path) {
+    if(path.empty())
+        return;
+
+    out_ = std::fopen(path.c_str(), "w");
+    if(out_ == nullptr)
+        throw std::runtime_error("Could not open " + path + " for writing");
+}
+
+JsonLinesRenderer::~JsonLinesRenderer() {
+    if(out_ != nullptr)
+        std::fclose(out_);
+}
+
+void JsonLinesRenderer::operator()(SimpleEvent const &ev) const {
+    write(ev, event_json::to_json(ev));
+}
+
+void JsonLinesRenderer::operator()(SuccessEvent const &ev) const {
+    write(ev, event_json::to_json(ev));
+}
+
+void JsonLinesRenderer::operator()(FailureEvent const &ev) const {
+    write(ev, event_json::to_json(ev));
+}
+
+void JsonLinesRenderer::operator()(RequestEvent const &ev) const {
+    write(ev, event_json::to_json(ev));
+}
+
+void JsonLinesRenderer::operator()(ResponseEvent const &ev) const {
+    write(ev, event_json::to_json(ev));
+}
+
+void JsonLinesRenderer::operator()(LatencyEvent const &ev) const {
+    write(ev, event_json::to_json(ev));
+}
+
+void JsonLinesRenderer::operator()(LatencySummaryEvent const &ev) const {
+    write(ev, event_json::to_json(ev));
+}
+
+void JsonLinesRenderer::operator()(UsageSummaryEvent const &ev) const {
+    write(ev, event_json::to_json(ev));
+}
+
+void JsonLinesRenderer::flush() const {
+    if(out_ == nullptr)
+        return;
+
+    std::scoped_lock l{ mtx_ };
+    std::fflush(out_);
+}
+
+void JsonLinesRenderer::write_line(inja::json const &data) const {
+    if(out_ == nullptr)
+        return;
+
+    // invalid utf-8 in responses is replaced rather than failing the whole run
+    auto line = data.dump(-1, ' ', false, inja::json::error_handler_t::replace);
+    line += '\n';
+
+    std::scoped_lock l{ mtx_ };
+    std::fwrite(line.data(), 1, line.size(), out_);
+}
+
+void JsonLinesRenderer::write(MetaEvent const &meta, inja::json &&data) const {
+    if(out_ == nullptr)
+        return;
+
+    auto const time = std::chrono::duration_cast<std::chrono::milliseconds>(meta.time.time_since_epoch());
+    data["time_ms"] = time.count();
+    write_line(data);
+}
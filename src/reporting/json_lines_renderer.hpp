@@ -0,0 +1,51 @@
+#pragma once
+
+#include <reporting/events.hpp>
+
+#include <inja/inja.hpp>
+
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <type_traits>
+
+/**
+ * @brief Renders every event as one line of JSON
+ *
+ * Lines are written as they are rendered and flushed whenever the report engine flushes,
+ * so the file can be tailed while the run is in progress. Does nothing if constructed without a path.
+ */
+struct JsonLinesRenderer {
+    explicit JsonLinesRenderer(std::string const &path = "");
+    ~JsonLinesRenderer();
+
+    JsonLinesRenderer(JsonLinesRenderer const &)            = delete;
+    JsonLinesRenderer &operator=(JsonLinesRenderer const &) = delete;
+
+    void operator()(SimpleEvent const &ev) const;
+    void operator()(SuccessEvent const &ev) const;
+    void operator()(FailureEvent const &ev) const;
+    void operator()(RequestEvent const &ev) const;
+    void operator()(ResponseEvent const &ev) const;
+    void operator()(LatencyEvent const &ev) const;
+    void operator()(LatencySummaryEvent const &ev) const;
+    void operator()(UsageSummaryEvent const &ev) const;
+
+    template <typename EventType>
+    bool wants(std::type_identity<EventType>) const {
+        return out_ != nullptr;
+    }
+
+    void flush() const;
+
+    /**
+     * @brief Writes an event that was already rendered, e.g. one read back from another file
+     */
+    void write_line(inja::json const &line) const;
+
+private:
+    void write(MetaEvent const &meta, inja::json &&data) const;
+
+    std::FILE *out_ = nullptr;
+    mutable std::mutex mtx_;
+};
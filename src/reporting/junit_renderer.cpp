@@ -0,0 +1,109 @@
+#include <reporting/junit_renderer.hpp>
+
+#include <fmt/format.h>
+
+#include <cstdio>
+#include <iterator>
+
+namespace {
+std::string escaped(std::string_view value) {
+    std::string result;
+    result.reserve(value.size());
+    for(auto c : value) {
+        switch(c) {
+        case '&':
+            result += "&amp;";
+            break;
+        case '<':
+            result += "&lt;";
+            break;
+        case '>':
+            result += "&gt;";
+            break;
+        case '"':
+            result += "&quot;";
+            break;
+        default:
+            // control characters other than whitespace are not allowed in xml 1.0
+            if(static_cast<unsigned char>(c) >= 0x20 or c == '\n' or c == '\t' or c == '\r')
+                result += c;
+        }
+    }
+    return result;
+}
+
+double seconds(std::chrono::milliseconds d) {
+    return d.count() / 1000.0;
+}
+} // namespace
+
+JUnitRenderer::JUnitRenderer(std::string const &path)
+    : path_{ path } {
+}
+
+JUnitRenderer::~JUnitRenderer() {
+    if(path_.empty())
+        return;
+
+    auto const xml = render();
+    if(auto *file = std::fopen(path_.c_str(), "w"); file != nullptr) {
+        std::fwrite(xml.data(), 1, xml.size(), file);
+        std::fclose(file);
+    } else {
+        fmt::print("Could not write JUnit report to {}\n", path_);
+    }
+}
+
+void JUnitRenderer::operator()(SuccessEvent const &ev) const {
+    if(path_.empty())
+        return;
+
+    std::scoped_lock l{ mtx_ };
+    cases_.push_back({ ev.flow_name, ev.duration, false, {}, {} });
+}
+
+void JUnitRenderer::operator()(FailureEvent const &ev) const {
+    if(path_.empty())
+        return;
+
+    std::string detail;
+    auto out = std::back_inserter(detail);
+    for(auto const &issue : ev.issues) {
+        fmt::format_to(out, "{}: {}\n", issue.path, issue.message);
+        if(not issue.detail.empty())
+            fmt::format_to(out, "{}\n", issue.detail);
+    }
+    fmt::format_to(out, "\nLive response:\n{}\n", ev.response);
+
+    auto message = ev.issues.empty() ? std::string{ "Flow failed" } : ev.issues.front().message;
+
+    std::scoped_lock l{ mtx_ };
+    cases_.push_back({ ev.flow_name, ev.duration, true, std::move(message), std::move(detail) });
+}
+
+std::string JUnitRenderer::render() const {
+    std::scoped_lock l{ mtx_ };
+
+    auto failures = std::size_t{ 0 };
+    auto total    = std::chrono::milliseconds{};
+    for(auto const &test : cases_) {
+        failures += test.failed;
+        total += test.duration;
+    }
+
+    std::string xml;
+    auto out = std::back_inserter(xml);
+    fmt::format_to(out, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    fmt::format_to(out, "<testsuites tests=\"{0}\" failures=\"{1}\" time=\"{2:.3f}\">\n", cases_.size(), failures, seconds(total));
+    fmt::format_to(out, "  <testsuite name=\"cliot\" tests=\"{0}\" failures=\"{1}\" errors=\"0\" skipped=\"0\" time=\"{2:.3f}\">\n", cases_.size(), failures, seconds(total));
+    for(auto const &test : cases_) {
+        fmt::format_to(out, "    <testcase classname=\"cliot\" name=\"{}\" time=\"{:.3f}\"", escaped(test.name), seconds(test.duration));
+        if(not test.failed) {
+            fmt::format_to(out, "/>\n");
+            continue;
+        }
+        fmt::format_to(out, ">\n      <failure message=\"{}\">{}</failure>\n    </testcase>\n", escaped(test.message), escaped(test.detail));
+    }
+    fmt::format_to(out, "  </testsuite>\n</testsuites>\n");
+    return xml;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <reporting/events.hpp>
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Collects flow results and writes them as a JUnit XML report
+ *
+ * Only flow results are of interest; everything else is ignored by the report engine as
+ * there is no overload for it. The report is written out when the renderer is destroyed.
+ * Does nothing if constructed without a path.
+ */
+struct JUnitRenderer {
+    explicit JUnitRenderer(std::string const &path = "");
+    ~JUnitRenderer();
+
+    JUnitRenderer(JUnitRenderer const &)            = delete;
+    JUnitRenderer &operator=(JUnitRenderer const &) = delete;
+
+    void operator()(SuccessEvent const &ev) const;
+    void operator()(FailureEvent const &ev) const;
+
+    void flush() const { }
+
+    /**
+     * @brief Renders all results collected so far as a JUnit XML document
+     */
+    std::string render() const;
+
+private:
+    struct TestCase {
+        std::string name;
+        std::chrono::milliseconds duration;
+        bool failed;
+        std::string message;
+        std::string detail;
+    };
+
+    std::string path_;
+    mutable std::mutex mtx_;
+    mutable std::vector<TestCase> cases_;
+};
@@ -0,0 +1,104 @@
+#include <reporting/latency_stats.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace {
+auto const slower = [](LatencyEvent const &a, LatencyEvent const &b) {
+    return a.total > b.total;
+};
+} // namespace
+
+LatencyStats::LatencyStats(std::size_t max_slowest)
+    : max_slowest_{ max_slowest } {
+}
+
+void LatencyStats::record(LatencyEvent const &ev) {
+    auto lock = std::scoped_lock{ mtx_ };
+    ++count_;
+
+    by_flow_[ev.flow].record(ev.total);
+    by_template_[ev.path].record(ev.total);
+    by_method_[ev.method.empty() ? "<none>" : ev.method].record(ev.total);
+
+    if(max_slowest_ == 0)
+        return;
+
+    if(slowest_.size() < max_slowest_) {
+        slowest_.push_back(ev);
+        std::push_heap(std::begin(slowest_), std::end(slowest_), slower);
+    } else if(ev.total > slowest_.front().total) {
+        std::pop_heap(std::begin(slowest_), std::end(slowest_), slower);
+        slowest_.back() = ev;
+        std::push_heap(std::begin(slowest_), std::end(slowest_), slower);
+    }
+}
+
+LatencySummaryEvent LatencyStats::summarize() const {
+    auto lock    = std::scoped_lock{ mtx_ };
+    auto slowest = slowest_;
+    std::sort_heap(std::begin(slowest), std::end(slowest), slower); // slowest first
+
+    return LatencySummaryEvent{ rows_of(by_flow_), rows_of(by_template_), rows_of(by_method_), slowest };
+}
+
+std::size_t LatencyStats::size() const {
+    auto lock = std::scoped_lock{ mtx_ };
+    return count_;
+}
+
+std::vector<LatencySummaryEvent::Row> LatencyStats::rows_of(samples_t const &samples) {
+    std::vector<LatencySummaryEvent::Row> rows;
+    rows.reserve(samples.size());
+
+    for(auto const &[key, histogram] : samples)
+        rows.push_back({ key, histogram.count(), histogram.percentile(50), histogram.percentile(90), histogram.percentile(99), histogram.max() });
+
+    // worst p99 first
+    std::stable_sort(std::begin(rows), std::end(rows), [](auto const &a, auto const &b) {
+        return a.p99 > b.p99;
+    });
+    return rows;
+}
+
+void LatencyStats::Histogram::record(duration_t duration) {
+    duration = std::max(duration, duration_t{ 0 });
+
+    auto const bucket = bucket_of(static_cast<std::uint64_t>(duration.count()));
+    if(bucket >= buckets_.size())
+        buckets_.resize(bucket + 1);
+    ++buckets_[bucket];
+    ++count_;
+    max_ = std::max(max_, duration);
+}
+
+LatencyStats::duration_t LatencyStats::Histogram::percentile(double percentile) const {
+    auto const rank = std::clamp<std::size_t>(static_cast<std::size_t>(std::ceil(percentile / 100.0 * count_)), 1, count_);
+
+    auto seen = std::uint64_t{ 0 };
+    for(auto bucket = std::size_t{ 0 }; bucket < buckets_.size(); ++bucket) {
+        seen += buckets_[bucket];
+        if(seen >= rank)
+            return std::min(duration_t{ static_cast<duration_t::rep>(highest_in(bucket)) }, max_);
+    }
+    return max_;
+}
+
+std::size_t LatencyStats::Histogram::bucket_of(std::uint64_t micros) {
+    if(micros < sub_buckets)
+        return micros;
+
+    // the top sub_bucket_bits + 1 bits pick the bucket, the ones below are dropped
+    auto const shift = static_cast<unsigned>(std::bit_width(micros)) - sub_bucket_bits - 1;
+    return (shift + 1) * sub_buckets + ((micros >> shift) - sub_buckets);
+}
+
+std::uint64_t LatencyStats::Histogram::highest_in(std::size_t bucket) {
+    if(bucket < sub_buckets)
+        return bucket;
+
+    auto const shift = bucket / sub_buckets - 1;
+    auto const top   = bucket % sub_buckets + sub_buckets;
+    return ((top + 1) << shift) - 1;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <reporting/events.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Collects request/response latencies over the whole run and summarizes them
+ *
+ * Safe to record into from multiple threads. Memory does not grow with the number of
+ * exchanges: every key keeps a histogram rather than its samples.
+ */
+class LatencyStats {
+public:
+    using duration_t = LatencyEvent::duration_t;
+
+    /**
+     * @brief Log-linear histogram of durations in microseconds
+     *
+     * Every power of two is split into sub_buckets equal buckets, so durations below 2 * sub_buckets
+     * microseconds are exact and larger ones are off by less than 1/sub_buckets. Count and max are exact.
+     */
+    class Histogram {
+        std::vector<std::uint64_t> buckets_; // grown up to the highest bucket used, at most a couple thousand
+        std::size_t count_ = 0;
+        duration_t max_    = {};
+
+    public:
+        static constexpr auto sub_bucket_bits = 5u;
+        static constexpr auto sub_buckets     = std::size_t{ 1 } << sub_bucket_bits;
+
+        void record(duration_t duration);
+
+        /**
+         * @brief Nearest-rank percentile, reported as the highest duration of its bucket but never above max
+         *
+         * @param percentile In the range (0, 100]; must not be called on an empty histogram
+         */
+        duration_t percentile(double percentile) const;
+
+        std::size_t count() const { return count_; }
+        duration_t max() const { return max_; }
+
+        static std::size_t bucket_of(std::uint64_t micros);
+        static std::uint64_t highest_in(std::size_t bucket);
+    };
+
+private:
+    using samples_t = std::map<std::string, Histogram>;
+
+    mutable std::mutex mtx_;
+    samples_t by_flow_;
+    samples_t by_template_;
+    samples_t by_method_;
+    std::vector<LatencyEvent> slowest_; // min-heap on total, bounded by max_slowest_
+    std::size_t max_slowest_;
+    std::size_t count_ = 0;
+
+public:
+    /**
+     * @param max_slowest How many of the slowest exchanges to keep for the summary
+     */
+    explicit LatencyStats(std::size_t max_slowest = 10);
+
+    void record(LatencyEvent const &ev);
+
+    /**
+     * @brief Percentiles per flow, per request template and per method plus the slowest exchanges
+     *
+     * @return LatencySummaryEvent
+     */
+    LatencySummaryEvent summarize() const;
+
+    std::size_t size() const;
+
+private:
+    static std::vector<LatencySummaryEvent::Row> rows_of(samples_t const &samples);
+};
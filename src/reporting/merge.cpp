@@ -0,0 +1,77 @@
+#include <reporting/event_json.hpp>
+#include <reporting/json_lines_renderer.hpp>
+#include <reporting/latency_stats.hpp>
+#include <reporting/merge.hpp>
+
+#include <fmt/format.h>
+#include <inja/inja.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+MergeSummary merge_json_lines(std::vector<std::filesystem::path> const &inputs, std::filesystem::path const &output) {
+    auto events     = std::vector<inja::json>{};
+    auto usage_rows = inja::json::array();
+    auto latency    = LatencyStats{};
+    auto summary    = MergeSummary{};
+
+    for(auto shard = std::size_t{ 0 }; shard < inputs.size(); ++shard) {
+        auto in = std::ifstream{ inputs[shard] };
+        if(not in)
+            throw std::runtime_error(fmt::format("Could not open {}", inputs[shard].string()));
+
+        auto number = std::size_t{ 0 };
+        for(auto text = std::string{}; std::getline(in, text); ++number) {
+            if(text.empty())
+                continue;
+
+            auto line = inja::json{};
+            try {
+                line = inja::json::parse(text);
+            } catch(inja::json::exception const &e) {
+                throw std::runtime_error(fmt::format("{}:{}: {}", inputs[shard].string(), number + 1, e.what()));
+            }
+
+            auto const type = line.value("event", "");
+            if(type == "usage_summary") {
+                for(auto &row : line.at("flows"))
+                    usage_rows.push_back(std::move(row));
+                continue;
+            }
+            if(type == "latency_summary")
+                continue;
+
+            if(type == "latency")
+                latency.record(event_json::to_latency(line));
+            else if(type == "success")
+                ++summary.passed;
+            else if(type == "failure")
+                ++summary.failed;
+
+            line["shard"] = shard + 1;
+            events.push_back(std::move(line));
+        }
+    }
+
+    std::stable_sort(std::begin(events), std::end(events), [](auto const &a, auto const &b) {
+        return a.value("time_ms", std::int64_t{ 0 }) < b.value("time_ms", std::int64_t{ 0 });
+    });
+
+    auto const out = JsonLinesRenderer{ output.string() };
+    for(auto const &event : events)
+        out.write_line(event);
+
+    if(not usage_rows.empty()) {
+        std::sort(std::begin(usage_rows), std::end(usage_rows), [](auto const &a, auto const &b) {
+            return a.at("flow") < b.at("flow");
+        });
+        auto const time = events.empty() ? std::int64_t{ 0 } : events.back().value("time_ms", std::int64_t{ 0 });
+        out.write_line({ { "event", "usage_summary" }, { "time_ms", time }, { "flows", std::move(usage_rows) } });
+    }
+    if(latency.size() > 0)
+        out(latency.summarize());
+    return summary;
+}
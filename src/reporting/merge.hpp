@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+struct MergeSummary {
+    std::size_t passed = 0;
+    std::size_t failed = 0;
+};
+
+/**
+ * @brief Combines the JSON Lines output of several shards into one file
+ *
+ * Events are interleaved by time and tagged with the 1-based number of the input they came
+ * from. The per-shard latency and usage summaries are replaced by ones covering all shards;
+ * latency percentiles are computed again from the individual exchanges.
+ *
+ * @param inputs JSON Lines files written with --jsonl, one per shard
+ * @param output Where to write the merged file
+ */
+MergeSummary merge_json_lines(std::vector<std::filesystem::path> const &inputs, std::filesystem::path const &output);
@@ -0,0 +1,34 @@
+#include <isolation/fork_server.hpp>
+#include <reporting/event_json.hpp>
+#include <reporting/pipe_renderer.hpp>
+
+namespace {
+void forward(isolation::FrameWriter *out, inja::json const &event) {
+    if(out != nullptr)
+        out->write(inja::json::to_msgpack(event));
+}
+} // namespace
+
+void PipeRenderer::operator()(SimpleEvent const &ev) const {
+    forward(out_, event_json::to_json(ev));
+}
+
+void PipeRenderer::operator()(SuccessEvent const &ev) const {
+    forward(out_, event_json::to_json(ev));
+}
+
+void PipeRenderer::operator()(FailureEvent const &ev) const {
+    forward(out_, event_json::to_json(ev));
+}
+
+void PipeRenderer::operator()(RequestEvent const &ev) const {
+    forward(out_, event_json::to_json(ev));
+}
+
+void PipeRenderer::operator()(ResponseEvent const &ev) const {
+    forward(out_, event_json::to_json(ev));
+}
+
+void PipeRenderer::operator()(LatencyEvent const &ev) const {
+    forward(out_, event_json::to_json(ev));
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <reporting/events.hpp>
+
+#include <type_traits>
+
+namespace isolation {
+class FrameWriter;
+}
+
+/**
+ * @brief Sends the events of an isolated flow process to the parent, one MessagePack frame each
+ *
+ * Does nothing if constructed without a writer.
+ */
+struct PipeRenderer {
+    explicit PipeRenderer(isolation::FrameWriter *out = nullptr)
+        : out_{ out } { }
+
+    void operator()(SimpleEvent const &ev) const;
+    void operator()(SuccessEvent const &ev) const;
+    void operator()(FailureEvent const &ev) const;
+    void operator()(RequestEvent const &ev) const;
+    void operator()(ResponseEvent const &ev) const;
+    void operator()(LatencyEvent const &ev) const;
+
+    template <typename EventType>
+    bool wants(std::type_identity<EventType>) const {
+        return out_ != nullptr;
+    }
+
+    void flush() const { }
+
+private:
+    isolation::FrameWriter *out_;
+};
@@ -0,0 +1,22 @@
+#include <distributed/channel.hpp>
+#include <reporting/event_json.hpp>
+#include <reporting/remote_renderer.hpp>
+
+namespace {
+void forward(distributed::Channel *channel, inja::json &&event) {
+    if(channel != nullptr)
+        channel->send({ { "type", "event" }, { "event", std::move(event) } });
+}
+} // namespace
+
+void RemoteRenderer::operator()(SuccessEvent const &ev) const {
+    forward(channel_, event_json::to_json(ev));
+}
+
+void RemoteRenderer::operator()(FailureEvent const &ev) const {
+    forward(channel_, event_json::to_json(ev));
+}
+
+void RemoteRenderer::operator()(LatencyEvent const &ev) const {
+    forward(channel_, event_json::to_json(ev));
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <reporting/events.hpp>
+
+namespace distributed {
+class Channel;
+}
+
+/**
+ * @brief Forwards flow results and latencies of a worker to its coordinator
+ *
+ * Does nothing if constructed without a channel.
+ */
+struct RemoteRenderer {
+    explicit RemoteRenderer(distributed::Channel *channel = nullptr)
+        : channel_{ channel } { }
+
+    void operator()(SuccessEvent const &ev) const;
+    void operator()(FailureEvent const &ev) const;
+    void operator()(LatencyEvent const &ev) const;
+
+    void flush() const { }
+
+private:
+    distributed::Channel *channel_;
+};
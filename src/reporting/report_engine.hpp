@@ -3,23 +3,189 @@
 #include <di.hpp>
 
 #include <reporting/events.hpp>
+#include <reporting/latency_stats.hpp>
+#include <util/ring_buffer.hpp>
 
-template <typename RendererType>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+/**
+ * @brief What to do with an event when the asynchronous queue is full
+ */
+enum class ReportOverflow {
+    BLOCK, // wait for the renderer to catch up
+    DROP   // drop the event; the number of dropped events is reported at the end
+};
+
+/**
+ * @brief Delivers every recorded event to all renderers
+ *
+ * A renderer only receives the event types it has an overload for.
+ */
+template <typename... RendererTypes>
 class ReportEngine {
-    using services_t = di::Deps<RendererType>;
+    using services_t = di::Deps<RendererTypes...>;
+
+    static constexpr int spins = 64; // attempts of a blocked record before it parks
+
+    // what AnyEvent renders with; fans the event out to every renderer
+    struct Dispatch {
+        ReportEngine const &engine;
+
+        template <typename EventType>
+        void operator()(EventType const &ev) const {
+            (engine.template render_with<RendererTypes>(ev), ...);
+        }
+    };
 
     services_t services_;
     bool sync_output_;
+    ReportOverflow overflow_;
+
+    util::RingBuffer<AnyEvent> queue_;
+    std::atomic<std::uint64_t> produced_ = 0; // bumped on every enqueue, the renderer thread waits on it
+    std::atomic<std::uint32_t> consumed_ = 0; // bumped on every render, blocked producers wait on it
+    std::atomic<std::uint64_t> dropped_  = 0;
+    std::atomic_bool stop_requested_     = false;
+    std::thread worker_;
+    Dispatch dispatch_{ *this };
+
+    LatencyStats latency_;
 
 public:
-    ReportEngine(services_t services, bool sync_output)
+    /**
+     * @param services
+     * @param sync_output Render on the calling thread if true, on a background thread otherwise
+     * @param queue_size Capacity of the queue used in asynchronous mode
+     * @param overflow What to do when the queue is full
+     */
+    ReportEngine(services_t services, bool sync_output, std::size_t queue_size = 4096, ReportOverflow overflow = ReportOverflow::BLOCK)
         : services_{ services }
-        , sync_output_{ sync_output } {
+        , sync_output_{ sync_output }
+        , overflow_{ overflow }
+        , queue_{ sync_output ? 1 : queue_size } {
+        if(not sync_output_)
+            worker_ = std::thread{ [this] { worker_loop(); } };
     }
 
+    ~ReportEngine() {
+        if(worker_.joinable()) {
+            stop_requested_ = true;
+            ++produced_;
+            produced_.notify_one();
+            worker_.join();
+        }
+
+        if(auto dropped = dropped_.load(); dropped > 0)
+            dispatch_(SimpleEvent{ "DROPPED", std::to_string(dropped) + " events due to full report queue" });
+        flush();
+    }
+
+    ReportEngine(ReportEngine const &)            = delete;
+    ReportEngine &operator=(ReportEngine const &) = delete;
+
     template <typename EventType>
     void record(EventType &&ev) {
-        if(sync_output_)
-            services_.template get<RendererType>().get()(ev);
+        if constexpr(std::is_same_v<std::decay_t<EventType>, LatencyEvent>)
+            latency_.record(ev);
+
+        if(sync_output_) {
+            dispatch_(ev);
+            flush();
+            return;
+        }
+
+        auto event = AnyEvent{ std::decay_t<EventType>(std::forward<EventType>(ev)), dispatch_ };
+        for(auto attempt = 0;; ++attempt) {
+            auto const seen = consumed_.load();
+            if(queue_.try_push(event))
+                break;
+
+            if(overflow_ == ReportOverflow::DROP) {
+                ++dropped_;
+                return;
+            }
+            if(attempt < spins)
+                std::this_thread::yield();
+            else
+                consumed_.wait(seen);
+        }
+
+        ++produced_;
+        produced_.notify_one();
+    }
+
+    /**
+     * @brief Whether any renderer does something with events of this type
+     *
+     * Lets callers skip building events that are expensive to produce. A renderer can opt out
+     * with a `bool wants(std::type_identity<EventType>) const`; one without it is assumed to
+     * want every event it has an overload for.
+     */
+    template <typename EventType>
+    [[nodiscard]] bool wants() const {
+        return (wanted_by<RendererTypes, EventType>() or ...);
+    }
+
+    /**
+     * @brief Records the summary of all latencies collected so far; does nothing if there are none
+     */
+    void summarize() {
+        if(latency_.size() > 0)
+            record(latency_.summarize());
+    }
+
+private:
+    template <typename RendererType>
+    RendererType const &renderer() const {
+        return services_.template get<RendererType>().get();
+    }
+
+    template <typename RendererType, typename EventType>
+    bool wanted_by() const {
+        if constexpr(not std::is_invocable_v<RendererType const &, EventType const &>)
+            return false;
+        else if constexpr(requires(RendererType const &r) { r.wants(std::type_identity<EventType>{}); })
+            return renderer<RendererType>().wants(std::type_identity<EventType>{});
+        else
+            return true;
+    }
+
+    template <typename RendererType, typename EventType>
+    void render_with(EventType const &ev) const {
+        if constexpr(std::is_invocable_v<RendererType const &, EventType const &>)
+            renderer<RendererType>()(ev);
+    }
+
+    void flush() const {
+        (renderer<RendererTypes>().flush(), ...);
+    }
+
+    // renders everything that is queued, then flushes the whole batch at once
+    void worker_loop() {
+        auto const render = [this](AnyEvent &&ev) {
+            ev.render();
+            ++consumed_;
+            consumed_.notify_one(); // every render frees one slot for one blocked producer
+        };
+
+        std::uint64_t seen = 0;
+        for(;;) {
+            produced_.wait(seen);
+            seen = produced_.load();
+
+            while(queue_.pop_with(render)) { }
+            flush();
+
+            if(stop_requested_) {
+                while(queue_.pop_with(render)) { }
+                flush();
+                return;
+            }
+        }
     }
 };
@@ -5,6 +5,8 @@
 #include <fmt/compile.h>
 #include <inja/inja.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
 #include <iostream>
 #include <sstream>
@@ -12,10 +14,15 @@
 #include <string_view>
 #include <vector>
 
+#include <bundle/bundle.hpp>
 #include <flow/flow.hpp>
+#include <flow/timeouts.hpp>
+#include <metrics/registry.hpp>
 #include <reporting/events.hpp>
 #include <reporting/report_engine.hpp>
+#include <util/json_query.hpp>
 #include <util/overloaded.hpp>
+#include <web/concepts.hpp>
 
 template <typename FlowFactoryType>
 class FlowRunner {
@@ -42,15 +49,24 @@ public:
         , path_{ path } { }
 
     void run() {
+        run_detached();
+    }
+
+    /**
+     * @brief Runs the flow on a brand new environment
+     *
+     * @return store_t The store as it was left by the flow
+     */
+    store_t run_detached() {
         env_t env;
         store_t store;
 
-        auto env_json_path = (std::filesystem::path{ path_ } / "env.json").string();
-        if(std::filesystem::exists(env_json_path))
-            store = env.load_json(env_json_path);
+        if(auto env_json = bundle::load_json(std::filesystem::path{ path_ } / "env.json"))
+            store = std::move(*env_json);
 
         register_extensions(env, store);
         run(env, store);
+        return store;
     }
 
     void run(env_t &env, store_t &store) {
@@ -62,23 +78,43 @@ public:
 
     void run(env_t &env, store_t &store, auto const &flow) {
         report("RUNNING", name_);
+        using request_step_t = typename flow_t::request_step_t;
         auto connection_link = link_ptr_t{};
+        auto last_request    = static_cast<request_step_t const *>(nullptr);
+        auto request_timeout = std::chrono::milliseconds{};
+        auto deadline        = Timeouts::Scope{ fmt::format("Flow {}", path_), flow.timeout() };
 
         for(auto steps = flow.steps(); auto &step : steps) {
+            if(auto const expired = Timeouts::expired())
+                throw FlowException(path_, { { FailureEvent::Data::Type::TIMEOUT, path_, *expired } }, "No data");
+
             // clang-format off
             std::visit( overloaded {
-                [&connection_link](typename flow_t::request_step_t& req) mutable {
+                [&connection_link, &last_request, &request_timeout](typename flow_t::request_step_t& req) mutable {
                     connection_link = req.perform(); // round robin ws on each new request
+                    last_request    = &req;
+                    request_timeout = req.timeout();
                 },
-                [&connection_link](typename flow_t::response_step_t& resp) {
+                [this, &connection_link, &last_request, &request_timeout](typename flow_t::response_step_t& resp) {
                     if(not connection_link)
                         throw std::logic_error{ "Response can't come before Request step" };
-                    resp.validate(inja::json::parse(connection_link->read_one()));
+                    auto response = read(*connection_link, resp, request_timeout);
+                    if(last_request) {
+                        // only the first response after a request is timed, the rest are subscription updates
+                        report_latency(*last_request, *connection_link);
+                        last_request = nullptr;
+                    }
+                    resp.validate(response);
                 },
-                [](typename flow_t::run_flow_step_t& subflow) {
+                [&connection_link, &last_request](typename flow_t::run_flow_step_t& subflow) {
+                    // the subflow borrows connections of its own; holding on to ours could starve the pool
+                    connection_link = link_ptr_t{};
+                    last_request    = nullptr;
                     subflow.run();
                 },
-                [](typename flow_t::repeat_block_step_t& block) {
+                [&connection_link, &last_request](typename flow_t::repeat_block_step_t& block) {
+                    connection_link = link_ptr_t{};
+                    last_request    = nullptr;
                     block.run();
                 }},
             step);
@@ -87,6 +123,18 @@ public:
     }
 
 private:
+    auto read(auto &link, auto const &resp, std::chrono::milliseconds request_timeout) {
+        auto const timeout = resp.timeout().count() > 0 ? resp.timeout() : request_timeout;
+        auto const budget  = Timeouts::budget(resp.path(), timeout);
+        try {
+            return link.read_one(budget.wait);
+        } catch(ReadTimeout const &) {
+            throw FlowException(resp.path(), { { FailureEvent::Data::Type::TIMEOUT, resp.path(), budget.reason } }, "No data");
+        } catch(ConnectionError const &e) {
+            throw FlowException(resp.path(), { { FailureEvent::Data::Type::LOGIC_ERROR, resp.path(), e.what() } }, "No data");
+        }
+    }
+
     void
     report(std::string const &label, std::string const &message) {
         auto const &reporting = services_.template get<reporting_t>();
@@ -98,6 +146,24 @@ private:
         reporting.get().record(std::move(ev));
     }
 
+    void report_latency(auto const &req, auto const &link) {
+        if constexpr(requires { link.timing(); }) {
+            using namespace std::chrono;
+            auto const timing = link.timing();
+            auto const since  = [&timing](auto tp) {
+                return duration_cast<LatencyEvent::duration_t>(std::max(tp, timing.write_started) - timing.write_started);
+            };
+
+            auto &registry = metrics::Registry::instance();
+            registry.response(req.method());
+            registry.latency.observe(since(timing.frame_done));
+
+            report(LatencyEvent{ path_, req.path(), req.method(),
+                since(timing.write_done), since(timing.first_byte), since(timing.frame_done),
+                timing.bytes_sent, timing.bytes_received });
+        }
+    }
+
     void register_extensions(env_t &env, store_t &store) {
         auto store_and_return_cb = [&store](inja::Arguments &args) {
             auto value = args.at(0)->get<inja::json>();
@@ -116,17 +182,14 @@ private:
         env.add_void_callback("store", 2, store_cb);
 
         auto combine_cb = [](inja::Arguments &args) {
-            auto value1 = args.at(0)->get<inja::json>();
-            auto value2 = args.at(1)->get<inja::json>();
-            value1.insert(value1.end(), value2.begin(), value2.end());
-            return value1;
+            auto value = *args.at(0);
+            value.insert(value.end(), args.at(1)->begin(), args.at(1)->end());
+            return value;
         };
         env.add_callback("combine", 2, combine_cb);
 
         auto equal_cb = [](inja::Arguments &args) {
-            auto value1 = args.at(0)->get<inja::json>();
-            auto value2 = args.at(1)->get<inja::json>();
-            return value1 == value2;
+            return *args.at(0) == *args.at(1);
         };
         env.add_callback("equal", 2, equal_cb);
 
@@ -136,6 +199,8 @@ private:
         };
         env.add_callback("load", 1, load_cb);
 
+        register_query_extensions(env, store);
+
         auto assert_cb = [](inja::Arguments &args) {
             auto const value = args.at(0)->get<bool>();
             auto const msg   = args.at(1)->get<std::string>();
@@ -177,4 +242,55 @@ private:
         };
         env.add_void_callback("fetch_json", 2, http_fetch_json_cb);
     }
+
+    // all of these work on the arguments by reference and only copy what they return
+    void register_query_extensions(env_t &env, store_t &store) {
+        auto query_store_cb = [&store](inja::Arguments &args) -> inja::json {
+            auto found = util::json_query::find(store, args.at(0)->get_ref<std::string const &>());
+            return found ? *found : inja::json{};
+        };
+        env.add_callback("query", 1, query_store_cb);
+
+        auto query_cb = [](inja::Arguments &args) -> inja::json {
+            auto found = util::json_query::find(*args.at(0), args.at(1)->get_ref<std::string const &>());
+            return found ? *found : inja::json{};
+        };
+        env.add_callback("query", 2, query_cb);
+
+        auto length_cb = [](inja::Arguments &args) -> inja::json {
+            auto found = util::json_query::find(*args.at(0), args.at(1)->get_ref<std::string const &>());
+            return found ? util::json_query::length(*found) : 0u;
+        };
+        env.add_callback("length", 2, length_cb);
+
+        auto slice_cb = [](inja::Arguments &args) {
+            return util::json_query::slice(*args.at(0), args.at(1)->get<std::int64_t>(), args.at(2)->get<std::int64_t>());
+        };
+        env.add_callback("slice", 3, slice_cb);
+
+        auto pluck_cb = [](inja::Arguments &args) {
+            return util::json_query::pluck(*args.at(0), args.at(1)->get_ref<std::string const &>());
+        };
+        env.add_callback("pluck", 2, pluck_cb);
+
+        auto find_by_cb = [](inja::Arguments &args) {
+            return util::json_query::find_by(*args.at(0), args.at(1)->get_ref<std::string const &>(), *args.at(2));
+        };
+        env.add_callback("find_by", 3, find_by_cb);
+
+        auto sum_cb = [](inja::Arguments &args) {
+            return util::json_query::sum(*args.at(0));
+        };
+        env.add_callback("sum", 1, sum_cb);
+
+        auto sum_by_cb = [](inja::Arguments &args) {
+            return util::json_query::sum(*args.at(0), args.at(1)->get_ref<std::string const &>());
+        };
+        env.add_callback("sum", 2, sum_by_cb);
+
+        auto sort_by_cb = [](inja::Arguments &args) {
+            return util::json_query::sort_by(*args.at(0), args.at(1)->get_ref<std::string const &>());
+        };
+        env.add_callback("sort_by", 2, sort_by_cb);
+    }
 };
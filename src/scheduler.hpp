@@ -1,17 +1,33 @@
 #pragma once
 
 #include <crawler.hpp>
+#include <flow/duration_history.hpp>
+#include <flow/incremental_run.hpp>
+#include <flow/sharding.hpp>
+#include <isolation/fork_server.hpp>
+#include <metrics/registry.hpp>
+#include <metrics/usage.hpp>
+#include <reporting/event_json.hpp>
 #include <reporting/report_engine.hpp>
 #include <runner.hpp>
+#include <trace/tracer.hpp>
 
 #include <di.hpp>
 #include <fmt/color.h>
 #include <fmt/compile.h>
 #include <inja/inja.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <filesystem>
+#include <future>
 #include <iostream>
+#include <iterator>
+#include <optional>
 #include <sstream>
+#include <stdexcept>
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -27,27 +43,211 @@ class Scheduler {
     using flow_runner_t = FlowRunner<flow_factory_t>;
 
 public:
-    Scheduler(services_t services)
-        : services_{ services } { }
+    struct Options {
+        IncrementalRun *incremental      = nullptr; // only run flows that changed or did not pass last time
+        DurationHistory *durations       = nullptr; // start the longest flows first and learn from this run
+        std::size_t jobs                 = 1;       // flows run concurrently
+        std::optional<Shard> shard;                 // only run this part of the suite
+        isolation::ForkServer *isolation = nullptr; // run every flow in its own process
+        std::chrono::milliseconds flow_timeout{};   // kill isolated flows running longer than this; zero for no limit
+    };
+
+    Scheduler(services_t services, Options options = {})
+        : services_{ services }
+        , options_{ options } { }
 
     int run() {
         auto const &reporting = services_.template get<reporting_t>();
         auto flow_dirs        = services_.template get<crawler_t>().get().crawl();
+
+        if(options_.shard) {
+            auto const total    = flow_dirs.size();
+            auto const history  = options_.durations ? *options_.durations : DurationHistory{ "" };
+            auto const selected = select_shard(flow_dirs, *options_.shard, history);
+            std::erase_if(flow_dirs, [&selected](auto const &flow) {
+                return not selected.contains(flow.first);
+            });
+            reporting.get().record(SimpleEvent{ "SHARD",
+                fmt::format("{}/{} runs {} of {} flows", options_.shard->index, options_.shard->count, flow_dirs.size(), total) });
+        }
+
+        services_.template get<flow_factory_t>().get().fixtures().clear(); // fixtures may have changed since the last run
+        if(options_.incremental)
+            options_.incremental->begin();
+
+        auto names = std::vector<std::string>{};
         for(auto const &[name, dir] : flow_dirs) {
-            try {
-                // the scheduler could run a thread pool and execute multiple runners concurrently.
-                // this is not really needed yet so leaving it as single threaded for now.
-                auto runner = flow_runner_t{
-                    services_, name, dir
-                };
-                runner.run();
-                reporting.get().record(SuccessEvent{ name });
-
-            } catch(FlowException const &e) {
-                reporting.get().record(FailureEvent{ name, e.path, e.issues, e.response });
-            }
+            if(options_.incremental and options_.incremental->is_up_to_date(name, dir))
+                reporting.get().record(SimpleEvent{ "SKIP FLOW", fmt::format("{} (unchanged since it last passed)", name) });
+            else
+                names.push_back(name);
+        }
+
+        auto const jobs = std::max<std::size_t>(1, std::min(options_.jobs, names.size()));
+        auto plan       = std::vector<DurationHistory::Prediction>{};
+        if(options_.durations) {
+            plan = options_.durations->predict(names);
+            if(jobs > 1) // a single worker takes the same time in any order, so keep the familiar one
+                sort_longest_first(plan);
+            names.clear();
+            std::transform(std::begin(plan), std::end(plan), std::back_inserter(names), [](auto const &p) {
+                return p.name;
+            });
+        }
+
+        // workers pick the next flow as soon as they are free, which is how the makespan is predicted too
+        auto usage_rows = std::vector<UsageSummaryEvent::Row>(names.size());
+        auto next       = std::atomic<std::size_t>{ 0 };
+        auto work       = [&] {
+            for(auto i = next++; i < names.size(); i = next++)
+                usage_rows[i] = run_one(names[i], flow_dirs.at(names[i]));
+        };
+
+        auto const started = std::chrono::steady_clock::now();
+        if(jobs == 1) {
+            work();
+        } else {
+            auto workers = std::vector<std::future<void>>{};
+            for(auto i = std::size_t{ 0 }; i < jobs; ++i)
+                workers.push_back(std::async(std::launch::async, work));
+            for(auto &worker : workers)
+                worker.get();
         }
+        auto const actual = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
 
+        for(auto const &row : usage_rows) {
+            if(options_.incremental)
+                options_.incremental->record(row.flow_name, row.passed);
+            if(options_.durations and row.passed)
+                options_.durations->record(row.flow_name, row.duration);
+        }
+
+        if(options_.durations and not plan.empty()) {
+            reporting.get().record(SimpleEvent{ "MAKESPAN",
+                fmt::format("predicted {}ms, actual {}ms with {} worker(s)", makespan(plan, jobs).count(), actual.count(), jobs) });
+            options_.durations->store();
+        }
+
+        std::sort(std::begin(usage_rows), std::end(usage_rows), [](auto const &a, auto const &b) {
+            return a.flow_name < b.flow_name;
+        });
+        if(not usage_rows.empty())
+            reporting.get().record(UsageSummaryEvent{ std::move(usage_rows) });
+        reporting.get().summarize();
+        if(options_.incremental)
+            options_.incremental->finish();
         return EXIT_SUCCESS;
     }
+
+    /**
+     * @brief Runs a single flow and records its result
+     */
+    UsageSummaryEvent::Row run_one(std::string const &name, std::string const &dir) {
+        if(options_.isolation)
+            return run_isolated(name, dir);
+
+        auto const &reporting = services_.template get<reporting_t>();
+
+        auto span    = trace::Span{ "flow", "{}", name };
+        auto started = std::chrono::steady_clock::now();
+        auto elapsed = [&started] {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+        };
+        auto before = metrics::snapshot();
+        auto used   = [&before] {
+            return metrics::snapshot() - before;
+        };
+
+        try {
+            auto runner = flow_runner_t{
+                services_, name, dir
+            };
+            runner.run();
+            metrics::Registry::instance().flows_passed.fetch_add(1, std::memory_order_relaxed);
+
+            auto const duration = elapsed();
+            auto const usage    = used();
+            reporting.get().record(SuccessEvent{ name, duration, usage });
+            return { name, true, duration, usage };
+
+        } catch(FlowException &e) {
+            metrics::Registry::instance().flows_failed.fetch_add(1, std::memory_order_relaxed);
+
+            auto const duration = elapsed();
+            auto const usage    = used();
+            reporting.get().record(FailureEvent{ name, e.path, std::move(e.issues), std::move(e.response), duration, usage });
+            return { name, false, duration, usage };
+        }
+    }
+
+private:
+    /**
+     * @brief Runs a flow in a child of the fork server and records what it sends back
+     *
+     * Counters of the child are lost with it, so the registry is updated from its events.
+     */
+    UsageSummaryEvent::Row run_isolated(std::string const &name, std::string const &dir) {
+        auto const &reporting = services_.template get<reporting_t>();
+        auto &registry        = metrics::Registry::instance();
+
+        auto span    = trace::Span{ "flow", "{}", name };
+        auto started = std::chrono::steady_clock::now();
+        auto result  = std::optional<UsageSummaryEvent::Row>{};
+
+        auto const complete = [&](auto &&ev, bool passed) {
+            (passed ? registry.flows_passed : registry.flows_failed).fetch_add(1, std::memory_order_relaxed);
+            registry.requests_sent.fetch_add(ev.usage.requests, std::memory_order_relaxed);
+            registry.bytes_sent.fetch_add(ev.usage.bytes_sent, std::memory_order_relaxed);
+            registry.bytes_received.fetch_add(ev.usage.bytes_received, std::memory_order_relaxed);
+            result = UsageSummaryEvent::Row{ name, passed, ev.duration, ev.usage };
+            reporting.get().record(std::move(ev));
+        };
+
+        auto outcome = isolation::ForkServer::Exit::COMPLETED;
+        auto error   = std::string{};
+        try {
+            outcome = options_.isolation->run(name, dir, options_.flow_timeout, [&](std::vector<std::uint8_t> const &frame) {
+                auto const event = inja::json::from_msgpack(frame);
+                auto const type  = event.at("event").template get<std::string>();
+                if(type == "simple") {
+                    reporting.get().record(event_json::to_simple(event));
+                } else if(type == "request") {
+                    reporting.get().record(event_json::to_request(event));
+                } else if(type == "response") {
+                    reporting.get().record(event_json::to_response(event));
+                } else if(type == "latency") {
+                    auto latency = event_json::to_latency(event);
+                    registry.response(latency.method);
+                    registry.latency.observe(latency.total);
+                    reporting.get().record(std::move(latency));
+                } else if(type == "success") {
+                    complete(event_json::to_success(event), true);
+                } else if(type == "failure") {
+                    complete(event_json::to_failure(event), false);
+                }
+            });
+        } catch(inja::json::exception const &e) {
+            // the child is killed by now; only its flow is lost, not the run
+            error = fmt::format("Flow process sent a malformed result: {}", e.what());
+        } catch(std::runtime_error const &e) {
+            // no process was started for it, e.g. the fork server is gone or the request is too large
+            error = fmt::format("Could not run the flow in its own process: {}", e.what());
+        }
+
+        if(not result) {
+            auto const duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+            auto type           = FailureEvent::Data::Type::LOGIC_ERROR;
+            auto message        = std::string{ "Flow process exited without a result" };
+            if(not error.empty()) {
+                message = std::move(error);
+            } else if(outcome == isolation::ForkServer::Exit::TIMED_OUT) {
+                type    = FailureEvent::Data::Type::TIMEOUT;
+                message = fmt::format("Flow did not finish within {}ms and was killed", options_.flow_timeout.count());
+            }
+            complete(FailureEvent{ name, name, { { type, name, message } }, "No data", duration }, false);
+        }
+        return *result;
+    }
+
+    Options options_;
 };
@@ -0,0 +1,117 @@
+#include <trace/tracer.hpp>
+
+#include <fmt/format.h>
+
+#include <cstdio>
+#include <iterator>
+#include <stdexcept>
+
+namespace trace {
+
+namespace {
+constexpr std::uint64_t first_named_track = std::uint64_t{ 1 } << 32;
+
+std::string escaped(std::string_view value) {
+    std::string result;
+    result.reserve(value.size());
+    for(auto c : value) {
+        switch(c) {
+        case '"':
+            result += "\\\"";
+            break;
+        case '\\':
+            result += "\\\\";
+            break;
+        default:
+            if(static_cast<unsigned char>(c) < 0x20)
+                result += fmt::format("\\u{:04x}", static_cast<int>(c));
+            else
+                result += c;
+        }
+    }
+    return result;
+}
+} // namespace
+
+Tracer &Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+void Tracer::enable() {
+    start_ = clock_t::now();
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::disable() {
+    enabled_.store(false, std::memory_order_relaxed);
+}
+
+std::uint64_t Tracer::thread_track() {
+    thread_local auto const id = next_thread_++;
+    return id;
+}
+
+std::uint64_t Tracer::track(Track const &track) {
+    std::scoped_lock l{ mtx_ };
+    if(auto it = tracks_.find(track.key); it != tracks_.end())
+        return it->second;
+
+    auto const id = first_named_track + tracks_.size();
+    tracks_.emplace(track.key, id);
+    track_names_.emplace(id, fmt::format("{} {}", track.label, tracks_.size()));
+    return id;
+}
+
+void Tracer::complete(std::uint64_t track, char const *category, std::string &&name, clock_t::time_point begin, clock_t::time_point end) {
+    auto &buffer = local_buffer();
+    std::scoped_lock l{ buffer.mtx };
+    buffer.records.push_back({ track, category, std::move(name), begin, end });
+}
+
+Tracer::Buffer &Tracer::local_buffer() {
+    thread_local auto const buffer = [this] {
+        auto buf = std::make_shared<Buffer>();
+        std::scoped_lock l{ mtx_ };
+        buffers_.push_back(buf);
+        return buf;
+    }();
+    return *buffer;
+}
+
+void Tracer::write(std::string const &path) const {
+    auto const micros = [this](clock_t::time_point tp) {
+        return std::chrono::duration<double, std::micro>(tp - start_).count();
+    };
+
+    fmt::memory_buffer buf;
+    auto out   = std::back_inserter(buf);
+    auto first = true;
+    auto sep   = [&first] {
+        return std::exchange(first, false) ? "\n" : ",\n";
+    };
+
+    fmt::format_to(out, "{{\"traceEvents\":[");
+    {
+        std::scoped_lock l{ mtx_ };
+        for(auto const &[id, name] : track_names_)
+            fmt::format_to(out, "{}{{\"ph\":\"M\",\"pid\":1,\"tid\":{},\"name\":\"thread_name\",\"args\":{{\"name\":\"{}\"}}}}",
+                sep(), id, escaped(name));
+
+        for(auto const &buffer : buffers_) {
+            std::scoped_lock bl{ buffer->mtx };
+            for(auto const &rec : buffer->records)
+                fmt::format_to(out, "{}{{\"ph\":\"X\",\"pid\":1,\"tid\":{},\"cat\":\"{}\",\"name\":\"{}\",\"ts\":{:.3f},\"dur\":{:.3f}}}",
+                    sep(), rec.track, rec.category, escaped(rec.name), micros(rec.begin), micros(rec.end) - micros(rec.begin));
+        }
+    }
+    fmt::format_to(out, "\n],\"displayTimeUnit\":\"ms\"}}\n");
+
+    auto *file = std::fopen(path.c_str(), "w");
+    if(file == nullptr)
+        throw std::runtime_error("Could not open trace file " + path);
+    std::fwrite(buf.data(), 1, buf.size(), file);
+    std::fclose(file);
+}
+
+} // namespace trace
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <fmt/format.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace trace {
+
+/**
+ * @brief Collects spans and writes them out in the Chrome Trace Event Format
+ *
+ * Process-wide and disabled by default. While disabled a Span costs a single relaxed atomic load.
+ * Every thread appends to its own buffer so recording spans from multiple threads does not contend.
+ */
+class Tracer {
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    /**
+     * @brief A named timeline that is not a thread, e.g. a connection
+     */
+    struct Track {
+        void const *key;
+        char const *label;
+    };
+
+    static Tracer &instance();
+
+    static bool enabled() noexcept {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    void enable();
+
+    /**
+     * @brief Stops recording new spans; the ones recorded so far are kept
+     */
+    void disable();
+
+    /**
+     * @brief Writes all spans recorded so far into a json file; tracing stays enabled
+     *
+     * @param path
+     */
+    void write(std::string const &path) const;
+
+    /**
+     * @brief Id of the calling thread's timeline
+     */
+    std::uint64_t thread_track();
+
+    /**
+     * @brief Id of a named timeline; the same key always maps to the same id
+     */
+    std::uint64_t track(Track const &track);
+
+    void complete(std::uint64_t track, char const *category, std::string &&name, clock_t::time_point begin, clock_t::time_point end);
+
+private:
+    struct Record {
+        std::uint64_t track;
+        char const *category;
+        std::string name;
+        clock_t::time_point begin;
+        clock_t::time_point end;
+    };
+
+    struct Buffer {
+        std::mutex mtx;
+        std::vector<Record> records;
+    };
+
+    Tracer() = default;
+    Buffer &local_buffer();
+
+    inline static std::atomic_bool enabled_ = false;
+
+    clock_t::time_point start_ = clock_t::now();
+    std::atomic<std::uint64_t> next_thread_ = 1;
+
+    mutable std::mutex mtx_;
+    std::vector<std::shared_ptr<Buffer>> buffers_; // outlive the threads that filled them
+    std::map<void const *, std::uint64_t> tracks_;
+    std::map<std::uint64_t, std::string> track_names_;
+};
+
+/**
+ * @brief Records the time between construction and destruction as a span
+ *
+ * The name is only formatted when tracing is enabled.
+ */
+class Span {
+    std::uint64_t track_ = 0;
+    char const *category_;
+    std::string name_;
+    Tracer::clock_t::time_point begin_;
+
+public:
+    template <typename... Args>
+    Span(char const *category, fmt::format_string<Args...> name, Args &&...args)
+        : category_{ category } {
+        if(Tracer::enabled())
+            start(Tracer::instance().thread_track(), fmt::format(name, std::forward<Args>(args)...));
+    }
+
+    template <typename... Args>
+    Span(Tracer::Track const &track, char const *category, fmt::format_string<Args...> name, Args &&...args)
+        : category_{ category } {
+        if(Tracer::enabled())
+            start(Tracer::instance().track(track), fmt::format(name, std::forward<Args>(args)...));
+    }
+
+    ~Span() {
+        if(track_ != 0)
+            Tracer::instance().complete(track_, category_, std::move(name_), begin_, Tracer::clock_t::now());
+    }
+
+    Span(Span const &)            = delete;
+    Span &operator=(Span const &) = delete;
+
+private:
+    void start(std::uint64_t track, std::string &&name) {
+        track_ = track;
+        name_  = std::move(name);
+        begin_ = Tracer::clock_t::now();
+    }
+};
+
+} // namespace trace
@@ -0,0 +1,73 @@
+#include <util/arena.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <numeric>
+
+namespace util {
+
+namespace {
+thread_local std::pmr::memory_resource *current_resource = nullptr;
+
+Arena &local_arena() {
+    static thread_local Arena arena;
+    return arena;
+}
+} // namespace
+
+Arena::Scope::Scope()
+    : arena_{ local_arena() }
+    , previous_{ current_resource } {
+    current_resource = &arena_;
+}
+
+Arena::Scope::~Scope() {
+    current_resource = previous_;
+    if(previous_ != &arena_)
+        arena_.rewind();
+}
+
+std::pmr::memory_resource *Arena::current() noexcept {
+    return current_resource != nullptr ? current_resource : std::pmr::new_delete_resource();
+}
+
+void Arena::rewind() {
+    used_ = 0;
+    if(blocks_.size() <= 1 and capacity() <= max_retained)
+        return;
+
+    // one block for all that was needed this round, so that the next round fits without growing
+    auto const size = std::min(capacity(), max_retained);
+    blocks_.clear();
+    add_block(size);
+}
+
+std::size_t Arena::capacity() const noexcept {
+    return std::accumulate(std::begin(blocks_), std::end(blocks_), std::size_t{ 0 }, [](std::size_t sum, Block const &block) {
+        return sum + block.size;
+    });
+}
+
+void *Arena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    if(not blocks_.empty()) {
+        auto &block = blocks_.back();
+        auto *ptr   = static_cast<void *>(block.data.get() + used_);
+        auto space  = block.size - used_;
+        if(std::align(alignment, bytes, ptr, space) != nullptr) {
+            used_ = block.size - space + bytes;
+            return ptr;
+        }
+    }
+
+    add_block(std::max({ initial_size, bytes + alignment, blocks_.empty() ? 0 : 2 * blocks_.back().size }));
+    return do_allocate(bytes, alignment);
+}
+
+void Arena::add_block(std::size_t size) {
+    blocks_.push_back({ std::make_unique_for_overwrite<std::byte[]>(size), size });
+    used_ = 0;
+}
+
+} // namespace util
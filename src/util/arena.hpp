@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+namespace util {
+
+/**
+ * @brief Monotonic memory for short-lived documents, reused from one step to the next
+ *
+ * Allocations bump a pointer through a few large blocks and are never freed one by one; the
+ * whole arena is rewound at once when the outermost Scope of the thread ends. After rewinding,
+ * the blocks of the last round are merged into one, so a flow that keeps getting the same
+ * kind of responses stops allocating from the heap after its first step.
+ */
+class Arena final : public std::pmr::memory_resource {
+public:
+    static constexpr std::size_t initial_size = 64 * 1024;
+    static constexpr std::size_t max_retained = 32 * 1024 * 1024; // don't hold on to one huge page forever
+
+    /**
+     * @brief Routes ArenaAllocator allocations of this thread to the thread's arena
+     *
+     * Everything allocated in the scope must be gone when the outermost scope ends, since that
+     * is when the arena is rewound. Anything that has to live longer needs to be copied out.
+     */
+    class Scope {
+        Arena &arena_;
+        std::pmr::memory_resource *previous_;
+
+    public:
+        Scope();
+        ~Scope();
+
+        Scope(Scope const &)            = delete;
+        Scope &operator=(Scope const &) = delete;
+    };
+
+    Arena() = default;
+
+    Arena(Arena const &)            = delete;
+    Arena &operator=(Arena const &) = delete;
+
+    /**
+     * @brief Where ArenaAllocator allocates on this thread; the heap outside of any Scope
+     */
+    static std::pmr::memory_resource *current() noexcept;
+
+    /**
+     * @brief Makes all memory available again; everything allocated so far must be gone
+     */
+    void rewind();
+
+    /**
+     * @brief Bytes held, used or not
+     */
+    std::size_t capacity() const noexcept;
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        std::size_t size = 0;
+    };
+
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void *, std::size_t, std::size_t) override { }
+    bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override {
+        return this == &other;
+    }
+
+    void add_block(std::size_t size);
+
+    std::vector<Block> blocks_;
+    std::size_t used_ = 0; // of the last block
+};
+
+/**
+ * @brief Stateless allocator drawing from Arena::current()
+ *
+ * For containers that default construct their allocators, like nlohmann::basic_json. Every
+ * allocation remembers the resource it came from, so memory allocated outside of a Scope can
+ * still be freed inside of one and the other way around, e.g. on a helper thread.
+ */
+template <typename T>
+class ArenaAllocator {
+    // room for the resource in front of every allocation, keeping the alignment of T
+    static constexpr std::size_t header    = std::max(alignof(T), alignof(std::max_align_t));
+    static constexpr std::size_t alignment = header;
+
+public:
+    using value_type = T;
+
+    ArenaAllocator() noexcept = default;
+
+    template <typename U>
+    ArenaAllocator(ArenaAllocator<U> const &) noexcept { }
+
+    T *allocate(std::size_t n) {
+        auto *resource = Arena::current();
+        auto *block    = static_cast<std::byte *>(resource->allocate(header + n * sizeof(T), alignment));
+        ::new(block) std::pmr::memory_resource *(resource);
+        return reinterpret_cast<T *>(block + header);
+    }
+
+    void deallocate(T *ptr, std::size_t n) noexcept {
+        auto *block    = reinterpret_cast<std::byte *>(ptr) - header;
+        auto *resource = *std::launder(reinterpret_cast<std::pmr::memory_resource **>(block));
+        resource->deallocate(block, header + n * sizeof(T), alignment);
+    }
+
+    template <typename U>
+    bool operator==(ArenaAllocator<U> const &) const noexcept {
+        return true;
+    }
+};
+
+} // namespace util
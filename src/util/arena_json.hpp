@@ -0,0 +1,75 @@
+#pragma once
+
+#include <util/arena.hpp>
+
+#include <inja/inja.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace util {
+
+using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+/**
+ * @brief JSON document for the lifetime of a step, allocated from the arena of the current Arena::Scope
+ *
+ * Used for parsed responses, rendered expectations and the like, which are thrown away as soon
+ * as the step is done. Nothing of it may end up in the store; see promote.
+ */
+using ArenaJson = nlohmann::basic_json<std::map, std::vector, ArenaString, bool, std::int64_t, std::uint64_t, double, ArenaAllocator>;
+
+/**
+ * @brief Deep copy of an arena document into one that owns its memory, e.g. to keep it in the store
+ */
+template <typename Json = inja::json>
+Json promote(ArenaJson const &value) {
+    using string_t = typename Json::string_t;
+
+    switch(value.type()) {
+    case ArenaJson::value_t::object: {
+        auto result = Json::object();
+        for(auto it = value.begin(); it != value.end(); ++it)
+            result[string_t{ it.key().data(), it.key().size() }] = promote<Json>(it.value());
+        return result;
+    }
+    case ArenaJson::value_t::array: {
+        auto result = Json::array();
+        result.template get_ref<typename Json::array_t &>().reserve(value.size());
+        for(auto const &element : value)
+            result.push_back(promote<Json>(element));
+        return result;
+    }
+    case ArenaJson::value_t::string: {
+        auto const &str = value.get_ref<ArenaString const &>();
+        return string_t{ str.data(), str.size() };
+    }
+    case ArenaJson::value_t::boolean:
+        return value.get<bool>();
+    case ArenaJson::value_t::number_integer:
+        return value.get<std::int64_t>();
+    case ArenaJson::value_t::number_unsigned:
+        return value.get<std::uint64_t>();
+    case ArenaJson::value_t::number_float:
+        return value.get<double>();
+    case ArenaJson::value_t::binary:
+        return Json::binary(value.get_binary());
+    default:
+        return nullptr;
+    }
+}
+
+} // namespace util
+
+// nlohmann hashes strings with std::hash<string_t>, which only exists for the standard allocators
+template <>
+struct std::hash<util::ArenaString> {
+    std::size_t operator()(util::ArenaString const &str) const noexcept {
+        return std::hash<std::string_view>{}(str);
+    }
+};
@@ -1,71 +1,126 @@
 #pragma once
 
-#include <condition_variable>
+#include <util/ring_buffer.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
-#include <mutex>
 #include <optional>
-#include <queue>
+#include <thread>
+#include <utility>
 
 namespace util {
 
+/**
+ * @brief Bounded blocking multi-producer multi-consumer queue
+ *
+ * Elements live in a lock-free RingBuffer. A full enqueue or an empty dequeue spins for a
+ * short while and then parks on a counter that the other side bumps once per element, waking
+ * a single waiter instead of every thread that waits on the queue.
+ *
+ * @tparam T Needs to be copy constructible
+ */
 template <typename T>
 class AsyncQueue {
+    static constexpr int spins = 64; // attempts before parking; a borrowed connection usually comes back quickly
+
 public:
+    /**
+     * @param capacity Rounded up to the next power of two
+     * @param deleter Called on every element still queued when the queue is stopped
+     */
     template <typename Fn>
     AsyncQueue(
         std::size_t const capacity, Fn deleter = [](T &) {})
-        : capacity_{ capacity }
-        , deleter_{ deleter } { }
+        : deleter_{ deleter }
+        , q_{ capacity } { }
+
+    AsyncQueue(AsyncQueue const &)            = delete;
+    AsyncQueue &operator=(AsyncQueue const &) = delete;
 
+    /**
+     * @brief Blocks while the queue is full; does nothing once the queue is stopped
+     */
     void enqueue(T const &element) {
-        std::unique_lock l{ mtx_ };
-        cv_.wait(l, [this] { return q_.size() < capacity_ || stop_requested_; });
+        auto value = element;
+        for(auto attempt = 0;; ++attempt) {
+            auto const seen = dequeued_.load();
+            if(stop_requested_)
+                return;
 
-        if(stop_requested_)
-            return;
+            if(q_.try_push(value)) {
+                ++enqueued_;
+                enqueued_.notify_one();
+                if(stop_requested_)
+                    drain(); // raced with stop, which may have missed this element
+                return;
+            }
 
-        q_.push(element);
-        cv_.notify_all();
+            if(attempt < spins)
+                std::this_thread::yield();
+            else
+                dequeued_.wait(seen);
+        }
     }
 
+    /**
+     * @brief Wakes all waiting threads and hands every queued element to the deleter
+     */
     void stop() {
-        std::unique_lock l{ mtx_ };
         stop_requested_ = true;
-        while(not q_.empty()) {
-            deleter_(q_.front());
-            q_.pop();
-        }
-        cv_.notify_all();
+        drain();
+
+        ++enqueued_;
+        ++dequeued_;
+        enqueued_.notify_all();
+        dequeued_.notify_all();
     }
 
+    /**
+     * @brief Approximate number of elements; exact only when there is no concurrent access
+     */
     [[nodiscard]] std::size_t size() const {
-        std::scoped_lock l{ mtx_ };
         return q_.size();
     }
 
+    /**
+     * @brief Blocks while the queue is empty
+     *
+     * @return The oldest element, or nothing once the queue is stopped
+     */
     [[nodiscard]] std::optional<T> dequeue() {
-        std::unique_lock l{ mtx_ };
-        cv_.wait(l, [this] { return !q_.empty() || stop_requested_; });
-
-        if(stop_requested_)
-            return {};
+        auto value = std::optional<T>{};
+        for(auto attempt = 0;; ++attempt) {
+            auto const seen = enqueued_.load();
+            if(stop_requested_)
+                return {};
 
-        auto value = q_.front();
-        q_.pop();
+            if(q_.pop_with([&value](T &&element) { value.emplace(std::move(element)); })) {
+                ++dequeued_;
+                dequeued_.notify_one();
+                return value;
+            }
 
-        l.unlock();
-        cv_.notify_all();
-        return std::make_optional<T>(value);
+            if(attempt < spins)
+                std::this_thread::yield();
+            else
+                enqueued_.wait(seen);
+        }
     }
 
 private:
-    std::size_t capacity_;
+    void drain() {
+        while(q_.pop_with([this](T &&element) { deleter_(element); })) { }
+    }
+
     std::function<void(T &)> deleter_;
-    std::queue<T> q_;
+    RingBuffer<T> q_;
 
-    mutable std::mutex mtx_;
-    std::condition_variable cv_;
-    bool stop_requested_ = false;
+    // bumped once per element; 32 bits so that waiting on them maps directly to a futex
+    std::atomic<std::uint32_t> enqueued_ = 0;
+    std::atomic<std::uint32_t> dequeued_ = 0;
+    std::atomic_bool stop_requested_     = false;
 };
 
 } // namespace util
@@ -0,0 +1,109 @@
+#include <util/directory_watcher.hpp>
+
+#include <fmt/format.h>
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <system_error>
+
+namespace util {
+
+namespace {
+constexpr auto watched_events = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+
+bool is_hidden(std::filesystem::path const &path) {
+    return path.filename().string().starts_with(".");
+}
+} // namespace
+
+DirectoryWatcher::DirectoryWatcher(std::filesystem::path const &root)
+    : fd_{ ::inotify_init1(IN_CLOEXEC) } {
+    if(fd_ < 0)
+        throw std::system_error{ errno, std::generic_category(), "Could not initialize inotify" };
+
+    try {
+        add(root);
+        if(watches_.empty())
+            throw std::system_error{ ENOENT, std::generic_category(), fmt::format("Could not watch {}", root.string()) };
+    } catch(...) {
+        ::close(fd_);
+        throw;
+    }
+}
+
+DirectoryWatcher::~DirectoryWatcher() {
+    ::close(fd_);
+}
+
+std::vector<std::filesystem::path> DirectoryWatcher::wait(std::chrono::milliseconds settle) {
+    auto changed = std::vector<std::filesystem::path>{};
+    auto pfd     = pollfd{ fd_, POLLIN, 0 };
+    auto timeout = -1; // wait forever for the first change
+
+    while(true) {
+        auto const ready = ::poll(&pfd, 1, timeout);
+        if(ready < 0 and errno == EINTR)
+            continue;
+        if(ready < 0)
+            throw std::system_error{ errno, std::generic_category(), "Could not wait for file changes" };
+        if(ready == 0)
+            break; // settled
+
+        if(read_events(changed) or not changed.empty())
+            timeout = static_cast<int>(settle.count());
+    }
+
+    std::sort(std::begin(changed), std::end(changed));
+    changed.erase(std::unique(std::begin(changed), std::end(changed)), std::end(changed));
+    return changed;
+}
+
+void DirectoryWatcher::add(std::filesystem::path const &dir) {
+    auto const wd = ::inotify_add_watch(fd_, dir.c_str(), watched_events);
+    if(wd < 0 and errno == ENOENT)
+        return; // removed again before we got to it, its deletion is reported by the parent
+    if(wd < 0)
+        throw std::system_error{ errno, std::generic_category(), fmt::format("Could not watch {}", dir.string()) };
+    watches_[wd] = dir;
+
+    auto ec = std::error_code{};
+    for(auto it = std::filesystem::directory_iterator{ dir, ec }; not ec and it != std::filesystem::directory_iterator{}; it.increment(ec))
+        if(auto gone = std::error_code{}; it->is_directory(gone) and not is_hidden(it->path()))
+            add(it->path());
+    if(ec and ec != std::errc::no_such_file_or_directory)
+        throw std::system_error{ ec, fmt::format("Could not watch {}", dir.string()) };
+}
+
+bool DirectoryWatcher::read_events(std::vector<std::filesystem::path> &changed) {
+    alignas(inotify_event) auto buffer = std::array<char, 4096>{};
+    auto const size                    = ::read(fd_, buffer.data(), buffer.size());
+    if(size <= 0)
+        return false;
+
+    auto relevant = false;
+    for(auto offset = ssize_t{ 0 }; offset < size;) {
+        auto const *event = reinterpret_cast<inotify_event const *>(buffer.data() + offset);
+        offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+        auto const dir = watches_.find(event->wd);
+        if(dir == std::end(watches_) or event->len == 0)
+            continue;
+
+        auto const path = dir->second / event->name;
+        if(is_hidden(path))
+            continue;
+
+        if((event->mask & IN_ISDIR) and (event->mask & (IN_CREATE | IN_MOVED_TO)))
+            add(path); // e.g. a new flow
+        changed.push_back(path);
+        relevant = true;
+    }
+    return relevant;
+}
+
+} // namespace util
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <vector>
+
+namespace util {
+
+/**
+ * @brief Watches a directory tree for changed files using inotify
+ *
+ * Hidden files and directories are ignored, which keeps cliot's own manifest and results
+ * database from triggering runs.
+ */
+class DirectoryWatcher {
+    int fd_ = -1;
+    std::map<int, std::filesystem::path> watches_; // watch descriptor -> directory
+
+public:
+    explicit DirectoryWatcher(std::filesystem::path const &root);
+    ~DirectoryWatcher();
+
+    DirectoryWatcher(DirectoryWatcher const &)            = delete;
+    DirectoryWatcher &operator=(DirectoryWatcher const &) = delete;
+
+    /**
+     * @brief Blocks until something changed, then until nothing changed for the settle time
+     *
+     * @return The changed paths, so that editors saving several files at once cause a single run
+     */
+    std::vector<std::filesystem::path> wait(std::chrono::milliseconds settle = std::chrono::milliseconds{ 200 });
+
+private:
+    void add(std::filesystem::path const &dir);
+    bool read_events(std::vector<std::filesystem::path> &changed);
+};
+
+} // namespace util
@@ -0,0 +1,25 @@
+#include <util/hash.hpp>
+
+#include <fmt/format.h>
+#include <openssl/evp.h>
+
+#include <array>
+#include <iterator>
+#include <stdexcept>
+
+namespace util {
+
+std::string sha256_hex(std::string_view data) {
+    auto digest = std::array<unsigned char, EVP_MAX_MD_SIZE>{};
+    auto size   = 0u;
+    if(::EVP_Digest(data.data(), data.size(), digest.data(), &size, ::EVP_sha256(), nullptr) != 1)
+        throw std::runtime_error{ "Could not compute SHA-256" };
+
+    auto result = std::string{};
+    result.reserve(2 * size);
+    for(auto i = 0u; i < size; ++i)
+        fmt::format_to(std::back_inserter(result), "{:02x}", digest[i]);
+    return result;
+}
+
+} // namespace util
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace util {
+
+/**
+ * @brief 64-bit FNV-1a
+ */
+inline std::uint64_t fnv1a(std::string_view data) {
+    auto result = std::uint64_t{ 14695981039346656037ull };
+    for(auto c : data) {
+        result ^= static_cast<unsigned char>(c);
+        result *= 1099511628211ull;
+    }
+    return result;
+}
+
+/**
+ * @brief SHA-256 as 64 lowercase hex digits, for content addressing where a collision must not happen
+ */
+std::string sha256_hex(std::string_view data);
+
+} // namespace util
@@ -0,0 +1,266 @@
+#include <util/json_query.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace util::json_query {
+
+namespace {
+
+inja::json const *step(inja::json const *current, std::string_view token) {
+    if(current->is_object()) {
+        auto it = current->find(std::string{ token });
+        return it == current->end() ? nullptr : &*it;
+    }
+
+    if(current->is_array()) {
+        std::size_t index = 0;
+        auto [ptr, ec]    = std::from_chars(token.data(), token.data() + token.size(), index);
+        if(ec != std::errc{} or ptr != token.data() + token.size() or index >= current->size())
+            return nullptr;
+        return &(*current)[index];
+    }
+
+    return nullptr;
+}
+
+inja::json const *find_pointer(inja::json const &value, std::string_view path) {
+    auto current = &value;
+    std::string token;
+
+    while(current and not path.empty()) {
+        path.remove_prefix(1); // leading '/'
+        auto const end = path.find('/');
+        auto raw       = path.substr(0, end);
+        path           = end == std::string_view::npos ? std::string_view{} : path.substr(end);
+
+        token.clear();
+        for(std::size_t i = 0; i < raw.size(); ++i) {
+            if(raw[i] != '~') {
+                token += raw[i];
+                continue;
+            }
+            if(i + 1 == raw.size() or (raw[i + 1] != '0' and raw[i + 1] != '1'))
+                throw std::invalid_argument{ "Invalid '~' escape in JSON pointer" };
+            token += raw[i + 1] == '1' ? '/' : '~';
+            ++i;
+        }
+        current = step(current, token);
+    }
+
+    return current;
+}
+
+inja::json const *find_path(inja::json const &value, std::string_view path) {
+    // a root of "$" only when followed by a path; "$res" is a store key like any other
+    if(path == "$" or path.starts_with("$.") or path.starts_with("$["))
+        path.remove_prefix(1);
+
+    auto current = &value;
+    while(current and not path.empty()) {
+        if(path.front() == '.') {
+            path.remove_prefix(1);
+            continue;
+        }
+
+        if(path.front() == '[') {
+            auto const end = path.find(']');
+            if(end == std::string_view::npos)
+                throw std::invalid_argument{ "Unterminated '[' in JSON path" };
+
+            auto token = path.substr(1, end - 1);
+            if(token.size() >= 2 and (token.front() == '\'' or token.front() == '"'))
+                token = token.substr(1, token.size() - 2);
+
+            current = step(current, token);
+            path.remove_prefix(end + 1);
+            continue;
+        }
+
+        auto const end = path.find_first_of(".[");
+        current        = step(current, path.substr(0, end));
+        path           = end == std::string_view::npos ? std::string_view{} : path.substr(end);
+    }
+
+    return current;
+}
+
+inja::json const &at_or_null(inja::json const &value, std::string_view path) {
+    static inja::json const null_value = nullptr;
+    if(path.empty())
+        return value;
+    auto found = find(value, path);
+    return found ? *found : null_value;
+}
+
+void require_array(inja::json const &value, std::string_view what) {
+    if(not value.is_array())
+        throw std::invalid_argument{ std::string{ what } + " expects an array" };
+}
+
+/**
+ * @brief Integer sum that keeps unsigned values above INT64_MAX intact
+ *
+ * Non-negative and negative values are summed apart; overflowing either falls back to a double.
+ */
+class IntegerSum {
+    static constexpr auto max_ = std::numeric_limits<std::uint64_t>::max();
+
+    std::uint64_t positive_ = 0;
+    std::uint64_t negative_ = 0; // magnitude
+    bool overflow_          = false;
+    double approximate_     = 0.0; // what is left once either part overflowed
+
+public:
+    void add(std::uint64_t value) {
+        overflow_ |= value > max_ - positive_;
+        positive_ += value;
+        approximate_ += static_cast<double>(value);
+    }
+
+    void add(std::int64_t value) {
+        if(value >= 0)
+            return add(static_cast<std::uint64_t>(value));
+        auto const magnitude = static_cast<std::uint64_t>(-(value + 1)) + 1;
+        overflow_ |= magnitude > max_ - negative_;
+        negative_ += magnitude;
+        approximate_ -= static_cast<double>(magnitude);
+    }
+
+    double as_double() const {
+        return approximate_;
+    }
+
+    inja::json result() const {
+        if(overflow_)
+            return as_double();
+        if(positive_ >= negative_)
+            return positive_ - negative_;
+        auto const magnitude = negative_ - positive_;
+        if(magnitude - 1 > static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()))
+            return as_double();
+        return -static_cast<std::int64_t>(magnitude - 1) - 1;
+    }
+};
+
+template <typename T>
+void add_parsed(IntegerSum &integral, std::string const &str) {
+    T parsed;
+    auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), parsed);
+    if(ec != std::errc{} or ptr != str.data() + str.size())
+        throw std::invalid_argument{ "sum: '" + str + "' is not a number" };
+    integral.add(parsed);
+}
+
+} // namespace
+
+inja::json const *find(inja::json const &value, std::string_view path) {
+    if(path.empty() or path.front() == '/')
+        return find_pointer(value, path);
+    return find_path(value, path);
+}
+
+std::size_t length(inja::json const &value) {
+    if(value.is_array() or value.is_object())
+        return value.size();
+    if(value.is_string())
+        return value.get_ref<std::string const &>().size();
+    return 0;
+}
+
+inja::json slice(inja::json const &array, std::int64_t begin, std::int64_t end) {
+    require_array(array, "slice");
+
+    auto const size = static_cast<std::int64_t>(array.size());
+    auto clamp      = [size](std::int64_t idx) {
+        if(idx < 0)
+            idx += size;
+        return std::clamp<std::int64_t>(idx, 0, size);
+    };
+
+    begin       = clamp(begin);
+    end         = clamp(end);
+    auto result = inja::json::array();
+    if(begin < end)
+        result.insert(result.end(), array.begin() + begin, array.begin() + end);
+    return result;
+}
+
+inja::json pluck(inja::json const &array, std::string_view path) {
+    require_array(array, "pluck");
+
+    auto result = inja::json::array();
+    result.get_ref<inja::json::array_t &>().reserve(array.size());
+    for(auto const &element : array)
+        result.push_back(at_or_null(element, path));
+    return result;
+}
+
+inja::json find_by(inja::json const &array, std::string_view path, inja::json const &expected) {
+    require_array(array, "find_by");
+
+    for(auto const &element : array) {
+        if(at_or_null(element, path) == expected)
+            return element;
+    }
+    return nullptr;
+}
+
+inja::json sum(inja::json const &array, std::string_view path) {
+    require_array(array, "sum");
+
+    bool is_integral = true;
+    auto integral    = IntegerSum{};
+    double floating  = 0.0;
+
+    for(auto const &element : array) {
+        auto const &value = at_or_null(element, path);
+        if(value.is_number_unsigned()) {
+            integral.add(value.get<std::uint64_t>());
+        } else if(value.is_number_integer()) {
+            integral.add(value.get<std::int64_t>());
+        } else if(value.is_number_float()) {
+            is_integral = false;
+            floating += value.get<double>();
+        } else if(value.is_string()) {
+            auto const &str = value.get_ref<std::string const &>();
+            if(str.starts_with('-'))
+                add_parsed<std::int64_t>(integral, str);
+            else
+                add_parsed<std::uint64_t>(integral, str);
+        } else if(not value.is_null()) {
+            throw std::invalid_argument{ "sum: " + value.dump() + " is not a number" };
+        }
+    }
+
+    if(is_integral)
+        return integral.result();
+    return floating + integral.as_double();
+}
+
+inja::json sort_by(inja::json const &array, std::string_view path) {
+    require_array(array, "sort_by");
+
+    // sort references first so that every element is copied exactly once
+    std::vector<std::pair<inja::json const *, inja::json const *>> order;
+    order.reserve(array.size());
+    for(auto const &element : array)
+        order.emplace_back(&at_or_null(element, path), &element);
+
+    std::stable_sort(std::begin(order), std::end(order), [](auto const &lhs, auto const &rhs) {
+        return *lhs.first < *rhs.first;
+    });
+
+    auto result = inja::json::array();
+    result.get_ref<inja::json::array_t &>().reserve(array.size());
+    for(auto const &[key, element] : order)
+        result.push_back(*element);
+    return result;
+}
+
+} // namespace util::json_query
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <inja/inja.hpp>
+
+#include <cstdint>
+#include <string_view>
+
+namespace util {
+
+/**
+ * @brief Native helpers to query JSON values without materializing them
+ *
+ * All helpers operate on the given value by reference and only ever copy what ends up in the result.
+ * Paths can be given either as a JSON Pointer ("/result/ledger/0/hash") or as a simple
+ * JSONPath expression ("$.result.ledger[0].hash" or "result.ledger[0].hash"). A leading "$" only
+ * stands for the root when followed by '.' or '[', so "$res.result" looks up the "$res" key.
+ */
+namespace json_query {
+
+/**
+ * @brief Finds the value at the given path
+ *
+ * @param value The value to search in
+ * @param path JSON Pointer or JSONPath expression
+ * @return inja::json const* Pointer to the value inside of the given value or nullptr if not found
+ * @throws std::invalid_argument if the path is malformed
+ */
+inja::json const *find(inja::json const &value, std::string_view path);
+
+/**
+ * @brief Size of an array or an object, length of a string; 0 for everything else
+ */
+std::size_t length(inja::json const &value);
+
+/**
+ * @brief Copies the [begin, end) range of an array; negative indices count from the end
+ */
+inja::json slice(inja::json const &array, std::int64_t begin, std::int64_t end);
+
+/**
+ * @brief Collects the value at path of every element of an array; missing values become null
+ */
+inja::json pluck(inja::json const &array, std::string_view path);
+
+/**
+ * @brief Returns the first element of an array whose value at path equals expected; null if none
+ */
+inja::json find_by(inja::json const &array, std::string_view path, inja::json const &expected);
+
+/**
+ * @brief Sums all numbers of an array (optionally taken at path of each element)
+ *
+ * Numbers encoded as strings (e.g. drops) are accepted too.
+ */
+inja::json sum(inja::json const &array, std::string_view path = "");
+
+/**
+ * @brief Returns a copy of an array stably sorted by the value at path of each element
+ */
+inja::json sort_by(inja::json const &array, std::string_view path);
+
+} // namespace json_query
+} // namespace util
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace util {
+
+/**
+ * @brief Bounded lock-free multi-producer multi-consumer queue
+ *
+ * Based on Dmitry Vyukov's bounded MPMC queue: every cell carries a sequence number that tells
+ * producers and consumers whether the cell is theirs to use, so the only contention is a single
+ * CAS on the enqueue or dequeue position. Neither operation ever blocks.
+ *
+ * @tparam T Needs to be move constructible; does not need to be default constructible
+ */
+template <typename T>
+class RingBuffer {
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T *value() {
+            return std::launder(reinterpret_cast<T *>(storage));
+        }
+    };
+
+    static constexpr std::size_t cache_line = 64;
+
+    std::size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(cache_line) std::atomic<std::size_t> enqueue_pos_ = 0;
+    alignas(cache_line) std::atomic<std::size_t> dequeue_pos_ = 0;
+
+public:
+    /**
+     * @param capacity Rounded up to the next power of two
+     */
+    explicit RingBuffer(std::size_t capacity)
+        : mask_{ std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1 }
+        , cells_{ std::make_unique<Cell[]>(mask_ + 1) } {
+        for(std::size_t i = 0; i <= mask_; ++i)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    ~RingBuffer() {
+        while(try_pop()) { }
+    }
+
+    RingBuffer(RingBuffer const &)            = delete;
+    RingBuffer &operator=(RingBuffer const &) = delete;
+
+    [[nodiscard]] std::size_t capacity() const {
+        return mask_ + 1;
+    }
+
+    /**
+     * @brief Approximate number of elements; exact only when there is no concurrent access
+     */
+    [[nodiscard]] std::size_t size() const {
+        auto const enq = enqueue_pos_.load(std::memory_order_relaxed);
+        auto const deq = dequeue_pos_.load(std::memory_order_relaxed);
+        return enq > deq ? enq - deq : 0;
+    }
+
+    /**
+     * @brief Moves value into the queue unless it is full
+     *
+     * @return true if enqueued; value is left untouched otherwise
+     */
+    [[nodiscard]] bool try_push(T &value) {
+        Cell *cell;
+        auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for(;;) {
+            cell           = &cells_[pos & mask_];
+            auto const seq = cell->sequence.load(std::memory_order_acquire);
+            auto const dif = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+
+            if(dif == 0) {
+                if(enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if(dif < 0) {
+                return false; // full
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        new(cell->storage) T(std::move(value));
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] bool try_push(T &&value) {
+        return try_push(value);
+    }
+
+    /**
+     * @brief Moves the oldest element out of the queue unless it is empty
+     *
+     * @return true if an element was dequeued into out
+     */
+    [[nodiscard]] bool try_pop(T &out) {
+        return pop_with([&out](T &&value) { out = std::move(value); });
+    }
+
+    /**
+     * @brief Removes the oldest element, handing it to fn
+     *
+     * @return true if there was an element
+     */
+    template <typename Fn>
+    [[nodiscard]] bool pop_with(Fn &&fn) {
+        Cell *cell;
+        auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for(;;) {
+            cell           = &cells_[pos & mask_];
+            auto const seq = cell->sequence.load(std::memory_order_acquire);
+            auto const dif = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+
+            if(dif == 0) {
+                if(dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if(dif < 0) {
+                return false; // empty
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        auto *value = cell->value();
+        T taken{ std::move(*value) };
+        value->~T();
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+
+        fn(std::move(taken));
+        return true;
+    }
+
+private:
+    bool try_pop() {
+        return pop_with([](T &&) {});
+    }
+};
+
+} // namespace util
@@ -0,0 +1,38 @@
+#include <util/state_file.hpp>
+
+#include <fmt/format.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <system_error>
+
+namespace util {
+
+bool write_file_atomically(std::filesystem::path const &path, std::initializer_list<std::string_view> parts) {
+    static auto next = std::atomic<std::uint64_t>{ 0 };
+
+    auto tmp = path;
+    tmp += fmt::format(".{}.{}.tmp", ::getpid(), next++);
+    {
+        auto out = std::ofstream{ tmp, std::ios::binary | std::ios::trunc };
+        for(auto part : parts)
+            out.write(part.data(), static_cast<std::streamsize>(part.size()));
+        out.close();
+        if(not out) {
+            auto ec = std::error_code{};
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+    }
+
+    auto ec = std::error_code{};
+    std::filesystem::rename(tmp, path, ec);
+    if(not ec)
+        return true;
+
+    std::filesystem::remove(tmp, ec);
+    return false;
+}
+
+} // namespace util
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <inja/inja.hpp>
+
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <string_view>
+
+namespace util {
+
+/**
+ * @brief Writes the parts into a uniquely named file next to path and renames it over path
+ *
+ * Readers, and other processes or threads writing the same path, never see a partial file.
+ *
+ * @return false if the file could not be written; path is left as it was
+ */
+bool write_file_atomically(std::filesystem::path const &path, std::initializer_list<std::string_view> parts);
+
+inline bool write_file_atomically(std::filesystem::path const &path, std::string_view data) {
+    return write_file_atomically(path, { data });
+}
+
+/**
+ * @brief Reads a JSON state file that an earlier run wrote with the given version
+ *
+ * read is handed the parsed document and returns false to reject it.
+ *
+ * @return false if the file is missing, of another version, corrupt or rejected; the caller starts over
+ */
+template <typename Fn>
+bool load_versioned_json(std::filesystem::path const &path, int version, Fn &&read) {
+    auto in = std::ifstream{ path };
+    if(not in)
+        return false;
+
+    try {
+        auto const document = inja::json::parse(in);
+        return document.at("version").get<int>() == version and read(document);
+    } catch(std::exception const &) {
+        return false;
+    }
+}
+
+} // namespace util
@@ -0,0 +1,18 @@
+#include <util/template_includes.hpp>
+
+#include <regex>
+
+namespace util {
+
+std::vector<TemplateInclude> find_includes(std::string_view source) {
+    static auto const include_re = std::regex{ R"re(\{%-?\s*include\s+"([^"]+)"\s*-?%\})re" };
+
+    auto includes = std::vector<TemplateInclude>{};
+    for(auto it = std::cregex_iterator{ source.data(), source.data() + source.size(), include_re }; it != std::cregex_iterator{}; ++it) {
+        auto const &name = (*it)[1];
+        includes.push_back({ static_cast<std::size_t>(name.first - source.data()), static_cast<std::size_t>(name.length()), name.str() });
+    }
+    return includes;
+}
+
+} // namespace util
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace util {
+
+/**
+ * @brief A `{% include "name" %}` statement found in a template
+ */
+struct TemplateInclude {
+    std::size_t offset; // of the name, without the quotes
+    std::size_t length;
+    std::string name;
+};
+
+/**
+ * @brief All include statements of the given template source, in order of appearance
+ */
+std::vector<TemplateInclude> find_includes(std::string_view source);
+
+} // namespace util
@@ -0,0 +1,454 @@
+#include <util/arena_json.hpp>
+#include <validation/program.hpp>
+#include <validation/regex_cache.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace validation {
+
+namespace {
+
+// threads running chunks for callers that are busy with a chunk of their own; shared by all validations
+// so that nested arrays and concurrent flows together don't start more threads than the hardware runs
+std::atomic<std::size_t> helpers_in_use = 0;
+
+class Helpers {
+    std::size_t count_ = 0;
+
+public:
+    explicit Helpers(std::size_t wanted) {
+        auto const limit = std::size_t{ std::max(1u, std::thread::hardware_concurrency()) };
+        auto used        = helpers_in_use.load();
+        do {
+            count_ = std::min(wanted, limit > used ? limit - used : 0);
+        } while(count_ > 0 and not helpers_in_use.compare_exchange_weak(used, used + count_));
+    }
+
+    ~Helpers() {
+        helpers_in_use -= count_;
+    }
+
+    Helpers(Helpers const &)            = delete;
+    Helpers &operator=(Helpers const &) = delete;
+
+    std::size_t count() const {
+        return count_;
+    }
+};
+
+// splits [0, size) into chunks processed concurrently; issues are merged in order.
+// the caller takes the first chunk and runs everything itself when no helper is free
+template <typename Fn>
+void for_each_chunk(std::size_t size, Program::issues_vec_t &issues, Fn &&fn) {
+    auto const wanted  = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), size / Program::parallel_threshold);
+    auto const helpers = Helpers{ wanted > 1 ? wanted - 1 : 0 };
+    if(helpers.count() == 0)
+        return fn(0, size, issues);
+
+    auto const workers = helpers.count() + 1;
+    auto const chunk   = (size + workers - 1) / workers;
+    std::vector<std::future<Program::issues_vec_t>> results;
+    for(std::size_t begin = chunk; begin < size; begin += chunk) {
+        results.push_back(std::async(std::launch::async, [&fn, begin, end = std::min(size, begin + chunk)] {
+            Program::issues_vec_t chunk_issues;
+            fn(begin, end, chunk_issues);
+            return chunk_issues;
+        }));
+    }
+
+    fn(0, chunk, issues);
+    for(auto &result : results) {
+        auto chunk_issues = result.get();
+        std::move(std::begin(chunk_issues), std::end(chunk_issues), std::back_inserter(issues));
+    }
+}
+
+template <typename Json>
+std::optional<long double> as_number(Json const &value) {
+    if(value.is_number_unsigned())
+        return value.template get<std::uint64_t>();
+    if(value.is_number_integer())
+        return value.template get<std::int64_t>();
+    if(value.is_number_float())
+        return value.template get<double>();
+    if(value.is_string()) {
+        // amounts such as drops are usually sent as strings
+        auto const &str = value.template get_ref<typename Json::string_t const &>();
+        long double parsed;
+        auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), parsed);
+        if(ec == std::errc{} and ptr == str.data() + str.size())
+            return parsed;
+    }
+    return std::nullopt;
+}
+
+template <typename Json>
+std::optional<std::size_t> length_of(Json const &value) {
+    if(value.is_string())
+        return value.template get_ref<typename Json::string_t const &>().size();
+    if(value.is_array() or value.is_object())
+        return value.size();
+    return std::nullopt;
+}
+
+// consistent with operator== where 1 == 1.0, which nlohmann::detail::hash is not as it hashes
+// integers and floats differently; so every number is hashed as a double
+template <typename Json>
+std::size_t hash_of(Json const &value) {
+    auto const combine = [](std::size_t seed, std::size_t hash) {
+        return seed ^ (hash + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+    };
+
+    switch(value.type()) {
+    case nlohmann::detail::value_t::number_integer:
+    case nlohmann::detail::value_t::number_unsigned:
+    case nlohmann::detail::value_t::number_float:
+        return std::hash<double>{}(value.template get<double>());
+    case nlohmann::detail::value_t::array: {
+        auto seed = combine(value.size(), 1);
+        for(auto const &element : value)
+            seed = combine(seed, hash_of(element));
+        return seed;
+    }
+    case nlohmann::detail::value_t::object: {
+        auto seed = combine(value.size(), 2);
+        for(auto it = value.begin(); it != value.end(); ++it)
+            seed = combine(combine(seed, std::hash<std::string_view>{}(it.key())), hash_of(*it));
+        return seed;
+    }
+    default:
+        return nlohmann::detail::hash(value);
+    }
+}
+
+} // namespace
+
+template <typename Json>
+BasicProgram<Json>::BasicProgram(Json const &expectations) {
+    nodes_.emplace_back();
+    compile(0, expectations);
+}
+
+template <typename Json>
+void BasicProgram<Json>::compile(std::uint32_t idx, Json const &expectations) {
+    // nodes_ grows while compiling matchers and objects, so no reference into it is held across that
+    nodes_[idx].expected = &expectations;
+
+    if(expectations.is_null() or expectations.empty()) {
+        nodes_[idx].op = Op::SKIP;
+    } else if(compile_matcher(idx, expectations)) {
+        return;
+    } else if(expectations.is_object()) {
+        // reserve a contiguous range for the children first, then compile each of them
+        auto const first        = static_cast<std::uint32_t>(nodes_.size());
+        nodes_[idx].op          = Op::OBJECT;
+        nodes_[idx].first_child = first;
+        nodes_[idx].child_count = static_cast<std::uint32_t>(expectations.size());
+        nodes_.resize(nodes_.size() + expectations.size());
+
+        auto child = first;
+        for(auto it = expectations.begin(); it != expectations.end(); ++it, ++child) {
+            nodes_[child].key = &it.key();
+            compile(child, it.value());
+        }
+    } else if(expectations.is_string() and expectations.template get_ref<string_t const &>().starts_with("$")) {
+        // check our filters, like "$bool" should pass if the actual type received is a bool
+        auto &node      = nodes_[idx];
+        auto const &val = expectations.template get_ref<string_t const &>();
+        if(val == "$bool") {
+            node.op = Op::IS_BOOL;
+        } else if(val == "$string") {
+            node.op = Op::IS_STRING;
+        } else if(val.starts_with("$array=")) {
+            node.op   = Op::IS_ARRAY_OF_SIZE;
+            node.size = std::strtoull(val.c_str() + 7, nullptr, 10);
+        } else if(val == "$array") {
+            node.op = Op::IS_ARRAY;
+        } else if(val == "$double") {
+            node.op = Op::IS_DOUBLE;
+        } else if(val == "$int") {
+            node.op = Op::IS_INT;
+        } else if(val == "$uint") {
+            node.op = Op::IS_UINT;
+        } else if(val == "$object") {
+            node.op = Op::IS_OBJECT;
+        } else {
+            node.op = Op::EQUAL;
+        }
+    } else {
+        nodes_[idx].op = Op::EQUAL;
+    }
+}
+
+template <typename Json>
+bool BasicProgram<Json>::compile_matcher(std::uint32_t idx, Json const &expectations) {
+    if(not expectations.is_object() or expectations.size() != 1)
+        return false;
+
+    auto const it   = expectations.begin();
+    auto const &key = it.key();
+    if(key == "$each") {
+        auto const child        = static_cast<std::uint32_t>(nodes_.size());
+        nodes_[idx].op          = Op::EACH;
+        nodes_[idx].first_child = child;
+        nodes_[idx].child_count = 1;
+        nodes_.emplace_back();
+        compile(child, it.value());
+        return true;
+    }
+
+    if(key == "$unordered" or key == "$contains") {
+        if(not it.value().is_array())
+            throw std::invalid_argument{ fmt::format("{} expects an array", key) };
+        nodes_[idx].op = key == "$unordered" ? Op::UNORDERED : Op::CONTAINS;
+        return true;
+    }
+
+    if(key == "$regex") {
+        if(not it.value().is_string())
+            throw std::invalid_argument{ "$regex expects a string" };
+        nodes_[idx].op    = Op::REGEX;
+        nodes_[idx].regex = RegexCache::instance().get(it.value().template get_ref<string_t const &>());
+        return true;
+    }
+
+    if(key == "$range" or key == "$length") {
+        nodes_[idx].op = key == "$range" ? Op::RANGE : Op::LENGTH;
+        compile_bounds(idx, key, it.value());
+        return true;
+    }
+
+    return false;
+}
+
+template <typename Json>
+void BasicProgram<Json>::compile_bounds(std::uint32_t idx, std::string_view name, Json const &bounds) {
+    auto &node = nodes_[idx];
+    if(node.op == Op::LENGTH and bounds.is_number_unsigned()) {
+        node.min = node.max = bounds.template get<std::uint64_t>();
+        return;
+    }
+
+    if(not bounds.is_array() or bounds.size() != 2)
+        throw std::invalid_argument{ fmt::format("{} expects [min, max]", name) };
+
+    // null means there is no bound on that side
+    auto bound = [&name](Json const &value, long double unbounded) {
+        if(value.is_null())
+            return unbounded;
+        if(auto number = as_number(value); number)
+            return *number;
+        throw std::invalid_argument{ fmt::format("{} bound {} is not a number", name, value.dump()) };
+    };
+
+    node.min = bound(bounds[0], node.min);
+    node.max = bound(bounds[1], node.max);
+}
+
+template <typename Json>
+void BasicProgram<Json>::run(Json const &incoming, issues_vec_t &issues) const {
+    run(root(), incoming, nullptr, issues);
+}
+
+template <typename Json>
+void BasicProgram<Json>::run(Node const &node, Json const &value, Frame const *frame, issues_vec_t &issues) const {
+    switch(node.op) {
+    case Op::SKIP:
+        return;
+    case Op::OBJECT: {
+        auto const *child = children(node);
+        for(auto const *end = child + node.child_count; child != end; ++child) {
+            auto const it = value.is_object() ? value.find(*child->key) : value.end();
+            if(it == value.end()) {
+                report_missing(*child, frame, issues);
+                continue;
+            }
+
+            auto const next = Frame{ frame, child->key };
+            run(*child, *it, &next, issues);
+        }
+        return;
+    }
+    case Op::EACH:
+        if(value.is_array())
+            return run_each(node, value, frame, issues);
+        return report_mismatch(node, value, frame, issues);
+    case Op::UNORDERED:
+    case Op::CONTAINS:
+        if(value.is_array())
+            return run_unordered(node, value, frame, issues);
+        return report_mismatch(node, value, frame, issues);
+    default:
+        if(not matches(node, value))
+            report_mismatch(node, value, frame, issues);
+    }
+}
+
+template <typename Json>
+bool BasicProgram<Json>::matches(Node const &node, Json const &value) {
+    switch(node.op) {
+    case Op::SKIP:
+        return true;
+    case Op::OBJECT:
+        return value.is_object();
+    case Op::EQUAL:
+        return *node.expected == value;
+    case Op::IS_BOOL:
+        return value.is_boolean();
+    case Op::IS_STRING:
+        return value.is_string();
+    case Op::IS_ARRAY:
+        return value.is_array();
+    case Op::IS_ARRAY_OF_SIZE:
+        return value.is_array() and value.size() == node.size;
+    case Op::IS_DOUBLE:
+        return value.is_number_float();
+    case Op::IS_INT:
+        return value.is_number_integer();
+    case Op::IS_UINT:
+        return value.is_number_unsigned();
+    case Op::IS_OBJECT:
+        return value.is_object();
+    case Op::EACH:
+    case Op::UNORDERED:
+    case Op::CONTAINS:
+        return value.is_array();
+    case Op::REGEX:
+        return value.is_string() and std::regex_match(value.template get_ref<string_t const &>(), *node.regex);
+    case Op::RANGE: {
+        auto const number = as_number(value);
+        return number and *number >= node.min and *number <= node.max;
+    }
+    case Op::LENGTH: {
+        auto const length = length_of(value);
+        return length and *length >= node.min and *length <= node.max;
+    }
+    }
+    return false;
+}
+
+template <typename Json>
+void BasicProgram<Json>::run_each(Node const &node, Json const &value, Frame const *frame, issues_vec_t &issues) const {
+    auto const &shape = *children(node);
+    for_each_chunk(value.size(), issues, [&, this](std::size_t begin, std::size_t end, issues_vec_t &out) {
+        for(auto i = begin; i < end; ++i) {
+            auto const next = Frame{ frame, nullptr, i };
+            run(shape, value[i], &next, out);
+        }
+    });
+}
+
+template <typename Json>
+void BasicProgram<Json>::run_unordered(Node const &node, Json const &value, Frame const *frame, issues_vec_t &issues) const {
+    struct Entry {
+        Json const *element;
+        std::size_t remaining;
+    };
+
+    auto const hash      = [](Json const &element) { return hash_of(element); };
+    auto const &expected = node.expected->begin().value();
+
+    // hash -> distinct expected elements with that hash and how many of each are still unmatched
+    std::unordered_map<std::size_t, std::vector<Entry>> index;
+    index.reserve(expected.size());
+    for(auto const &element : expected) {
+        auto &bucket = index[hash(element)];
+        auto it      = std::find_if(std::begin(bucket), std::end(bucket), [&element](Entry const &e) { return *e.element == element; });
+        if(it == std::end(bucket))
+            bucket.push_back({ &element, 1 });
+        else
+            ++it->remaining;
+    }
+
+    // hashing is the expensive part on big arrays so it's done in parallel chunks
+    std::vector<std::size_t> hashes(value.size());
+    issues_vec_t unused;
+    for_each_chunk(value.size(), unused, [&](std::size_t begin, std::size_t end, issues_vec_t &) {
+        for(auto i = begin; i < end; ++i)
+            hashes[i] = hash(value[i]);
+    });
+
+    for(std::size_t i = 0; i < value.size(); ++i) {
+        auto const &element = value[i];
+        auto bucket         = index.find(hashes[i]);
+        auto matched        = false;
+        if(bucket != std::end(index)) {
+            for(auto &entry : bucket->second) {
+                if(entry.remaining > 0 and *entry.element == element) {
+                    --entry.remaining;
+                    matched = true;
+                    break;
+                }
+            }
+        }
+
+        if(not matched and node.op == Op::UNORDERED) {
+            auto const next = Frame{ frame, nullptr, i };
+            issues.emplace_back(FailureEvent::Data::Type::NOT_EQUAL, path_of(&next),
+                fmt::format("Unexpected element {}", element.dump()));
+        }
+    }
+
+    // walk the expectations again so that the order of reported issues is stable
+    for(auto const &element : expected) {
+        for(auto const &entry : index[hash(element)]) {
+            if(entry.element == &element and entry.remaining > 0)
+                issues.emplace_back(FailureEvent::Data::Type::NO_MATCH, path_of(frame),
+                    fmt::format("Expected element {} is missing ({} time(s))", element.dump(), entry.remaining));
+        }
+    }
+}
+
+template <typename Json>
+void BasicProgram<Json>::report_mismatch(Node const &node, Json const &value, Frame const *frame, issues_vec_t &issues) {
+    if(node.op == Op::EQUAL and not(node.expected->is_string() and node.expected->template get_ref<string_t const &>().starts_with("$")))
+        issues.emplace_back(FailureEvent::Data::Type::NOT_EQUAL, path_of(frame),
+            fmt::format("{} != {}", node.expected->dump(), value.dump()));
+    else
+        issues.emplace_back(FailureEvent::Data::Type::TYPE_CHECK, path_of(frame),
+            fmt::format("{} is not met for value '{}'", node.expected->dump(), value.dump()));
+}
+
+template <typename Json>
+void BasicProgram<Json>::report_missing(Node const &node, Frame const *frame, issues_vec_t &issues) {
+    auto const next = Frame{ frame, node.key };
+    issues.emplace_back(FailureEvent::Data::Type::NO_MATCH, path_of(&next), "Key is not present in the response");
+}
+
+template <typename Json>
+std::string BasicProgram<Json>::path_of(Frame const *frame) {
+    std::vector<Frame const *> frames;
+    for(; frame != nullptr; frame = frame->parent)
+        frames.push_back(frame);
+
+    std::string path;
+    for(auto it = frames.rbegin(); it != frames.rend(); ++it) {
+        if((*it)->key == nullptr) {
+            path += fmt::format("[{}]", (*it)->index);
+        } else {
+            if(not path.empty())
+                path += '.';
+            path += std::string_view{ *(*it)->key };
+        }
+    }
+    return path;
+}
+
+template class BasicProgram<inja::json>;
+template class BasicProgram<util::ArenaJson>;
+
+} // namespace validation
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <reporting/events.hpp>
+#include <util/arena.hpp>
+#include <util/arena_json.hpp>
+
+#include <inja/inja.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace validation {
+
+/**
+ * @brief Expectations compiled into a flat matcher program
+ *
+ * Every expectation is classified exactly once. Nodes are stored in a single vector with all children
+ * of an object stored contiguously (in key order). Keys are not copied; they point into the expectations
+ * which therefore must outlive the program. Paths are only reconstructed when an issue is raised.
+ *
+ * Array-wide matchers are objects with a single key: `{"$each": shape}`, `{"$unordered": [...]}` and
+ * `{"$contains": [...]}`. The latter two compare elements by hash and equality. Arrays of at least
+ * parallel_threshold elements are processed in parallel chunks.
+ *
+ * Scalar matchers use the same form: `{"$regex": "..."}`, `{"$range": [min, max]}` and
+ * `{"$length": n}` or `{"$length": [min, max]}`. Their arguments are validated and regexes are
+ * compiled (once while the pattern stays in RegexCache) when the program is built.
+ *
+ * Nodes are allocated through ArenaAllocator and end up in the arena of the step if there is one.
+ *
+ * @tparam Json Type of both the expectations and the incoming document
+ */
+template <typename Json>
+class BasicProgram {
+public:
+    using json_t   = Json;
+    using string_t = typename Json::string_t;
+
+    enum class Op : std::uint8_t {
+        SKIP, // null or empty expectation, anything goes
+        OBJECT,
+        EQUAL,
+        IS_BOOL,
+        IS_STRING,
+        IS_ARRAY,
+        IS_ARRAY_OF_SIZE,
+        IS_DOUBLE,
+        IS_INT,
+        IS_UINT,
+        IS_OBJECT,
+        EACH,      // the only child is matched against every element
+        UNORDERED, // same elements regardless of order
+        CONTAINS,  // all expected elements present regardless of order
+        REGEX,     // string fully matching the regex
+        RANGE,     // number (or numeric string) within [min, max]
+        LENGTH     // string, array or object with size within [min, max]
+    };
+
+    struct Node {
+        Op op                     = Op::SKIP;
+        std::uint32_t first_child = 0;
+        std::uint32_t child_count = 0;
+        string_t const *key       = nullptr; // interned, points into the expectations
+        Json const *expected      = nullptr;
+        std::size_t size          = 0;
+        long double min           = std::numeric_limits<long double>::lowest();
+        long double max           = std::numeric_limits<long double>::max();
+        std::shared_ptr<std::regex const> regex; // shared with RegexCache, stays valid when evicted there
+    };
+
+    /**
+     * @brief Runtime trail used to lazily rebuild the path of an issue
+     */
+    struct Frame {
+        Frame const *parent = nullptr;
+        string_t const *key = nullptr; // nullptr means array element at index
+        std::size_t index   = 0;
+    };
+
+    using issues_vec_t = std::vector<FailureEvent::Data>;
+
+    static constexpr std::size_t parallel_threshold = 4096;
+
+    explicit BasicProgram(Json const &expectations);
+
+    /**
+     * @brief Matches incoming against the program and appends all found issues
+     *
+     * @param incoming
+     * @param issues
+     */
+    void run(Json const &incoming, issues_vec_t &issues) const;
+
+    /**
+     * @brief Matches value against a single node and its children
+     */
+    void run(Node const &node, Json const &value, Frame const *frame, issues_vec_t &issues) const;
+
+    /**
+     * @brief Checks a scalar or type node against value without descending
+     */
+    static bool matches(Node const &node, Json const &value);
+
+    /**
+     * @brief Appends the issue raised when value does not match node
+     */
+    static void report_mismatch(Node const &node, Json const &value, Frame const *frame, issues_vec_t &issues);
+
+    /**
+     * @brief Appends the issue raised when the key of node is absent
+     */
+    static void report_missing(Node const &node, Frame const *frame, issues_vec_t &issues);
+
+    static std::string path_of(Frame const *frame);
+
+    Node const &root() const {
+        return nodes_.front();
+    }
+
+    Node const *children(Node const &node) const {
+        return nodes_.data() + node.first_child;
+    }
+
+private:
+    void compile(std::uint32_t idx, Json const &expectations);
+    bool compile_matcher(std::uint32_t idx, Json const &expectations);
+    void compile_bounds(std::uint32_t idx, std::string_view name, Json const &bounds);
+
+    void run_each(Node const &node, Json const &value, Frame const *frame, issues_vec_t &issues) const;
+    void run_unordered(Node const &node, Json const &value, Frame const *frame, issues_vec_t &issues) const;
+
+    std::vector<Node, util::ArenaAllocator<Node>> nodes_;
+};
+
+using Program      = BasicProgram<inja::json>;
+using ArenaProgram = BasicProgram<util::ArenaJson>;
+
+extern template class BasicProgram<inja::json>;
+extern template class BasicProgram<util::ArenaJson>;
+
+} // namespace validation
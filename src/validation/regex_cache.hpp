@@ -0,0 +1,79 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <string>
+#include <string_view>
+
+namespace validation {
+
+/**
+ * @brief Process-wide cache of compiled regular expressions
+ *
+ * Expectations are rendered again for every response, but the same patterns keep coming back.
+ * Compiling a std::regex is far more expensive than matching it, so patterns are compiled once
+ * and kept. Templates that render a new pattern for every response would grow the cache without
+ * bound, so it holds at most capacity patterns and evicts the least recently used one. Programs
+ * share ownership of their regexes, an evicted pattern stays valid for as long as they use it.
+ */
+class RegexCache {
+public:
+    using regex_ptr_t = std::shared_ptr<std::regex const>;
+
+    static constexpr std::size_t default_capacity = 1024;
+
+private:
+    struct Entry {
+        regex_ptr_t regex;
+        std::list<std::string_view>::iterator used;
+    };
+
+    std::mutex mtx_;
+    std::size_t capacity_;
+    std::map<std::string, Entry, std::less<>> cache_; // looked up without copying the pattern
+    std::list<std::string_view> lru_;                 // keys of cache_, most recently used first
+
+public:
+    explicit RegexCache(std::size_t capacity = default_capacity)
+        : capacity_{ std::max<std::size_t>(capacity, 1) } { }
+
+    static RegexCache &instance() {
+        static RegexCache cache;
+        return cache;
+    }
+
+    /**
+     * @brief Returns the compiled regex for pattern; throws std::regex_error if the pattern is invalid
+     */
+    regex_ptr_t get(std::string_view pattern) {
+        std::scoped_lock l{ mtx_ };
+        if(auto it = cache_.find(pattern); it != std::end(cache_)) {
+            lru_.splice(std::begin(lru_), lru_, it->second.used);
+            return it->second.regex;
+        }
+
+        auto regex = std::make_shared<std::regex const>(std::begin(pattern), std::end(pattern), std::regex::ECMAScript | std::regex::optimize);
+        if(cache_.size() == capacity_) {
+            cache_.erase(cache_.find(lru_.back()));
+            lru_.pop_back();
+        }
+
+        auto it = cache_.emplace(std::string{ pattern }, Entry{ std::move(regex), {} }).first;
+        lru_.push_front(it->first);
+        it->second.used = std::begin(lru_);
+        return it->second.regex;
+    }
+
+    std::size_t size() {
+        std::scoped_lock l{ mtx_ };
+        return cache_.size();
+    }
+};
+
+} // namespace validation
@@ -0,0 +1,303 @@
+#include <validation/streaming.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <charconv>
+#include <string>
+#include <string_view>
+
+namespace validation {
+
+StreamingValidator::StreamingValidator(Program const &program, captures_t const &captures)
+    : program_{ program } {
+    for(auto const &[var, pointer] : captures) {
+        auto *node = &captures_;
+        auto rest  = std::string_view{ pointer };
+
+        while(not rest.empty()) {
+            rest.remove_prefix(1); // leading '/'
+            auto const end = rest.find('/');
+            auto raw       = rest.substr(0, end);
+            rest           = end == std::string_view::npos ? std::string_view{} : rest.substr(end);
+
+            std::string token;
+            for(std::size_t i = 0; i < raw.size(); ++i) {
+                if(raw[i] == '~' and i + 1 < raw.size()) {
+                    token += raw[i + 1] == '1' ? '/' : '~';
+                    ++i;
+                } else {
+                    token += raw[i];
+                }
+            }
+            node = &node->children[token];
+        }
+        node->var = var;
+    }
+}
+
+void StreamingValidator::run(std::string_view input, issues_vec_t &issues, inja::json &store) {
+    issues_     = &issues;
+    store_      = &store;
+    skip_depth_ = 0;
+    levels_.clear();
+    builders_.clear();
+
+    inja::json::sax_parse(input.begin(), input.end(), this);
+}
+
+StreamingValidator::Slot StreamingValidator::next_slot() {
+    if(levels_.empty())
+        return Slot{ &program_.root(), &captures_, {}, true };
+
+    auto &level = levels_.back();
+    if(not level.is_array)
+        return std::exchange(level.pending, Slot{});
+
+    auto slot  = Slot{};
+    slot.frame = Program::Frame{ level.self.frame_ptr(), nullptr, level.index };
+    if(level.self.capture) {
+        char buf[24];
+        auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), level.index);
+        auto it        = level.self.capture->children.find(std::string_view{ buf, static_cast<std::size_t>(end - buf) });
+        if(it != level.self.capture->children.end())
+            slot.capture = &it->second;
+    }
+    ++level.index;
+    return slot;
+}
+
+void StreamingValidator::on_scalar(inja::json &&value) {
+    feed_scalar(value);
+    if(skip_depth_ > 0)
+        return;
+
+    auto const slot = next_slot();
+    if(slot.node)
+        program_.run(*slot.node, value, slot.frame_ptr(), *issues_);
+    if(slot.capture and slot.capture->var)
+        (*store_)[*slot.capture->var] = std::move(value);
+}
+
+void StreamingValidator::on_start(bool is_array) {
+    feed_start(is_array);
+    if(skip_depth_ > 0) {
+        ++skip_depth_;
+        return;
+    }
+
+    auto slot                  = next_slot();
+    Program::Node const *track = nullptr;
+
+    if(slot.node) {
+        switch(slot.node->op) {
+        case Program::Op::SKIP:
+            break;
+        case Program::Op::OBJECT:
+            if(is_array)
+                report_all_missing(*slot.node, slot.frame_ptr());
+            else
+                track = slot.node;
+            break;
+        case Program::Op::IS_ARRAY:
+            if(not is_array)
+                start_builder(slot, is_array, slot.node, nullptr); // only materialized for the report
+            break;
+        case Program::Op::IS_OBJECT:
+            if(is_array)
+                start_builder(slot, is_array, slot.node, nullptr);
+            break;
+        default:
+            start_builder(slot, is_array, slot.node, nullptr);
+        }
+    }
+
+    if(slot.capture and slot.capture->var)
+        start_builder(slot, is_array, nullptr, &*slot.capture->var);
+
+    auto const capture_children = slot.capture and not slot.capture->children.empty();
+    if(not track and not capture_children) {
+        skip_depth_ = 1; // nothing to look for inside; builders still see everything
+        return;
+    }
+
+    slot.node    = track;
+    slot.capture = capture_children ? slot.capture : nullptr;
+
+    auto &level    = levels_.emplace_back();
+    level.self     = slot;
+    level.is_array = is_array;
+    if(track)
+        level.seen.resize(track->child_count);
+}
+
+void StreamingValidator::on_end() {
+    feed_end();
+    if(skip_depth_ > 0) {
+        --skip_depth_;
+        return;
+    }
+
+    auto const &level = levels_.back();
+    if(level.self.node) {
+        auto const *children = program_.children(*level.self.node);
+        for(std::size_t i = 0; i < level.seen.size(); ++i) {
+            if(not level.seen[i])
+                Program::report_missing(children[i], level.self.frame_ptr(), *issues_);
+        }
+    }
+    levels_.pop_back();
+}
+
+void StreamingValidator::start_builder(Slot const &slot, bool is_array, Program::Node const *node, std::string const *var) {
+    auto &builder = builders_.emplace_back();
+    builder.value = is_array ? inja::json::array() : inja::json::object();
+    builder.stack.push_back(&builder.value);
+    builder.node = node;
+    builder.var  = var;
+    builder.slot = slot;
+}
+
+void StreamingValidator::feed_start(bool is_array) {
+    for(auto &builder : builders_) {
+        auto &top   = *builder.stack.back();
+        auto child  = is_array ? inja::json::array() : inja::json::object();
+        auto &added = top.is_array() ? top.emplace_back(std::move(child)) : (top[builder.key] = std::move(child));
+        builder.stack.push_back(&added);
+    }
+}
+
+void StreamingValidator::feed_scalar(inja::json const &value) {
+    for(auto &builder : builders_) {
+        auto &top = *builder.stack.back();
+        if(top.is_array())
+            top.push_back(value);
+        else
+            top[builder.key] = value;
+    }
+}
+
+void StreamingValidator::feed_end() {
+    for(auto &builder : builders_) {
+        builder.stack.pop_back();
+        builder.done = builder.stack.empty();
+    }
+    finish_builders();
+}
+
+void StreamingValidator::finish_builders() {
+    for(auto it = builders_.begin(); it != builders_.end();) {
+        if(not it->done) {
+            ++it;
+            continue;
+        }
+        finish(*it);
+        it = builders_.erase(it);
+    }
+}
+
+void StreamingValidator::finish(Builder &builder) {
+    if(builder.node)
+        program_.run(*builder.node, builder.value, builder.slot.frame_ptr(), *issues_);
+    if(builder.var)
+        (*store_)[*builder.var] = std::move(builder.value);
+}
+
+void StreamingValidator::report_all_missing(Program::Node const &node, Program::Frame const *frame) {
+    auto const *children = program_.children(node);
+    for(std::size_t i = 0; i < node.child_count; ++i)
+        Program::report_missing(children[i], frame, *issues_);
+}
+
+bool StreamingValidator::null() {
+    on_scalar(nullptr);
+    return true;
+}
+
+bool StreamingValidator::boolean(bool value) {
+    on_scalar(value);
+    return true;
+}
+
+bool StreamingValidator::number_integer(inja::json::number_integer_t value) {
+    on_scalar(value);
+    return true;
+}
+
+bool StreamingValidator::number_unsigned(inja::json::number_unsigned_t value) {
+    on_scalar(value);
+    return true;
+}
+
+bool StreamingValidator::number_float(inja::json::number_float_t value, inja::json::string_t const &) {
+    on_scalar(value);
+    return true;
+}
+
+bool StreamingValidator::string(inja::json::string_t &value) {
+    if(skip_depth_ > 0 and builders_.empty())
+        return true; // don't even wrap skipped strings into values
+    on_scalar(std::move(value));
+    return true;
+}
+
+bool StreamingValidator::binary(inja::json::binary_t &value) {
+    on_scalar(inja::json::binary(std::move(value)));
+    return true;
+}
+
+bool StreamingValidator::start_object(std::size_t) {
+    on_start(false);
+    return true;
+}
+
+bool StreamingValidator::key(inja::json::string_t &value) {
+    for(auto &builder : builders_)
+        builder.key = value;
+    if(skip_depth_ > 0)
+        return true;
+
+    auto &level   = levels_.back();
+    level.pending = Slot{};
+
+    if(auto const *node = level.self.node; node) {
+        auto const *first = program_.children(*node);
+        auto const *last  = first + node->child_count;
+        auto const *child = std::lower_bound(first, last, value, [](Program::Node const &n, std::string const &k) {
+            return *n.key < k;
+        });
+        if(child != last and *child->key == value) {
+            level.seen[child - first] = true;
+            level.pending.node        = child;
+            level.pending.frame       = Program::Frame{ level.self.frame_ptr(), child->key };
+        }
+    }
+
+    if(auto const *capture = level.self.capture; capture) {
+        if(auto it = capture->children.find(value); it != capture->children.end())
+            level.pending.capture = &it->second;
+    }
+    return true;
+}
+
+bool StreamingValidator::end_object() {
+    on_end();
+    return true;
+}
+
+bool StreamingValidator::start_array(std::size_t) {
+    on_start(true);
+    return true;
+}
+
+bool StreamingValidator::end_array() {
+    on_end();
+    return true;
+}
+
+bool StreamingValidator::parse_error(std::size_t position, std::string const &last_token, inja::json::exception const &ex) {
+    issues_->emplace_back(FailureEvent::Data::Type::LOGIC_ERROR, "", fmt::format("Response is not valid JSON: {}", ex.what()));
+    return false;
+}
+
+} // namespace validation
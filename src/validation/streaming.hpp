@@ -0,0 +1,121 @@
+#pragma once
+
+#include <validation/program.hpp>
+
+#include <inja/inja.hpp>
+
+#include <deque>
+#include <list>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace validation {
+
+/**
+ * @brief Validates raw JSON text against a compiled Program without building the full DOM
+ *
+ * The input is consumed through nlohmann's SAX interface. Subtrees that are neither expected
+ * nor requested via captures are skipped without allocating any values. Only the subtrees that
+ * need a full comparison (literal values, `$array=N` checks, failed type checks) are materialized.
+ */
+class StreamingValidator {
+public:
+    using issues_vec_t = Program::issues_vec_t;
+    using captures_t   = std::map<std::string, std::string>; // variable -> JSON pointer
+
+    /**
+     * @param program The compiled expectations
+     * @param captures JSON pointers of values to materialize into the store along the way
+     */
+    StreamingValidator(Program const &program, captures_t const &captures);
+
+    /**
+     * @brief Validates the input, appending found issues and storing captured values
+     *
+     * @param input Raw JSON text
+     * @param issues
+     * @param store Receives captured values under the configured variable names
+     */
+    void run(std::string_view input, issues_vec_t &issues, inja::json &store);
+
+    // nlohmann SAX interface
+    bool null();
+    bool boolean(bool value);
+    bool number_integer(inja::json::number_integer_t value);
+    bool number_unsigned(inja::json::number_unsigned_t value);
+    bool number_float(inja::json::number_float_t value, inja::json::string_t const &);
+    bool string(inja::json::string_t &value);
+    bool binary(inja::json::binary_t &value);
+    bool start_object(std::size_t);
+    bool key(inja::json::string_t &value);
+    bool end_object();
+    bool start_array(std::size_t);
+    bool end_array();
+    bool parse_error(std::size_t position, std::string const &last_token, inja::json::exception const &ex);
+
+private:
+    struct CaptureNode {
+        std::map<std::string, CaptureNode, std::less<>> children;
+        std::optional<std::string> var;
+    };
+
+    // where the next value goes: what is expected there and what is captured from there
+    struct Slot {
+        Program::Node const *node  = nullptr;
+        CaptureNode const *capture = nullptr;
+        Program::Frame frame       = {};
+        bool is_root               = false;
+
+        Program::Frame const *frame_ptr() const {
+            return is_root ? nullptr : &frame;
+        }
+    };
+
+    // an open object or array that is being tracked
+    struct Level {
+        Slot self;
+        bool is_array          = false;
+        std::size_t index      = 0;
+        std::vector<bool> seen = {};
+        Slot pending           = {};
+    };
+
+    // materializes one subtree, then either stores or matches it
+    struct Builder {
+        inja::json value;
+        std::vector<inja::json *> stack = {};
+        std::string key                 = {};
+        std::string const *var          = nullptr;
+        Program::Node const *node       = nullptr;
+        Slot slot                       = {};
+        bool done                       = false;
+    };
+
+    Slot next_slot();
+    void on_scalar(inja::json &&value);
+    void on_start(bool is_array);
+    void on_end();
+    void start_builder(Slot const &slot, bool is_array, Program::Node const *node, std::string const *var);
+
+    void feed_start(bool is_array);
+    void feed_scalar(inja::json const &value);
+    void feed_end();
+    void finish_builders();
+    void finish(Builder &builder);
+    void report_all_missing(Program::Node const &node, Program::Frame const *frame);
+
+    Program const &program_;
+    CaptureNode captures_;
+
+    issues_vec_t *issues_ = nullptr;
+    inja::json *store_    = nullptr;
+
+    std::deque<Level> levels_;
+    std::list<Builder> builders_; // builders point into themselves, must not move
+    std::size_t skip_depth_ = 0;
+};
+
+} // namespace validation
@@ -1,28 +1,49 @@
 #pragma once
 
 #include <reporting/events.hpp>
+#include <util/arena_json.hpp>
 
 #include <fmt/compile.h>
 #include <inja/inja.hpp>
 
+#include <map>
+#include <string>
+#include <string_view>
 #include <vector>
 
 class Validator {
-    using issues_vec_t   = std::vector<FailureEvent::Data>;
-    issues_vec_t issues_ = {};
-    bool is_valid_       = true;
-
 public:
+    using issues_vec_t = std::vector<FailureEvent::Data>;
+    using captures_t   = std::map<std::string, std::string>;
+
     /**
-     * @brief 
-     * 
-     * @param expectations 
-     * @param incoming 
-     * @return std::pair<bool, issues_vec_t> 
+     * @brief Validates incoming data against the given expectations
+     *
+     * The expectations are compiled into a validation::Program which is then run over incoming once.
+     *
+     * @param expectations
+     * @param incoming
+     * @return std::pair<bool, issues_vec_t>
      */
     std::pair<bool, issues_vec_t> validate(inja::json const &expectations, inja::json const &incoming);
 
-private:
-    void do_validate(std::string path, inja::json const &expectations, inja::json const &incoming);
-    void add_issue(FailureEvent::Data::Type type, std::string const &path, std::string const &message);
+    /**
+     * @brief Same as above for documents that live in the arena of the current step
+     *
+     * The issues are regular strings since they outlive the step with the FlowException.
+     */
+    std::pair<bool, issues_vec_t> validate(util::ArenaJson const &expectations, util::ArenaJson const &incoming);
+
+    /**
+     * @brief Validates raw incoming JSON text without parsing it into a DOM
+     *
+     * Only the values at the JSON pointers listed in captures are materialized and saved into the store.
+     *
+     * @param expectations
+     * @param incoming Raw JSON text
+     * @param captures Variable name to JSON pointer of the value to store
+     * @param store
+     * @return std::pair<bool, issues_vec_t>
+     */
+    std::pair<bool, issues_vec_t> validate_stream(inja::json const &expectations, std::string_view incoming, captures_t const &captures, inja::json &store);
 };
@@ -1,3 +1,6 @@
+#include <metrics/registry.hpp>
+#include <metrics/usage.hpp>
+#include <trace/tracer.hpp>
 #include <util/async_queue.hpp>
 #include <web/async_connection_pool.hpp>
 #include <web/web_socket_session.hpp>
@@ -11,13 +14,17 @@
 #include <thread>
 #include <vector>
 
-AsyncConnectionPool::AsyncConnectionPool(std::string const &host, std::string const &port)
+AsyncConnectionPool::AsyncConnectionPool(std::string const &host, std::string const &port, std::size_t size)
     : work_{ ctx_.get_executor() }
-    , available_pool_{ 4, [](std::shared_ptr<WebSocketSession> &ses) { ses->close(); } } {
+    , available_pool_{ size, [](ConnectionLink *&link) { link->ws_.close(); } } {
+    // the io threads don't need to grow with the links, they are only busy while data moves
     for(auto i = 0; i < 4; ++i)
         workers_.emplace_back(std::bind_front(&AsyncConnectionPool::worker_loop, this));
-    for(auto i = 0; i < 4; ++i)
-        available_pool_.enqueue(std::make_shared<WebSocketSession>(ctx_, host, port));
+    for(auto i = std::size_t{ 0 }; i < size; ++i) {
+        links_.push_back(std::make_unique<ConnectionLink>(*this, host, port));
+        available_pool_.enqueue(links_.back().get());
+    }
+    metrics::Registry::instance().pool_size.fetch_add(size, std::memory_order_relaxed);
 }
 
 AsyncConnectionPool::~AsyncConnectionPool() {
@@ -28,14 +35,27 @@ AsyncConnectionPool::~AsyncConnectionPool() {
 
 // potentially blocks
 AsyncConnectionPool::shared_link_t AsyncConnectionPool::borrow() {
-    auto ws = available_pool_.dequeue();
-    if(!ws)
+    auto link = [this] {
+        auto span  = trace::Span{ "pool", "borrow" };
+        auto timed = metrics::Timed{ &metrics::Usage::pool_wait };
+        return available_pool_.dequeue();
+    }();
+    if(!link)
         throw std::runtime_error("Could not borrow ws connection");
 
-    return std::make_shared<ConnectionLink>(*ws,
-        [this, ws = *ws]() {
-            available_pool_.enqueue(ws);
-        });
+    metrics::Registry::instance().pool_borrowed.fetch_add(1, std::memory_order_relaxed);
+    try {
+        (*link)->ws_.ensure_connection_established();
+    } catch(...) {
+        give_back(*link); // the next borrower gets to see whether reconnecting worked
+        throw;
+    }
+    return shared_link_t{ *link };
+}
+
+void AsyncConnectionPool::give_back(ConnectionLink *link) {
+    metrics::Registry::instance().pool_borrowed.fetch_sub(1, std::memory_order_relaxed);
+    available_pool_.enqueue(link);
 }
 
 void AsyncConnectionPool::worker_loop() {
@@ -4,61 +4,96 @@
 #include <web/web_socket_session.hpp>
 
 #include <boost/asio/io_context.hpp>
+#include <boost/smart_ptr/intrusive_ptr.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <exception>
-#include <functional>
 #include <memory>
+#include <string_view>
 #include <thread>
 #include <vector>
 
 class AsyncConnectionPool {
-    using ws_ptr_t = std::shared_ptr<WebSocketSession>;
-
-    boost::asio::io_context ctx_;
-    boost::asio::executor_work_guard<decltype(ctx_.get_executor())> work_;
-    util::AsyncQueue<ws_ptr_t> available_pool_;
-    std::vector<std::thread> workers_;
-
 public:
+    /**
+     * @brief A pooled session handed out by borrow
+     *
+     * Links are created once together with their session and reference counted in place, so
+     * borrowing and returning a connection never allocates. The link goes back to the pool when
+     * the last shared_link_t to it is gone.
+     */
     class ConnectionLink {
-        ws_ptr_t ws_; // connection that is borrowed by the client
-        std::function<void()> cleanup_;
+        friend class AsyncConnectionPool;
+
+        AsyncConnectionPool &pool_;
+        WebSocketSession ws_; // connection that is borrowed by the client
+        std::atomic<std::size_t> references_ = 0;
 
     public:
-        template <typename Fn>
-        ConnectionLink(ws_ptr_t const &ws, Fn cleanup)
-            : ws_{ ws }
-            , cleanup_{ cleanup } {
-            ws_->ensure_connection_established();
+        ConnectionLink(AsyncConnectionPool &pool, std::string const &host, std::string const &port)
+            : pool_{ pool }
+            , ws_{ pool.ctx_, host, port } { }
+
+        ConnectionLink(ConnectionLink const &)            = delete;
+        ConnectionLink &operator=(ConnectionLink const &) = delete;
+
+        void write(std::string &&data) {
+            ws_.write(std::move(data));
         }
-        ~ConnectionLink() {
-            cleanup_();
+
+        std::string_view read_one(std::chrono::milliseconds timeout = {}) {
+            // note: blocks until message is received or the timeout passed
+            return ws_.read_one(timeout);
         }
 
-        void write(std::string &&data) {
-            ws_->write(std::move(data));
+        WebSocketSession::Timing timing() const {
+            return ws_.timing();
         }
 
-        std::string read_one() {
-            // note: blocks until message is received
-            return ws_->read_one();
+    private:
+        void release() {
+            if(references_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                pool_.give_back(this);
+        }
+
+        friend void intrusive_ptr_add_ref(ConnectionLink *link) {
+            link->references_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        friend void intrusive_ptr_release(ConnectionLink *link) {
+            link->release();
         }
     };
 
-    using shared_link_t = std::shared_ptr<ConnectionLink>;
+    using shared_link_t = boost::intrusive_ptr<ConnectionLink>;
+
+private:
+    boost::asio::io_context ctx_;
+    boost::asio::executor_work_guard<decltype(ctx_.get_executor())> work_;
+    std::vector<std::unique_ptr<ConnectionLink>> links_;
+    util::AsyncQueue<ConnectionLink *> available_pool_;
+    std::vector<std::thread> workers_;
 
 public:
-    explicit AsyncConnectionPool(std::string const &host, std::string const &port);
+    static constexpr std::size_t default_size = 4;
+
+    /**
+     * @param size Number of connections; every flow running at once holds at most one of them
+     */
+    explicit AsyncConnectionPool(std::string const &host, std::string const &port, std::size_t size = default_size);
     ~AsyncConnectionPool();
 
     /**
-     * @brief 
+     * @brief Blocks until a connection is available and established
      * 
      * @return shared_link_t 
      */
     shared_link_t borrow();
 
 private:
+    void give_back(ConnectionLink *link);
     void worker_loop();
     void stop();
 };
@@ -1,13 +1,30 @@
 #pragma once
 
+#include <chrono>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <type_traits>
 
+/**
+ * @brief Thrown when no response arrived within the timeout of read_one
+ */
+struct ReadTimeout : public std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief Thrown when the session could not (re)connect to the server or lost its connection
+ */
+struct ConnectionError : public std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
 // clang-format off
 template <typename T>
 concept ConnectionChannel = requires(T a, std::string s) {
     { a->write(std::move(s)) };
-    { a->read_one() } -> std::convertible_to<std::string>;
+    { a->read_one(std::chrono::milliseconds{}) } -> std::convertible_to<std::string_view>;
 };
 
 template <typename T>
@@ -2,6 +2,8 @@
 
 #include <web/concepts.hpp>
 
+#include <cstddef>
+#include <string>
 #include <type_traits>
 
 /**
@@ -25,6 +27,14 @@ public:
         , fetcher_{ std::cref(fetcher) } {
     }
 
+    /**
+     * @param connections How many connections the handler keeps; at least the number of flows running at once
+     */
+    ConnectionManager(std::string const &host, std::string const &port, std::size_t connections, FetchProvider const &fetcher)
+        : handler_{ host, port, connections }
+        , fetcher_{ std::cref(fetcher) } {
+    }
+
     [[nodiscard]] ConnectionChannel auto request(std::string &&data) {
         auto link = handler_.borrow(); // potentially blocks until ws is available to borrow
         link->write(std::move(data));
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+/**
+ * @brief A few fixed blocks for the asio operations a session hands to its strand
+ *
+ * Asio allocates an operation for every function dispatched to a strand, and another one to
+ * schedule the strand itself. Its own recycling of that memory only works on threads that run
+ * the io_context, so a flow thread handing work to a session would hit the heap on every
+ * request. Blocks are taken on the calling thread and given back on the io thread; requests
+ * that don't fit or find no free block fall back to operator new.
+ */
+class HandlerMemory {
+    static constexpr std::size_t block_size = 256;
+    static constexpr std::size_t blocks     = 4;
+
+    struct Block {
+        alignas(std::max_align_t) unsigned char storage[block_size];
+        std::atomic_bool in_use = false;
+    };
+
+    std::array<Block, blocks> blocks_;
+
+public:
+    HandlerMemory() = default;
+
+    HandlerMemory(HandlerMemory const &)            = delete;
+    HandlerMemory &operator=(HandlerMemory const &) = delete;
+
+    void *allocate(std::size_t size) {
+        if(size <= block_size)
+            for(auto &block : blocks_)
+                if(not block.in_use.exchange(true, std::memory_order_acquire))
+                    return block.storage;
+        return ::operator new(size);
+    }
+
+    void deallocate(void *pointer) {
+        for(auto &block : blocks_)
+            if(pointer == block.storage)
+                return block.in_use.store(false, std::memory_order_release);
+        ::operator delete(pointer);
+    }
+};
+
+/**
+ * @brief Standard allocator handing out HandlerMemory blocks
+ */
+template <typename T>
+class HandlerAllocator {
+    template <typename>
+    friend class HandlerAllocator;
+
+    HandlerMemory *memory_;
+
+public:
+    using value_type = T;
+
+    explicit HandlerAllocator(HandlerMemory &memory)
+        : memory_{ &memory } { }
+
+    template <typename U>
+    HandlerAllocator(HandlerAllocator<U> const &other) noexcept
+        : memory_{ other.memory_ } { }
+
+    T *allocate(std::size_t n) const {
+        return static_cast<T *>(memory_->allocate(sizeof(T) * n));
+    }
+
+    void deallocate(T *pointer, std::size_t) const {
+        memory_->deallocate(pointer);
+    }
+
+    template <typename U>
+    bool operator==(HandlerAllocator<U> const &other) const noexcept {
+        return memory_ == other.memory_;
+    }
+};
+
+/**
+ * @brief Handler whose operations are allocated from the given HandlerMemory
+ */
+template <typename Handler>
+class MemoryBoundHandler {
+    HandlerMemory &memory_;
+    Handler handler_;
+
+public:
+    using allocator_type = HandlerAllocator<Handler>;
+
+    MemoryBoundHandler(HandlerMemory &memory, Handler handler)
+        : memory_{ memory }
+        , handler_{ std::move(handler) } { }
+
+    allocator_type get_allocator() const noexcept {
+        return allocator_type{ memory_ };
+    }
+
+    template <typename... Args>
+    void operator()(Args &&...args) {
+        handler_(std::forward<Args>(args)...);
+    }
+};
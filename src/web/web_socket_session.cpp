@@ -1,6 +1,10 @@
+#include <metrics/registry.hpp>
+#include <metrics/usage.hpp>
+#include <trace/tracer.hpp>
 #include <web/web_socket_session.hpp>
 
 #include <boost/asio/connect.hpp>
+#include <boost/asio/dispatch.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/ssl/error.hpp>
 #include <boost/asio/ssl/stream.hpp>
@@ -12,10 +16,12 @@
 #include <boost/beast/version.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/beast/websocket/ssl.hpp>
+#include <fmt/format.h>
 
 #include <exception>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace beast     = boost::beast;         // from <boost/beast.hpp>
@@ -31,28 +37,92 @@ void fail([[maybe_unused]] beast::error_code ec, [[maybe_unused]] std::string_vi
 }
 
 WebSocketSession::WebSocketSession(net::io_context &ioc, std::string const &host, std::string const &port)
-    : resolver_(net::make_strand(ioc))
-    , ws_(net::make_strand(ioc))
+    : strand_{ net::make_strand(ioc) }
+    , resolver_{ strand_ }
+    , ws_{ strand_ }
     , host_{ host }
-    , port_{ port } {
+    , port_{ port }
+    , read_timer_{ ws_.get_executor() } {
     connect();
 }
 
 void WebSocketSession::ensure_connection_established() {
-    is_connected_.wait(false);
+    state_.wait(State::CONNECTING);
+    if(state_ != State::FAILED)
+        return;
+
+    // nothing touches the error until the next attempt is started right below
+    auto error = std::exchange(connect_error_, nullptr);
+    state_     = State::CONNECTING;
+    net::dispatch(strand_, [this] { connect(); });
+    std::rethrow_exception(error);
 }
 
 void WebSocketSession::write(std::string &&data) {
     ensure_connection_established();
-    ws_.async_write(net::buffer(data), beast::bind_front_handler(&WebSocketSession::on_write, this));
+
+    // the response to the previous request may arrive before its write completed
+    writing_.wait(true);
+    writing_ = true;
+
+    write_buffer_         = std::move(data);
+    timing_.write_started = clock_t::now();
+    timing_.bytes_sent    = write_buffer_.size();
+    write_done_           = 0;
+
+    auto &usage = metrics::usage();
+    ++usage.requests;
+    usage.bytes_sent += write_buffer_.size();
+
+    auto &registry = metrics::Registry::instance();
+    registry.requests_sent.fetch_add(1, std::memory_order_relaxed);
+    registry.bytes_sent.fetch_add(write_buffer_.size(), std::memory_order_relaxed);
+    if(not std::exchange(awaiting_response_, true))
+        registry.in_flight.fetch_add(1, std::memory_order_relaxed);
+
+    net::dispatch(strand_, MemoryBoundHandler{ handler_memory_, [this] {
+        ws_.async_write(net::buffer(write_buffer_), beast::bind_front_handler(&WebSocketSession::on_write, this));
+    } });
 }
 
-std::string WebSocketSession::read_one() {
+std::string_view WebSocketSession::read_one(std::chrono::milliseconds timeout) {
     ensure_connection_established();
 
-    beast::flat_buffer buffer;
-    ws_.read(buffer);
-    return beast::buffers_to_string(buffer.data());
+    auto span      = trace::Span{ { this, "connection" }, "network", "read" };
+    auto &registry = metrics::Registry::instance();
+
+    // the read runs on the strand together with its timer, this thread only waits for the outcome
+    read_done_ = false;
+    net::dispatch(strand_, MemoryBoundHandler{ handler_memory_, [this, timeout] {
+        read_timeout_ = timeout;
+        start_read();
+    } });
+    read_done_.wait(false);
+
+    if(auto error = std::exchange(read_error_, nullptr)) {
+        if(std::exchange(awaiting_response_, false))
+            registry.in_flight.fetch_sub(1, std::memory_order_relaxed);
+        std::rethrow_exception(error);
+    }
+
+    auto const message = std::string_view{ static_cast<char const *>(read_buffer_.data().data()), read_buffer_.size() };
+
+    auto &usage = metrics::usage();
+    ++usage.frames;
+    usage.bytes_received += message.size();
+
+    registry.bytes_received.fetch_add(message.size(), std::memory_order_relaxed);
+    if(std::exchange(awaiting_response_, false))
+        registry.in_flight.fetch_sub(1, std::memory_order_relaxed);
+
+    return message;
+}
+
+WebSocketSession::Timing WebSocketSession::timing() const {
+    auto timing = timing_;
+    if(auto done = write_done_.load(); done != 0)
+        timing.write_done = clock_t::time_point{ clock_t::duration{ done } };
+    return timing;
 }
 
 void WebSocketSession::close() {
@@ -60,13 +130,13 @@ void WebSocketSession::close() {
 }
 
 void WebSocketSession::connect() {
-    is_connected_ = false;
+    state_ = State::CONNECTING;
     resolver_.async_resolve(host_, port_, beast::bind_front_handler(&WebSocketSession::on_resolve, this));
 }
 
 void WebSocketSession::on_resolve(beast::error_code ec, tcp::resolver::results_type results) {
     if(ec)
-        return fail(ec, "resolve");
+        return connect_failed(ec, "resolve");
 
     beast::get_lowest_layer(ws_).expires_after(std::chrono::seconds(30));
     beast::get_lowest_layer(ws_).async_connect(results, beast::bind_front_handler(&WebSocketSession::on_connect, this));
@@ -74,7 +144,7 @@ void WebSocketSession::on_resolve(beast::error_code ec, tcp::resolver::results_t
 
 void WebSocketSession::on_connect(beast::error_code ec, tcp::resolver::results_type::endpoint_type ep) {
     if(ec)
-        return fail(ec, "connect");
+        return connect_failed(ec, "connect");
 
     beast::get_lowest_layer(ws_).expires_never();
     ws_.set_option(
@@ -86,24 +156,84 @@ void WebSocketSession::on_connect(beast::error_code ec, tcp::resolver::results_t
             req.set(http::field::user_agent, "cliot");
         }));
 
-    // See https://tools.ietf.org/html/rfc7230#section-5.4
-    host_ += ':' + std::to_string(ep.port());
-
-    ws_.async_handshake(host_, "/", beast::bind_front_handler(&WebSocketSession::on_handshake, this));
+    // See https://tools.ietf.org/html/rfc7230#section-5.4; host_ stays as is for reconnecting
+    ws_.async_handshake(host_ + ':' + std::to_string(ep.port()), "/", beast::bind_front_handler(&WebSocketSession::on_handshake, this));
 }
 
 void WebSocketSession::on_handshake(beast::error_code ec) {
     if(ec)
-        return fail(ec, "handshake");
-    is_connected_ = true;
-    is_connected_.notify_all();
+        return connect_failed(ec, "handshake");
+    state_ = State::CONNECTED;
+    state_.notify_all();
+}
+
+void WebSocketSession::connect_failed(beast::error_code ec, std::string_view what) {
+    fail(ec, what);
+    beast::get_lowest_layer(ws_).close();
+    connect_error_ = std::make_exception_ptr(ConnectionError{ fmt::format("Could not connect to {}:{}, {} failed: {}", host_, port_, what, ec.message()) });
+    state_         = State::FAILED;
+    state_.notify_all();
 }
 
 void WebSocketSession::on_write(beast::error_code ec, [[maybe_unused]] std::size_t bytes_transferred) {
+    write_done_ = clock_t::now().time_since_epoch().count();
+    writing_    = false;
+    writing_.notify_all();
     if(ec)
         return fail(ec, "write");
 }
 
+void WebSocketSession::start_read() {
+    ++read_id_;
+    reading_   = true;
+    timed_out_ = false;
+    read_buffer_.clear();
+    if(read_timeout_.count() > 0) {
+        read_timer_.expires_after(read_timeout_);
+        read_timer_.async_wait(beast::bind_front_handler(&WebSocketSession::on_read_timeout, this, read_id_));
+    }
+
+    // read piece by piece to know when the first part of the frame arrived
+    ws_.async_read_some(read_buffer_, 0, beast::bind_front_handler(&WebSocketSession::on_read, this));
+}
+
+void WebSocketSession::on_read(beast::error_code ec, [[maybe_unused]] std::size_t bytes_transferred) {
+    if(ec) {
+        read_timer_.cancel();
+
+        // the stream can't be used after a failed read, nor after cancelling one in the middle of a message
+        beast::get_lowest_layer(ws_).close();
+        connect();
+        if(timed_out_)
+            return finish_read(std::make_exception_ptr(ReadTimeout{ fmt::format("No message within {}ms", read_timeout_.count()) }));
+        return finish_read(std::make_exception_ptr(ConnectionError{ fmt::format("Lost connection to {}:{}, read failed: {}", host_, port_, ec.message()) }));
+    }
+
+    if(read_buffer_.size() == bytes_transferred)
+        timing_.first_byte = clock_t::now();
+    if(not ws_.is_message_done())
+        return ws_.async_read_some(read_buffer_, 0, beast::bind_front_handler(&WebSocketSession::on_read, this));
+
+    read_timer_.cancel();
+    timing_.frame_done     = clock_t::now();
+    timing_.bytes_received = read_buffer_.size();
+    finish_read(nullptr);
+}
+
+void WebSocketSession::on_read_timeout(std::uint64_t id, beast::error_code ec) {
+    if(ec or id != read_id_ or not reading_)
+        return; // cancelled, or the read it was meant for already completed
+    timed_out_ = true;
+    beast::get_lowest_layer(ws_).cancel();
+}
+
+void WebSocketSession::finish_read(std::exception_ptr error) {
+    reading_    = false;
+    read_error_ = std::move(error);
+    read_done_  = true;
+    read_done_.notify_all();
+}
+
 void WebSocketSession::on_close(beast::error_code ec) {
     if(ec)
         return fail(ec, "close");
@@ -1,10 +1,13 @@
 #pragma once
 
 #include <util/async_queue.hpp>
-#include <web/web_socket_session.hpp>
+#include <web/concepts.hpp>
+#include <web/handler_memory.hpp>
 
 #include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/asio/ssl/error.hpp>
 #include <boost/asio/ssl/stream.hpp>
 #include <boost/asio/strand.hpp>
@@ -17,6 +20,7 @@
 #include <boost/beast/websocket/ssl.hpp>
 
 #include <atomic>
+#include <chrono>
 #include <exception>
 #include <memory>
 #include <string>
@@ -26,19 +30,67 @@
 void fail([[maybe_unused]] boost::beast::error_code ec, [[maybe_unused]] std::string_view what);
 
 class WebSocketSession {
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    /**
+     * @brief Monotonic timestamps of the last request/response exchange on this session
+     */
+    struct Timing {
+        clock_t::time_point write_started;
+        clock_t::time_point write_done;
+        clock_t::time_point first_byte;
+        clock_t::time_point frame_done;
+        std::size_t bytes_sent     = 0;
+        std::size_t bytes_received = 0;
+    };
+
+private:
+    // kept as the concrete type so that handing work to it can use handler_memory_
+    boost::asio::strand<boost::asio::io_context::executor_type> strand_;
+    HandlerMemory handler_memory_;
     boost::asio::ip::tcp::resolver resolver_;
     boost::beast::websocket::stream<boost::beast::tcp_stream> ws_;
 
     std::string host_;
     std::string port_;
 
-    std::atomic_bool is_connected_ = false;
+    enum class State {
+        CONNECTING,
+        CONNECTED,
+        FAILED
+    };
+    std::atomic<State> state_ = State::CONNECTING;
+    std::exception_ptr connect_error_; // set on the strand before state_ becomes FAILED
+
+    std::string write_buffer_;         // must outlive the async write
+    std::atomic_bool writing_ = false; // a write is in flight; beast allows only one at a time
+    Timing timing_;
+    std::atomic<clock_t::rep> write_done_ = 0; // set on the io thread
+    bool awaiting_response_               = false;
+
+    // state of the read in progress; only touched on the strand of the stream
+    boost::asio::steady_timer read_timer_;
+    boost::beast::flat_buffer read_buffer_; // keeps its capacity between reads
+    std::chrono::milliseconds read_timeout_{};
+    std::uint64_t read_id_ = 0; // tells a late timer of an earlier read apart
+    bool reading_          = false;
+    bool timed_out_        = false;
+
+    // outcome of the read, handed to the thread waiting in read_one
+    std::atomic_bool read_done_ = false;
+    std::exception_ptr read_error_;
 
 public:
     explicit WebSocketSession(boost::asio::io_context &ioc, std::string const &host, std::string const &port);
 
     /**
      * @brief Blocks until connection is actually established
+     *
+     * If the last attempt to connect failed its error is thrown and a new attempt is started,
+     * so that the session recovers once the server is back.
+     *
+     * @throws ConnectionError if the session could not connect
      */
     void ensure_connection_established();
 
@@ -50,11 +102,25 @@ public:
     void write(std::string &&data);
 
     /**
-     * @brief 
-     * 
-     * @return std::string 
+     * @brief Blocks until the next message arrived
+     *
+     * The wait is limited by an asio timer on the session. When it runs out the pending read
+     * is cancelled and the session reconnects, since a late response would otherwise be taken
+     * for the answer to the next request.
+     *
+     * @param timeout Zero waits forever
+     * @return The message, valid until the next read on this session
+     * @throws ReadTimeout if no complete message arrived within the timeout
+     * @throws ConnectionError if the connection broke while reading; the session reconnects
+     */
+    std::string_view read_one(std::chrono::milliseconds timeout = {});
+
+    /**
+     * @brief Timestamps of the last write and the last read_one
+     *
+     * @return Timing
      */
-    std::string read_one();
+    Timing timing() const;
 
     /**
      * @brief 
@@ -67,6 +133,11 @@ private:
     void on_resolve(boost::beast::error_code ec, boost::asio::ip::tcp::resolver::results_type results);
     void on_connect(boost::beast::error_code ec, boost::asio::ip::tcp::resolver::results_type::endpoint_type ep);
     void on_handshake(boost::beast::error_code ec);
+    void connect_failed(boost::beast::error_code ec, std::string_view what);
     void on_write(boost::beast::error_code ec, [[maybe_unused]] std::size_t bytes_transferred);
+    void start_read();
+    void on_read(boost::beast::error_code ec, [[maybe_unused]] std::size_t bytes_transferred);
+    void on_read_timeout(std::uint64_t id, boost::beast::error_code ec);
+    void finish_read(std::exception_ptr error);
     void on_close(boost::beast::error_code ec);
 };
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <metrics/usage.hpp>
+#include <util/arena.hpp>
+#include <util/arena_json.hpp>
+
+#include <fmt/format.h>
+#include <inja/inja.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace {
+// a ledger_data sized page
+std::string page(std::size_t objects) {
+    auto result = std::string{ R"({"result": {"ledger_index": 32570, "validated": true, "state": [)" };
+    for(auto i = std::size_t{ 0 }; i < objects; ++i)
+        result += fmt::format(R"({}{{"index": "{:064X}", "Balance": "{}", "Flags": {}, "Rate": 1.5, "Deleted": null}})", i == 0 ? "" : ",", i, 1000000 + i, i % 7);
+    return result + "]}}";
+}
+} // namespace
+
+TEST(Arena, AllocatesFromTheArenaOnlyInsideAScope) {
+    auto const before = util::Arena::current();
+    {
+        auto const arena = util::Arena::Scope{};
+        EXPECT_NE(util::Arena::current(), before);
+        {
+            auto const nested = util::Arena::Scope{}; // same arena, rewound by the outer scope only
+            EXPECT_NE(util::Arena::current(), before);
+        }
+    }
+    EXPECT_EQ(util::Arena::current(), before);
+}
+
+TEST(Arena, StopsGrowingWhenRewound) {
+    auto const text = page(500);
+
+    auto const heap = [&text] {
+        auto const before = metrics::usage();
+        auto const doc    = inja::json::parse(text);
+        return (metrics::usage() - before).allocations;
+    }();
+
+    auto used = std::uint64_t{ 0 };
+    for(auto round = 0; round < 3; ++round) {
+        auto const before = metrics::usage();
+        {
+            auto const arena = util::Arena::Scope{};
+            auto const doc   = util::ArenaJson::parse(text);
+            ASSERT_EQ(doc["result"]["state"].size(), 500u);
+        }
+        used = (metrics::usage() - before).allocations;
+    }
+
+    // what's left is the parser's own bookkeeping
+    EXPECT_LT(used * 50, heap);
+}
+
+TEST(Arena, MemoryCanBeFreedOutsideOfWhereItCameFrom) {
+    auto outside = util::ArenaJson::parse(page(10));
+    {
+        auto const arena = util::Arena::Scope{};
+        auto inside      = util::ArenaJson::parse(page(10));
+        EXPECT_EQ(inside, outside);
+        outside = nullptr; // goes back to the heap
+    }
+    EXPECT_TRUE(outside.is_null());
+}
+
+TEST(Arena, PromoteCopiesEverythingOut) {
+    auto const text = page(20);
+
+    auto promoted = inja::json{};
+    {
+        auto const arena = util::Arena::Scope{};
+        promoted         = util::promote(util::ArenaJson::parse(text));
+    }
+
+    auto const arena = util::Arena::Scope{};
+    auto const reuse = util::ArenaJson::parse(page(40)); // overwrites where the original was
+    EXPECT_EQ(promoted, inja::json::parse(text));
+    EXPECT_EQ(reuse["result"]["state"].size(), 40u);
+}
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include <flow/exceptions.hpp>
+#include <reporting/artifact_store.hpp>
+#include <temp_suite.hpp>
+#include <util/hash.hpp>
+
+#include <fmt/format.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+struct ArtifactStoreTest : public TempSuite {
+    std::filesystem::path dir = root / "artifacts";
+
+    void TearDown() override {
+        ArtifactStore::instance().configure({});
+    }
+};
+} // namespace
+
+TEST_F(ArtifactStoreTest, TruncatesWithoutDirectory) {
+    ArtifactStore::instance().configure({}, 100);
+    EXPECT_EQ(ArtifactStore::instance().spill("small"), "small");
+
+    auto const spilled = ArtifactStore::instance().spill(std::string(1000, 'x'));
+    auto const kept    = spilled.find('\n');
+    EXPECT_LE(spilled.size(), 100u);
+    EXPECT_EQ(spilled.substr(0, kept), std::string(kept, 'x'));
+    EXPECT_NE(spilled.find(fmt::format("{} more bytes truncated", 1000 - kept)), std::string::npos);
+}
+
+TEST_F(ArtifactStoreTest, SpillingTwiceChangesNothing) {
+    // like the issues of a subflow that every enclosing level rethrows in a new FlowException
+    ArtifactStore::instance().configure({}, 100);
+    auto const truncated = ArtifactStore::instance().spill(std::string(1000, 'x'));
+    EXPECT_EQ(ArtifactStore::instance().spill(std::string{ truncated }), truncated);
+
+    ArtifactStore::instance().configure({}, 8); // too small for the notice itself
+    auto const tiny = ArtifactStore::instance().spill(std::string(1000, 'x'));
+    EXPECT_EQ(ArtifactStore::instance().spill(std::string{ tiny }), tiny);
+    EXPECT_NE(tiny.find("1000 more bytes truncated"), std::string::npos);
+
+    ArtifactStore::instance().configure(dir, 8);
+    auto const inner = FlowException("sub/1.json", { { FailureEvent::Data::Type::LOGIC_ERROR, "sub/1.json", "bad", std::string(50, 'd') } }, "");
+    auto const outer = FlowException("sub", inner.issues, "No data");
+    EXPECT_EQ(outer.issues.front().detail, inner.issues.front().detail);
+    EXPECT_EQ(std::distance(std::filesystem::directory_iterator{ dir }, std::filesystem::directory_iterator{}), 1);
+}
+
+TEST_F(ArtifactStoreTest, WritesEachPayloadOnce) {
+    ArtifactStore::instance().configure(dir, 8);
+
+    auto const payload = std::string(100, 'y');
+    auto const first   = ArtifactStore::instance().spill(std::string{ payload });
+    auto const second  = ArtifactStore::instance().spill(std::string{ payload });
+    EXPECT_EQ(first, second);
+    EXPECT_NE(first.find("(100 bytes)"), std::string::npos);
+
+    auto files = std::distance(std::filesystem::directory_iterator{ dir }, std::filesystem::directory_iterator{});
+    ASSERT_EQ(files, 1);
+
+    auto in      = std::ifstream{ std::filesystem::directory_iterator{ dir }->path() };
+    auto content = std::stringstream{};
+    content << in.rdbuf();
+    EXPECT_EQ(content.str(), payload);
+}
+
+TEST_F(ArtifactStoreTest, ConcurrentSpillsOfSamePayloadLeaveOneCompleteFile) {
+    ArtifactStore::instance().configure(dir, 8);
+
+    auto const payload = std::string(1 << 20, 'c');
+    {
+        auto threads = std::vector<std::jthread>{};
+        for(auto i = 0; i < 8; ++i)
+            threads.emplace_back([&payload] { EXPECT_EQ(ArtifactStore::instance().spill(std::string{ payload }).find("<artifact "), 0u); });
+    }
+
+    auto files = std::distance(std::filesystem::directory_iterator{ dir }, std::filesystem::directory_iterator{});
+    ASSERT_EQ(files, 1);
+    EXPECT_EQ(std::filesystem::file_size(dir / (util::sha256_hex(payload) + ".txt")), payload.size());
+}
+
+TEST_F(ArtifactStoreTest, SameSizedPayloadsGetTheirOwnArtifacts) {
+    ArtifactStore::instance().configure(dir, 8);
+
+    auto const first  = ArtifactStore::instance().spill(std::string(100, 'a'));
+    auto const second = ArtifactStore::instance().spill(std::string(100, 'b'));
+    EXPECT_NE(first, second);
+    EXPECT_EQ(std::distance(std::filesystem::directory_iterator{ dir }, std::filesystem::directory_iterator{}), 2);
+}
+
+TEST_F(ArtifactStoreTest, FlowExceptionOnlyKeepsReferences) {
+    ArtifactStore::instance().configure(dir, 8);
+
+    auto const e = FlowException("flow/1.json",
+        { { FailureEvent::Data::Type::LOGIC_ERROR, "flow/1.json", "bad", std::string(50, 'd') } },
+        std::string(50, 'r'));
+    EXPECT_EQ(e.response.find("<artifact "), 0u);
+    EXPECT_EQ(e.issues.front().detail.find("<artifact "), 0u);
+    EXPECT_EQ(e.issues.front().message, "bad");
+}
+
+TEST_F(ArtifactStoreTest, TruncatesWhenArtifactCantBeWritten) {
+    ArtifactStore::instance().configure(dir, 512);
+    std::filesystem::remove_all(dir); // gone after configure, like a full or removed disk
+
+    auto const payload = std::string(1000, 'z');
+    for(auto i = 0; i < 2; ++i) { // and nothing remembers the artifact that was never written
+        auto const spilled = ArtifactStore::instance().spill(std::string{ payload });
+        EXPECT_LE(spilled.size(), 512u);
+        EXPECT_EQ(spilled.front(), 'z');
+        EXPECT_NE(spilled.find("could not write artifact"), std::string::npos);
+    }
+
+    std::filesystem::create_directories(dir);
+    EXPECT_EQ(ArtifactStore::instance().spill(std::string{ payload }).find("<artifact "), 0u);
+    EXPECT_TRUE(std::filesystem::exists(dir / (util::sha256_hex(payload) + ".txt")));
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <util/async_queue.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+TEST(AsyncQueue, EnqueueBlocksWhileFull) {
+    util::AsyncQueue<int> queue{ 2, [](int &) {} };
+    queue.enqueue(1);
+    queue.enqueue(2);
+
+    std::atomic_bool enqueued = false;
+    auto producer             = std::thread{ [&] {
+        queue.enqueue(3);
+        enqueued = true;
+    } };
+
+    std::this_thread::sleep_for(50ms);
+    EXPECT_FALSE(enqueued.load());
+
+    EXPECT_EQ(queue.dequeue(), 1);
+    producer.join();
+    EXPECT_TRUE(enqueued.load());
+    EXPECT_EQ(queue.dequeue(), 2);
+    EXPECT_EQ(queue.dequeue(), 3);
+    EXPECT_EQ(queue.size(), 0u);
+}
+
+TEST(AsyncQueue, StopWakesWaitersAndDeletesQueuedElements) {
+    std::atomic<int> deleted = 0;
+    util::AsyncQueue<int> queue{ 4, [&deleted](int &) { ++deleted; } };
+
+    auto consumers         = std::vector<std::thread>{};
+    std::atomic<int> woken = 0;
+    for(int i = 0; i < 3; ++i)
+        consumers.emplace_back([&] {
+            EXPECT_FALSE(queue.dequeue().has_value());
+            ++woken;
+        });
+
+    std::this_thread::sleep_for(50ms); // let them park on the empty queue
+    queue.stop();
+    for(auto &consumer : consumers)
+        consumer.join();
+    EXPECT_EQ(woken.load(), 3);
+
+    queue.enqueue(42); // dropped after stop, never handed to the deleter
+    EXPECT_EQ(queue.size(), 0u);
+    EXPECT_EQ(deleted.load(), 0);
+
+    util::AsyncQueue<int> full{ 2, [&deleted](int &) { ++deleted; } };
+    full.enqueue(1);
+    full.enqueue(2);
+    full.stop();
+    EXPECT_EQ(deleted.load(), 2);
+    EXPECT_FALSE(full.dequeue().has_value());
+}
+
+TEST(AsyncQueue, StressManyProducersAndConsumers) {
+    constexpr int producers  = 4;
+    constexpr int consumers  = 4;
+    constexpr int per_thread = 20000;
+
+    // a small capacity makes both sides park all the time
+    util::AsyncQueue<int> queue{ 4, [](int &) {} };
+    std::atomic<long long> sum = 0;
+    std::atomic<int> consumed  = 0;
+    auto threads               = std::vector<std::thread>{};
+
+    for(int c = 0; c < consumers; ++c)
+        threads.emplace_back([&] {
+            while(auto value = queue.dequeue()) {
+                sum += *value;
+                ++consumed;
+            }
+        });
+    for(int p = 0; p < producers; ++p)
+        threads.emplace_back([&queue] {
+            for(int i = 1; i <= per_thread; ++i)
+                queue.enqueue(i);
+        });
+
+    while(consumed.load() < producers * per_thread)
+        std::this_thread::sleep_for(1ms);
+    queue.stop();
+    for(auto &thread : threads)
+        thread.join();
+
+    EXPECT_EQ(consumed.load(), producers * per_thread);
+    EXPECT_EQ(sum.load(), static_cast<long long>(producers) * per_thread * (per_thread + 1) / 2);
+}
+
+TEST(AsyncQueue, StressBorrowAndReturn) {
+    // the connection pool pattern: a fixed set of elements passed around by many more threads
+    constexpr int elements  = 4;
+    constexpr int borrowers = 16;
+    constexpr int rounds    = 5000;
+
+    util::AsyncQueue<std::shared_ptr<std::atomic<int>>> pool{ elements, [](std::shared_ptr<std::atomic<int>> &) {} };
+    for(int i = 0; i < elements; ++i)
+        pool.enqueue(std::make_shared<std::atomic<int>>(0));
+
+    std::atomic_bool shared = false;
+    auto threads            = std::vector<std::thread>{};
+    for(int b = 0; b < borrowers; ++b)
+        threads.emplace_back([&] {
+            for(int i = 0; i < rounds; ++i) {
+                auto element = pool.dequeue();
+                ASSERT_TRUE(element.has_value());
+                if(++**element != 1) // nobody else holds it right now
+                    shared = true;
+                --**element;
+                pool.enqueue(*element);
+            }
+        });
+    for(auto &thread : threads)
+        thread.join();
+
+    EXPECT_FALSE(shared.load());
+    EXPECT_EQ(pool.size(), static_cast<std::size_t>(elements));
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <bundle/bundle.hpp>
+#include <temp_suite.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace {
+struct BundleTest : public TempSuite {
+    std::filesystem::path data   = root / "data";
+    std::filesystem::path packed = root / "suite.cliot";
+
+    void SetUp() override {
+        std::filesystem::create_directories(data / "common");
+        std::filesystem::create_directories(data / "flows" / "a");
+        std::filesystem::create_directories(data / "flows" / "b");
+        std::filesystem::create_directories(data / "flows" / ".hidden");
+
+        write(data / "common" / "request.json.j2", R"({"id": {{ id }}})");
+        write(data / "flows" / "a" / "request.json.j2", R"({% include "../../common/request.json.j2" %})");
+        write(data / "flows" / "a" / "env.json", R"({"id": 1})");
+        write(data / "flows" / "a" / "script.yaml", R"(
+steps:
+- type: block
+  repeat: 2
+  steps:
+  - type: request
+    file: request.json.j2
+  - type: response
+    file: response.json.j2
+- type: run_flow
+  name: b
+  fixture: true
+)");
+        write(data / "flows" / "b" / "script.yaml", "steps: []\n");
+        write(data / "flows" / ".hidden" / "script.yaml", "steps: []\n");
+    }
+};
+} // namespace
+
+TEST(BundleFormat, StepsRoundTrip) {
+    auto response  = descriptor::Response{ "response.json.j2", true, { { "hash", "/result/ledger_hash" } } };
+    auto block     = descriptor::RepeatBlock{ { descriptor::Request{ "request.json.j2" }, response }, 3 };
+    auto const in  = std::vector<descriptor::Step>{ block, descriptor::RunFlow{ "setup", true, { "token" } } };
+    auto const out = bundle::decode_steps(bundle::encode_steps(in));
+
+    ASSERT_EQ(out.size(), 2u);
+    auto const &decoded_block = std::get<descriptor::RepeatBlock>(out[0]);
+    EXPECT_EQ(decoded_block.repeat, 3u);
+    ASSERT_EQ(decoded_block.steps.size(), 2u);
+    EXPECT_EQ(std::get<descriptor::Request>(decoded_block.steps[0]).file, "request.json.j2");
+
+    auto const &decoded_response = std::get<descriptor::Response>(decoded_block.steps[1]);
+    EXPECT_EQ(decoded_response.file, "response.json.j2");
+    EXPECT_TRUE(decoded_response.stream);
+    EXPECT_EQ(decoded_response.store, response.store);
+
+    EXPECT_EQ(std::get<descriptor::RunFlow>(out[1]).name, "setup");
+    EXPECT_TRUE(std::get<descriptor::RunFlow>(out[1]).fixture);
+    EXPECT_EQ(std::get<descriptor::RunFlow>(out[1]).keys, std::vector<std::string>{ "token" });
+}
+
+TEST(BundleFormat, ScriptRoundTripKeepsTimeouts) {
+    using namespace std::chrono_literals;
+    auto request   = descriptor::Request{ "request.json.j2", 500ms };
+    auto block     = descriptor::RepeatBlock{ { request }, 2, 1000ms };
+    auto const out = bundle::decode_script(bundle::encode_script({ { block }, 30000ms }));
+
+    EXPECT_EQ(out.timeout, 30000ms);
+    ASSERT_EQ(out.steps.size(), 1u);
+    auto const &decoded_block = std::get<descriptor::RepeatBlock>(out.steps[0]);
+    EXPECT_EQ(decoded_block.timeout, 1000ms);
+    EXPECT_EQ(std::get<descriptor::Request>(decoded_block.steps[0]).timeout, 500ms);
+}
+
+TEST(BundleFormat, TruncatedStepsThrow) {
+    auto encoded = bundle::encode_steps({ descriptor::Request{ "request.json.j2" } });
+    encoded.pop_back();
+    EXPECT_THROW(bundle::decode_steps(encoded), bundle::FormatError);
+}
+
+TEST(BundleFormat, CorruptStepCountThrows) {
+    // as many of the smallest steps as the data can hold still decode
+    auto const smallest = std::vector<descriptor::Step>(3, descriptor::Request{});
+    EXPECT_EQ(bundle::decode_steps(bundle::encode_steps(smallest)).size(), 3u);
+
+    auto encoded = bundle::encode_steps(smallest);
+    encoded[0]   = 4;
+    EXPECT_THROW(bundle::decode_steps(encoded), bundle::FormatError);
+
+    encoded.replace(0, 4, 4, static_cast<char>(0xff));
+    EXPECT_THROW(bundle::decode_steps(encoded), bundle::FormatError); // instead of length_error or bad_alloc
+}
+
+TEST_F(BundleTest, PacksAndMapsSuite) {
+    bundle::pack(data, packed);
+    ASSERT_TRUE(bundle::Bundle::is_bundle(packed));
+    EXPECT_FALSE(bundle::Bundle::is_bundle(data / "flows" / "a" / "env.json"));
+
+    auto const suite = bundle::Bundle{ packed };
+    EXPECT_EQ(suite.flows(), (std::vector<std::string>{ "a", "b" }));
+
+    // lookups go through paths below the bundle as if it was the data directory
+    auto const flow_path = suite.root() / "flows" / "a" / "";
+    auto const steps     = suite.script(flow_path / "script.yaml").steps;
+    ASSERT_EQ(steps.size(), 2u);
+    EXPECT_EQ(std::get<descriptor::RepeatBlock>(steps[0]).repeat, 2u);
+    EXPECT_EQ(std::get<descriptor::RunFlow>(steps[1]).name, "b");
+
+    auto const *request = suite.find(flow_path / "request.json.j2");
+    ASSERT_NE(request, nullptr);
+    EXPECT_EQ(request->kind, bundle::Kind::FILE);
+    EXPECT_EQ(request->data, R"({% include "common/request.json.j2" %})");
+    ASSERT_EQ(request->includes.size(), 1u);
+    EXPECT_EQ(request->includes.front(), "common/request.json.j2");
+
+    EXPECT_NE(suite.find(suite.root() / "common" / "request.json.j2"), nullptr);
+    EXPECT_EQ(suite.find(suite.root() / "flows" / ".hidden" / "script.yaml"), nullptr);
+    EXPECT_EQ(suite.find(suite.root() / ".." / "data" / "flows" / "a" / "env.json"), nullptr);
+}
+
+TEST_F(BundleTest, RejectsIncludesOutsideSuite) {
+    write(data / "flows" / "b" / "request.json.j2", R"({% include "../../../secret.j2" %})");
+    write(root / "secret.j2", "{}");
+    EXPECT_THROW(bundle::pack(data, packed), std::runtime_error);
+}
+
+TEST_F(BundleTest, RejectsOtherVersions) {
+    bundle::pack(data, packed);
+    {
+        auto file = std::fstream{ packed, std::ios::in | std::ios::out | std::ios::binary };
+        file.seekp(bundle::magic.size());
+        file.put(static_cast<char>(bundle::version + 1));
+    }
+    EXPECT_THROW(bundle::Bundle{ packed }, bundle::FormatError);
+}
+
+TEST_F(BundleTest, RejectsCorruptEntryCount) {
+    bundle::pack(data, packed);
+    {
+        auto file = std::fstream{ packed, std::ios::in | std::ios::out | std::ios::binary };
+        file.seekp(bundle::magic.size() + 4);
+        for(auto i = 0; i < 4; ++i)
+            file.put(static_cast<char>(0xff));
+    }
+    EXPECT_THROW(bundle::Bundle{ packed }, bundle::FormatError);
+}
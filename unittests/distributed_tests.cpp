@@ -0,0 +1,283 @@
+#include <gtest/gtest.h>
+
+#include <distributed/channel.hpp>
+#include <distributed/coordinator.hpp>
+#include <distributed/worker.hpp>
+#include <reporting/event_json.hpp>
+#include <reporting/remote_renderer.hpp>
+#include <reporting/report_engine.hpp>
+#include <temp_suite.hpp>
+
+#include <di.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+struct RecordingReporting {
+    std::mutex mtx;
+    std::vector<std::string> passed;
+    std::vector<std::string> failed;
+    int latencies  = 0;
+    int summarized = 0;
+
+    void record(SuccessEvent const &ev) {
+        std::scoped_lock l{ mtx };
+        passed.push_back(ev.flow_name);
+    }
+    void record(FailureEvent const &ev) {
+        std::scoped_lock l{ mtx };
+        failed.push_back(ev.flow_name);
+    }
+    void record(LatencyEvent const &) {
+        std::scoped_lock l{ mtx };
+        ++latencies;
+    }
+    void record(SimpleEvent const &) { }
+    void record(UsageSummaryEvent const &) { }
+    void summarize() {
+        ++summarized;
+    }
+};
+
+struct FakeScheduler {
+    using reporting_t = ReportEngine<RemoteRenderer>;
+    reporting_t &reporting;
+
+    UsageSummaryEvent::Row run_one(std::string const &name, std::string const &dir) {
+        if(dir == "throws")
+            throw std::runtime_error("boom");
+        reporting.record(LatencyEvent{ name, name + "/request.json", "server_info", 10us, 2ms, 3ms, 100, 200 });
+        reporting.record(SuccessEvent{ name, 5ms });
+        return { name, true, 5ms, {} };
+    }
+};
+
+struct DistributedTest : public TempSuite {
+    std::string endpoint = "unix:" + (root / "socket").string();
+
+    // the coordinator starts listening on its own thread
+    std::unique_ptr<distributed::Channel> connect() const {
+        for(auto attempt = 0; attempt < 100; ++attempt) {
+            try {
+                return std::make_unique<distributed::Channel>(endpoint);
+            } catch(std::exception const &) {
+                std::this_thread::sleep_for(20ms);
+            }
+        }
+        return nullptr;
+    }
+};
+} // namespace
+
+TEST(EventJson, FailureRoundTrip) {
+    auto const ev = FailureEvent{ "flow", "response.json.j2",
+        { { FailureEvent::Data::Type::NOT_EQUAL, "result.status", "Expected success", "got error" } },
+        "{}", 42ms, metrics::Usage{ 1, 2, 3, 4 } };
+
+    auto const back = event_json::to_failure(event_json::to_json(ev));
+    EXPECT_EQ(back.flow_name, "flow");
+    EXPECT_EQ(back.path, "response.json.j2");
+    EXPECT_EQ(back.response, "{}");
+    EXPECT_EQ(back.duration, 42ms);
+    EXPECT_EQ(back.usage.requests, 1u);
+    ASSERT_EQ(back.issues.size(), 1u);
+    EXPECT_EQ(back.issues[0].type, FailureEvent::Data::Type::NOT_EQUAL);
+    EXPECT_EQ(back.issues[0].path, "result.status");
+    EXPECT_EQ(back.issues[0].detail, "got error");
+}
+
+TEST_F(DistributedTest, ChannelExchangesMessages) {
+    auto listener = distributed::Listener{ endpoint };
+    auto client   = distributed::Channel{ endpoint };
+    auto server   = listener.accept(1s);
+    ASSERT_NE(server, nullptr);
+
+    EXPECT_TRUE(client.send({ { "type", "hello" }, { "jobs", 2 } }));
+    EXPECT_TRUE(server->send({ { "type", "stop" } }));
+    EXPECT_EQ(server->receive()->at("jobs"), 2);
+    EXPECT_EQ(client.receive()->at("type"), "stop");
+
+    server.reset();
+    EXPECT_FALSE(client.receive().has_value());
+    EXPECT_EQ(listener.accept(10ms), nullptr);
+}
+
+TEST_F(DistributedTest, FlowsOfLostWorkerFailAndOthersTakeOver) {
+    auto reporting   = RecordingReporting{};
+    auto coordinator = std::async(std::launch::async, [&] {
+        distributed::Coordinator<RecordingReporting>{ reporting, endpoint, { "a", "b", "c" } }.run();
+    });
+
+    {
+        auto lost = connect();
+        ASSERT_NE(lost, nullptr);
+        lost->send({ { "type", "hello" }, { "jobs", 1 } });
+        EXPECT_EQ(lost->receive()->at("flow"), "a");
+        lost->send({ { "type", "event" }, { "event", event_json::to_json(SuccessEvent{ "a", 1ms }) } });
+        EXPECT_EQ(lost->receive()->at("flow"), "b");
+    } // disconnects while running b
+
+    auto other = connect();
+    ASSERT_NE(other, nullptr);
+    other->send({ { "type", "hello" }, { "jobs", 1 } });
+    EXPECT_EQ(other->receive()->at("flow"), "c");
+    other->send({ { "type", "event" }, { "event", event_json::to_json(FailureEvent{ "c", "path", {}, "" }) } });
+    EXPECT_EQ(other->receive()->at("type"), "stop");
+
+    ASSERT_EQ(coordinator.wait_for(5s), std::future_status::ready);
+    coordinator.get();
+    EXPECT_EQ(reporting.passed, (std::vector<std::string>{ "a" }));
+    EXPECT_EQ(reporting.failed, (std::vector<std::string>{ "b", "c" }));
+    EXPECT_EQ(reporting.summarized, 1);
+}
+
+TEST_F(DistributedTest, WorkerReportsThroughRemoteRenderer) {
+    auto reporting   = RecordingReporting{};
+    auto coordinator = std::async(std::launch::async, [&] {
+        distributed::Coordinator<RecordingReporting>{ reporting, endpoint, { "a", "b", "missing", "throws" } }.run();
+    });
+
+    auto channel = connect();
+    ASSERT_NE(channel, nullptr);
+
+    auto remote           = RemoteRenderer{ channel.get() };
+    auto deps             = di::Deps<RemoteRenderer>{ remote };
+    auto worker_reporting = FakeScheduler::reporting_t{ deps, true };
+    auto scheduler        = FakeScheduler{ worker_reporting };
+    auto const flows      = std::map<std::string, std::string>{ { "a", "a" }, { "b", "b" }, { "throws", "throws" } };
+    distributed::Worker<FakeScheduler, FakeScheduler::reporting_t>{ scheduler, worker_reporting, *channel, flows, 2 }.run();
+
+    ASSERT_EQ(coordinator.wait_for(5s), std::future_status::ready);
+    coordinator.get();
+    std::sort(std::begin(reporting.passed), std::end(reporting.passed));
+    std::sort(std::begin(reporting.failed), std::end(reporting.failed));
+    EXPECT_EQ(reporting.passed, (std::vector<std::string>{ "a", "b" }));
+    EXPECT_EQ(reporting.failed, (std::vector<std::string>{ "missing", "throws" }));
+    EXPECT_EQ(reporting.latencies, 2);
+}
+
+TEST_F(DistributedTest, SilentPeerDoesNotKeepCoordinatorRunning) {
+    auto reporting   = RecordingReporting{};
+    auto coordinator = std::async(std::launch::async, [&] {
+        distributed::Coordinator<RecordingReporting>{ reporting, endpoint, { "a" } }.run();
+    });
+
+    auto silent = connect(); // never says hello
+    ASSERT_NE(silent, nullptr);
+
+    auto worker = connect();
+    ASSERT_NE(worker, nullptr);
+    worker->send({ { "type", "hello" }, { "jobs", 1 } });
+    EXPECT_EQ(worker->receive()->at("flow"), "a");
+    worker->send({ { "type", "event" }, { "event", event_json::to_json(SuccessEvent{ "a", 1ms }) } });
+
+    ASSERT_EQ(coordinator.wait_for(5s), std::future_status::ready);
+    coordinator.get();
+    EXPECT_EQ(reporting.passed, (std::vector<std::string>{ "a" }));
+    EXPECT_FALSE(silent->receive().has_value());
+}
+
+TEST_F(DistributedTest, MalformedMessageFailsFlowsOfThatWorker) {
+    auto reporting   = RecordingReporting{};
+    auto coordinator = std::async(std::launch::async, [&] {
+        distributed::Coordinator<RecordingReporting>{ reporting, endpoint, { "a", "b" } }.run();
+    });
+
+    {
+        auto broken = connect();
+        ASSERT_NE(broken, nullptr);
+        broken->send({ { "type", "hello" }, { "jobs", 1 } });
+        EXPECT_EQ(broken->receive()->at("flow"), "a");
+        broken->send({ { "type", "event" } }); // no event in it
+        EXPECT_FALSE(broken->receive().has_value());
+    }
+
+    auto worker = connect();
+    ASSERT_NE(worker, nullptr);
+    worker->send({ { "type", "hello" }, { "jobs", 1 } });
+    EXPECT_EQ(worker->receive()->at("flow"), "b");
+    worker->send({ { "type", "event" }, { "event", event_json::to_json(SuccessEvent{ "b", 1ms }) } });
+    EXPECT_EQ(worker->receive()->at("type"), "stop");
+
+    ASSERT_EQ(coordinator.wait_for(5s), std::future_status::ready);
+    coordinator.get();
+    EXPECT_EQ(reporting.passed, (std::vector<std::string>{ "b" }));
+    EXPECT_EQ(reporting.failed, (std::vector<std::string>{ "a" }));
+}
+
+TEST_F(DistributedTest, FlowsOfSilentWorkerAreHandedToOthers) {
+    auto reporting   = RecordingReporting{};
+    auto coordinator = std::async(std::launch::async, [&] {
+        distributed::Coordinator<RecordingReporting>{ reporting, endpoint, { "a", "b" }, nullptr, 400ms }.run();
+    });
+
+    auto silent = connect();
+    ASSERT_NE(silent, nullptr);
+    silent->send({ { "type", "hello" }, { "jobs", 1 } });
+    EXPECT_EQ(silent->receive()->at("flow"), "a");
+    EXPECT_FALSE(silent->receive().has_value()); // dropped once its lease ran out, still connected
+
+    auto worker = connect();
+    ASSERT_NE(worker, nullptr);
+    worker->send({ { "type", "hello" }, { "jobs", 1 } });
+    for(auto i = 0; i < 2; ++i) { // a is back in the queue, possibly only after b was handed out
+        auto const flow = worker->receive()->at("flow").get<std::string>();
+        std::this_thread::sleep_for(250ms); // a heartbeat keeps the lease of a flow running longer than it
+        worker->send({ { "type", "heartbeat" } });
+        std::this_thread::sleep_for(250ms);
+        worker->send({ { "type", "event" }, { "event", event_json::to_json(SuccessEvent{ flow, 1ms }) } });
+    }
+    EXPECT_EQ(worker->receive()->at("type"), "stop");
+
+    ASSERT_EQ(coordinator.wait_for(5s), std::future_status::ready);
+    coordinator.get();
+    std::sort(std::begin(reporting.passed), std::end(reporting.passed));
+    EXPECT_EQ(reporting.passed, (std::vector<std::string>{ "a", "b" }));
+    EXPECT_TRUE(reporting.failed.empty());
+}
+
+TEST_F(DistributedTest, IdleWorkerTakesOverFromWorkerGoingSilentLater) {
+    auto reporting   = RecordingReporting{};
+    auto coordinator = std::async(std::launch::async, [&] {
+        distributed::Coordinator<RecordingReporting>{ reporting, endpoint, { "a", "b" }, nullptr, 400ms }.run();
+    });
+
+    auto worker = connect();
+    ASSERT_NE(worker, nullptr);
+    worker->send({ { "type", "hello" }, { "jobs", 1 } });
+    EXPECT_EQ(worker->receive()->at("flow"), "a");
+
+    auto silent = connect();
+    ASSERT_NE(silent, nullptr);
+    silent->send({ { "type", "hello" }, { "jobs", 1 } });
+    EXPECT_EQ(silent->receive()->at("flow"), "b");
+
+    // the queue is drained, but b may still come back, so the idle worker is kept around
+    auto heartbeat = std::jthread{ [&worker](std::stop_token stop) {
+        while(not stop.stop_requested()) {
+            worker->send({ { "type", "heartbeat" } });
+            std::this_thread::sleep_for(100ms);
+        }
+    } };
+    worker->send({ { "type", "event" }, { "event", event_json::to_json(SuccessEvent{ "a", 1ms }) } });
+    EXPECT_EQ(worker->receive()->at("flow"), "b"); // once the lease of the silent one ran out
+    worker->send({ { "type", "event" }, { "event", event_json::to_json(SuccessEvent{ "b", 1ms }) } });
+    EXPECT_EQ(worker->receive()->at("type"), "stop");
+    heartbeat.request_stop();
+    heartbeat.join();
+
+    ASSERT_EQ(coordinator.wait_for(5s), std::future_status::ready);
+    coordinator.get();
+    EXPECT_EQ(reporting.passed, (std::vector<std::string>{ "a", "b" }));
+    EXPECT_TRUE(reporting.failed.empty());
+}
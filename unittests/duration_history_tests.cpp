@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include <flow/duration_history.hpp>
+#include <temp_suite.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+std::vector<std::string> names_of(std::vector<DurationHistory::Prediction> const &plan) {
+    auto names = std::vector<std::string>{};
+    for(auto const &p : plan)
+        names.push_back(p.name);
+    return names;
+}
+
+using DurationHistoryTest = TempSuite;
+} // namespace
+
+TEST_F(DurationHistoryTest, PersistsWeightedAverage) {
+    auto const path = root / DurationHistory::file_name;
+    {
+        auto history = DurationHistory{ path };
+        EXPECT_FALSE(history.find("a").has_value());
+        history.record("a", 1000ms);
+        history.record("a", 2000ms);
+        history.store();
+    }
+
+    auto const history = DurationHistory{ path };
+    EXPECT_EQ(history.find("a"), 1300ms);
+}
+
+TEST(DurationHistory, PredictsUnknownFlowsAsAverage) {
+    auto history = DurationHistory{ "" };
+    history.record("a", 100ms);
+    history.record("b", 300ms);
+
+    auto const plan = history.predict({ "a", "b", "new" });
+    ASSERT_EQ(plan.size(), 3u);
+    EXPECT_EQ(plan[2].duration, 200ms);
+}
+
+TEST(DurationHistory, LongestFirstShortensMakespan) {
+    auto plan = std::vector<DurationHistory::Prediction>{
+        { "a", 10ms }, { "b", 10ms }, { "c", 10ms }, { "d", 30ms }
+    };
+    EXPECT_EQ(makespan(plan, 2), 40ms); // d starts last on an already busy worker
+
+    sort_longest_first(plan);
+    EXPECT_EQ(names_of(plan), (std::vector<std::string>{ "d", "a", "b", "c" }));
+    EXPECT_EQ(makespan(plan, 2), 30ms);
+    EXPECT_EQ(makespan(plan, 1), 60ms);
+}
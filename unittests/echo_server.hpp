@@ -0,0 +1,82 @@
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+
+/**
+ * @brief Websocket server on an ephemeral local port that sends every message back
+ *
+ * Runs on its own thread so that it only costs the client a loopback round trip.
+ */
+class EchoServer {
+    using tcp = boost::asio::ip::tcp;
+
+    class Session : public std::enable_shared_from_this<Session> {
+        boost::beast::websocket::stream<boost::beast::tcp_stream> ws_;
+        boost::beast::flat_buffer buffer_;
+
+    public:
+        explicit Session(tcp::socket &&socket)
+            : ws_{ std::move(socket) } { }
+
+        void run() {
+            ws_.async_accept([self = shared_from_this()](boost::beast::error_code ec) {
+                if(not ec)
+                    self->read();
+            });
+        }
+
+    private:
+        void read() {
+            ws_.async_read(buffer_, [self = shared_from_this()](boost::beast::error_code ec, std::size_t) {
+                if(ec)
+                    return;
+                self->ws_.text(self->ws_.got_text());
+                self->ws_.async_write(self->buffer_.data(), [self](boost::beast::error_code ec, std::size_t) {
+                    self->buffer_.consume(self->buffer_.size());
+                    if(not ec)
+                        self->read();
+                });
+            });
+        }
+    };
+
+    boost::asio::io_context ctx_;
+    tcp::acceptor acceptor_{ ctx_, { boost::asio::ip::make_address("127.0.0.1"), 0 } };
+    std::thread thread_;
+
+public:
+    EchoServer() {
+        accept();
+        thread_ = std::thread{ [this] { ctx_.run(); } };
+    }
+
+    ~EchoServer() {
+        ctx_.stop();
+        thread_.join();
+    }
+
+    EchoServer(EchoServer const &)            = delete;
+    EchoServer &operator=(EchoServer const &) = delete;
+
+    std::string port() const {
+        return std::to_string(acceptor_.local_endpoint().port());
+    }
+
+private:
+    void accept() {
+        acceptor_.async_accept([this](boost::beast::error_code ec, tcp::socket socket) {
+            if(ec)
+                return;
+            std::make_shared<Session>(std::move(socket))->run();
+            accept();
+        });
+    }
+};
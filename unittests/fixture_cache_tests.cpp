@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+
+#include <flow/exceptions.hpp>
+#include <flow/fixture_cache.hpp>
+#include <flow/timeouts.hpp>
+
+#include <inja/inja.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <latch>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+using cache_t = FixtureCache<inja::json>;
+} // namespace
+
+TEST(FixtureCache, RunsOnceAcrossDependents) {
+    auto cache = cache_t{};
+    auto runs  = 0;
+    auto fn    = [&runs] {
+        ++runs;
+        return inja::json{ { "token", "abc" } };
+    };
+
+    auto const first  = cache.get_or_run("fixtures/login", fn);
+    auto const second = cache.get_or_run("fixtures/login", fn);
+    EXPECT_EQ(runs, 1);
+    EXPECT_EQ(first, second); // the very same snapshot
+    EXPECT_EQ(first->at("token"), "abc");
+
+    cache.get_or_run("fixtures/other", fn);
+    EXPECT_EQ(runs, 2);
+
+    cache.clear();
+    cache.get_or_run("fixtures/login", fn);
+    EXPECT_EQ(runs, 3);
+}
+
+TEST(FixtureCache, ConcurrentDependentsWaitForTheFirstRun) {
+    auto cache = cache_t{};
+    auto runs  = std::atomic_int{ 0 };
+    auto fn    = [&runs] {
+        ++runs;
+        std::this_thread::sleep_for(50ms); // the others arrive while it is still running
+        return inja::json{ { "token", "abc" } };
+    };
+
+    auto dependents = std::vector<std::future<cache_t::snapshot_t>>{};
+    for(auto i = 0; i < 8; ++i)
+        dependents.push_back(std::async(std::launch::async, [&cache, &fn] {
+            return cache.get_or_run("fixtures/login", fn);
+        }));
+
+    auto const first = dependents.front().get();
+    for(auto it = std::next(std::begin(dependents)); it != std::end(dependents); ++it)
+        EXPECT_EQ(it->get(), first);
+    EXPECT_EQ(runs, 1);
+}
+
+TEST(FixtureCache, FailureReachesEveryDependent) {
+    auto cache = cache_t{};
+    auto runs  = 0;
+    auto fn    = [&runs]() -> inja::json {
+        ++runs;
+        throw FlowException("fixtures/login", { { FailureEvent::Data::Type::NOT_EQUAL, "result.status", "Expected success" } }, "No data");
+    };
+
+    // every dependent gets the same exception object, so none of them may take its issues away
+    for(auto i = 0; i < 3; ++i) {
+        try {
+            cache.get_or_run("fixtures/login", fn);
+            ADD_FAILURE() << "fixture failure was not rethrown";
+        } catch(FlowException const &e) {
+            ASSERT_EQ(e.issues.size(), 1u);
+            EXPECT_EQ(e.issues[0].type, FailureEvent::Data::Type::NOT_EQUAL);
+            EXPECT_EQ(e.issues[0].message, "Expected success");
+        }
+    }
+    EXPECT_EQ(runs, 1);
+}
+
+TEST(FixtureCache, DependentsForkTheSnapshot) {
+    auto cache = cache_t{};
+    auto fn    = [] {
+        return inja::json{ { "token", "abc" }, { "count", 1 } };
+    };
+
+    auto first = inja::json{ { "own", true } };
+    first.update(*cache.get_or_run("fixtures/login", fn));
+    first["count"] = 2;
+
+    auto second = inja::json::object();
+    second.update(*cache.get_or_run("fixtures/login", fn));
+
+    EXPECT_EQ(first.at("own"), true);
+    EXPECT_EQ(first.at("count"), 2);
+    EXPECT_EQ(second.at("count"), 1); // changes of one dependent stay with it
+    EXPECT_FALSE(second.contains("own"));
+    EXPECT_EQ(cache.get_or_run("fixtures/login", fn)->at("count"), 1);
+}
+
+TEST(FixtureCache, FixtureWithoutStoreAddsNothing) {
+    auto cache    = cache_t{};
+    auto snapshot = cache.get_or_run("fixtures/noop", [] { return inja::json{}; }); // no env.json, nothing stored
+
+    auto store = inja::json{};
+    cache_t::fork("fixtures/noop", store, snapshot);
+    EXPECT_TRUE(store.is_null());
+
+    store = inja::json{ { "own", true } };
+    cache_t::fork("fixtures/noop", store, snapshot);
+    EXPECT_EQ(store, (inja::json{ { "own", true } }));
+}
+
+TEST(FixtureCache, ForkLeavesOutTheLastResponse) {
+    auto cache    = cache_t{};
+    auto snapshot = cache.get_or_run("fixtures/login", [] {
+        return inja::json{ { "token", "abc" }, { "$res", { { "result", "stale" } } } };
+    });
+
+    auto store = inja::json{ { "$res", { { "result", "own" } } } };
+    cache_t::fork("fixtures/login", store, snapshot);
+    EXPECT_EQ(store.at("token"), "abc");
+    EXPECT_EQ(store.at("$res").at("result"), "own");
+}
+
+TEST(FixtureCache, ForkCopiesOnlyRequestedKeys) {
+    auto cache    = cache_t{};
+    auto snapshot = cache.get_or_run("fixtures/login", [] {
+        return inja::json{ { "token", "abc" }, { "count", 1 } };
+    });
+
+    auto store = inja::json{};
+    cache_t::fork("fixtures/login", store, snapshot, { "token" });
+    EXPECT_EQ(store, (inja::json{ { "token", "abc" } }));
+
+    EXPECT_THROW(cache_t::fork("fixtures/login", store, snapshot, { "missing" }), FlowException);
+}
+
+TEST(FixtureCache, DependentGivesUpAtItsDeadline) {
+    auto cache    = cache_t{};
+    auto started  = std::latch{ 1 };
+    auto release  = std::promise<void>{};
+    auto finished = release.get_future().share();
+    auto fixture  = std::async(std::launch::async, [&] {
+        return cache.get_or_run("fixtures/slow", [&] {
+            started.count_down();
+            finished.wait();
+            return inja::json{ { "done", true } };
+        });
+    });
+    started.wait();
+
+    {
+        auto deadline = Timeouts::Scope{ "Flow dependent", 50ms };
+        try {
+            cache.get_or_run("fixtures/slow", [] { return inja::json{}; });
+            ADD_FAILURE() << "waited past the deadline";
+        } catch(FlowException const &e) {
+            ASSERT_EQ(e.issues.size(), 1u);
+            EXPECT_EQ(e.issues.front().type, FailureEvent::Data::Type::TIMEOUT);
+        }
+    }
+
+    release.set_value();
+    EXPECT_EQ(fixture.get()->at("done"), true);
+    EXPECT_EQ(cache.get_or_run("fixtures/slow", [] { return inja::json{}; })->at("done"), true); // a later dependent still gets it
+}
+
+TEST(FixtureCache, FixtureDependingOnItselfFails) {
+    auto cache = cache_t{};
+    auto fn    = [&cache] {
+        return inja::json{ { "inner", *cache.get_or_run("fixtures/a", [] { return inja::json{}; }) } };
+    };
+    EXPECT_THROW(cache.get_or_run("fixtures/a", fn), FlowException);
+    EXPECT_THROW(cache.get_or_run("fixtures/a", fn), FlowException); // the failure is kept
+}
+
+TEST(FixtureCache, CycleAcrossThreadsFails) {
+    auto cache   = cache_t{};
+    auto started = std::latch{ 2 };
+    auto run     = [&cache, &started](std::string const &self, std::string const &other) {
+        return cache.get_or_run(self, [&] {
+            started.arrive_and_wait(); // both fixtures are running before either needs the other
+            return inja::json{ { "other", *cache.get_or_run(other, [] { return inja::json{}; }) } };
+        });
+    };
+
+    auto a = std::async(std::launch::async, run, "fixtures/a", "fixtures/b");
+    auto b = std::async(std::launch::async, run, "fixtures/b", "fixtures/a");
+    ASSERT_EQ(a.wait_for(5s), std::future_status::ready);
+    ASSERT_EQ(b.wait_for(5s), std::future_status::ready);
+    EXPECT_THROW(a.get(), FlowException);
+    EXPECT_THROW(b.get(), FlowException);
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <flow/incremental_run.hpp>
+#include <flow/input_hasher.hpp>
+#include <flow/results_db.hpp>
+#include <temp_suite.hpp>
+#include <util/directory_watcher.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string>
+
+namespace {
+struct IncrementalTest : public TempSuite {
+    std::filesystem::path flows = root / "flows";
+    std::filesystem::path db    = root / ResultsDb::file_name;
+
+    void SetUp() override {
+        std::filesystem::create_directories(root / "common");
+        for(auto const *flow : { "a", "b", "setup" })
+            std::filesystem::create_directories(flows / flow);
+
+        write(root / "common" / "partial.j2", R"({"method": "server_info"})");
+        write(flows / "a" / "request.json.j2", R"({% include "../../common/partial.j2" %})");
+        write(flows / "a" / "script.yaml", R"(
+steps:
+- type: run_flow
+  name: setup
+  fixture: true
+- type: request
+  file: request.json.j2
+)");
+        write(flows / "b" / "request.json.j2", "{}");
+        write(flows / "b" / "script.yaml", "steps:\n- type: request\n  file: request.json.j2\n");
+        write(flows / "setup" / "request.json.j2", "{}");
+        write(flows / "setup" / "script.yaml", "steps:\n- type: request\n  file: request.json.j2\n");
+    }
+
+    std::uint64_t hash_of(std::string const &flow) const {
+        return InputHasher{}.flow(flows / flow / "");
+    }
+};
+} // namespace
+
+TEST_F(IncrementalTest, HashIsStable) {
+    EXPECT_EQ(hash_of("a"), hash_of("a"));
+    EXPECT_NE(hash_of("a"), hash_of("b"));
+}
+
+TEST_F(IncrementalTest, PartialChangeAffectsIncludingFlowsOnly) {
+    auto const a = hash_of("a");
+    auto const b = hash_of("b");
+    write(root / "common" / "partial.j2", R"({"method": "ledger"})");
+    EXPECT_NE(hash_of("a"), a);
+    EXPECT_EQ(hash_of("b"), b);
+}
+
+TEST_F(IncrementalTest, SubflowAndEnvChangesAffectCaller) {
+    auto const a = hash_of("a");
+    write(flows / "setup" / "request.json.j2", R"({"id": 2})");
+    auto const after_subflow = hash_of("a");
+    EXPECT_NE(after_subflow, a);
+
+    write(flows / "a" / "env.json", R"({"id": 1})");
+    EXPECT_NE(hash_of("a"), after_subflow);
+}
+
+TEST_F(IncrementalTest, ResultsDbRoundTrip) {
+    {
+        auto results = ResultsDb{ db };
+        results.update("127.0.0.1:51233", "a", { 0xdeadbeefcafef00d, true });
+        results.update("127.0.0.1:51234", "a", { 1, false });
+        results.store();
+    }
+
+    auto const results = ResultsDb{ db };
+    auto const a       = results.find("127.0.0.1:51233", "a");
+    ASSERT_TRUE(a.has_value());
+    EXPECT_EQ(a->hash, 0xdeadbeefcafef00d);
+    EXPECT_TRUE(a->passed);
+    EXPECT_FALSE(results.find("127.0.0.1:51234", "a")->passed);
+    EXPECT_FALSE(results.find("127.0.0.1:51233", "b").has_value());
+}
+
+TEST_F(IncrementalTest, SkipsOnlyUnchangedPassingFlows) {
+    {
+        auto run = IncrementalRun{ db, "server" };
+        run.begin();
+        EXPECT_FALSE(run.is_up_to_date("a", flows / "a" / ""));
+        EXPECT_FALSE(run.is_up_to_date("b", flows / "b" / ""));
+        run.record("a", true);
+        run.record("b", false);
+        run.finish();
+    }
+
+    auto run = IncrementalRun{ db, "server" };
+    run.begin();
+    EXPECT_TRUE(run.is_up_to_date("a", flows / "a" / ""));
+    EXPECT_FALSE(run.is_up_to_date("b", flows / "b" / "")); // failed last time
+
+    write(flows / "a" / "request.json.j2", "{}");
+    run.begin();
+    EXPECT_FALSE(run.is_up_to_date("a", flows / "a" / ""));
+
+    auto other_server = IncrementalRun{ db, "other" };
+    other_server.begin();
+    EXPECT_FALSE(other_server.is_up_to_date("a", flows / "a" / ""));
+}
+
+TEST_F(IncrementalTest, WatcherSkipsDirectoriesGoneBeforeTheyAreWatched) {
+    using namespace std::chrono_literals;
+    auto watcher = util::DirectoryWatcher{ flows };
+
+    std::filesystem::create_directories(flows / "c" / "nested");
+    std::filesystem::remove_all(flows / "c");
+    write(flows / "a" / "request.json.j2", "{}");
+
+    auto const changed = watcher.wait(50ms);
+    EXPECT_NE(std::find(std::begin(changed), std::end(changed), flows / "a" / "request.json.j2"), std::end(changed));
+}
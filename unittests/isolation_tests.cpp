@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <isolation/fork_server.hpp>
+#include <reporting/event_json.hpp>
+#include <reporting/pipe_renderer.hpp>
+
+#include <inja/inja.hpp>
+
+#include <chrono>
+#include <csignal>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+// behaves according to the name of the flow, inside the child process
+void runner(std::string const &name, std::string const &dir, isolation::FrameWriter &out) {
+    auto renderer = PipeRenderer{ &out };
+    if(name == "crash")
+        std::raise(SIGSEGV);
+    if(name == "hang")
+        std::this_thread::sleep_for(1h);
+    if(name == "garbage") {
+        auto const frame = std::vector<std::uint8_t>{ 0xc1 }; // never valid msgpack
+        out.write(frame);
+        std::this_thread::sleep_for(1h);
+    }
+    if(name == "large")
+        renderer(SimpleEvent{ "LARGE", std::string(100000, 'x') });
+
+    renderer(SimpleEvent{ "RUNNING", dir });
+    renderer(SuccessEvent{ name, 5ms });
+}
+
+std::vector<inja::json> run(isolation::ForkServer &server, std::string const &name, std::chrono::milliseconds limit = 0ms,
+    isolation::ForkServer::Exit expected = isolation::ForkServer::Exit::COMPLETED) {
+    auto events = std::vector<inja::json>{};
+    auto exit   = server.run(name, "flows/" + name, limit, [&events](std::vector<std::uint8_t> const &frame) {
+        events.push_back(inja::json::from_msgpack(frame));
+    });
+    EXPECT_EQ(exit, expected);
+    return events;
+}
+} // namespace
+
+TEST(ForkServer, StreamsEventsOfTheChild) {
+    auto server = isolation::ForkServer{ runner };
+    auto events = run(server, "flow");
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(event_json::to_simple(events[0]).message, "flows/flow");
+    EXPECT_EQ(event_json::to_success(events[1]).flow_name, "flow");
+
+    events = run(server, "large"); // larger than the pipe buffer
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_EQ(events[0].at("message").get<std::string>().size(), 100000u);
+}
+
+TEST(ForkServer, CrashLosesOnlyThatFlow) {
+    auto server = isolation::ForkServer{ runner };
+    EXPECT_TRUE(run(server, "crash").empty());
+    EXPECT_EQ(run(server, "flow").size(), 2u);
+}
+
+TEST(ForkServer, KillsChildAfterWallClockLimit) {
+    auto server  = isolation::ForkServer{ runner };
+    auto started = std::chrono::steady_clock::now();
+    EXPECT_TRUE(run(server, "hang", 100ms, isolation::ForkServer::Exit::TIMED_OUT).empty());
+    EXPECT_LT(std::chrono::steady_clock::now() - started, 5s);
+    EXPECT_EQ(run(server, "flow", 5s).size(), 2u);
+}
+
+TEST(ForkServer, FailingSinkKillsOnlyThatChild) {
+    auto server  = isolation::ForkServer{ runner };
+    auto started = std::chrono::steady_clock::now();
+    EXPECT_THROW(run(server, "garbage"), inja::json::exception);
+    EXPECT_LT(std::chrono::steady_clock::now() - started, 5s);
+    EXPECT_EQ(run(server, "flow").size(), 2u);
+}
+
+TEST(ForkServer, RequestTooLargeFailsOnlyThatFlow) {
+    auto server = isolation::ForkServer{ runner };
+    EXPECT_THROW(run(server, std::string(10000, 'x')), std::runtime_error);
+    EXPECT_EQ(run(server, "flow").size(), 2u);
+}
+
+TEST(ForkServer, RunsFlowsConcurrently) {
+    auto server  = isolation::ForkServer{ runner };
+    auto results = std::vector<std::future<std::size_t>>{};
+    for(auto i = 0; i < 8; ++i)
+        results.push_back(std::async(std::launch::async, [&server, i] {
+            return run(server, "flow" + std::to_string(i)).size();
+        }));
+    for(auto &result : results)
+        EXPECT_EQ(result.get(), 2u);
+}
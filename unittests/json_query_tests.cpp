@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <util/json_query.hpp>
+
+#include <inja/inja.hpp>
+
+#include <cstdint>
+#include <limits>
+
+using namespace util::json_query;
+
+namespace {
+auto const data = inja::json::parse(R"({
+    "result": {
+        "ledger_index": 123,
+        "transactions": [
+            { "hash": "C", "tx": { "Fee": "12", "Sequence": 3 } },
+            { "hash": "A", "tx": { "Fee": "10", "Sequence": 1 } },
+            { "hash": "B", "tx": { "Fee": "15", "Sequence": 2 } }
+        ],
+        "a/b": { "c~d": true }
+    }
+})");
+auto const &txs = data["result"]["transactions"];
+} // namespace
+
+TEST(JsonQuery, FindByPointerAndPath) {
+    EXPECT_EQ(find(data, "/result/ledger_index"), &data["result"]["ledger_index"]);
+    EXPECT_EQ(*find(data, "/result/transactions/1/hash"), "A");
+    EXPECT_EQ(*find(data, "/result/a~1b/c~0d"), true);
+    EXPECT_EQ(*find(data, "$.result.transactions[2].tx.Sequence"), 2);
+    EXPECT_EQ(*find(data, "result.transactions[0]['hash']"), "C");
+    EXPECT_EQ(find(data, ""), &data);
+
+    EXPECT_EQ(find(data, "/result/missing"), nullptr);
+    EXPECT_EQ(find(data, "result.transactions[3]"), nullptr);
+    EXPECT_EQ(find(data, "result.ledger_index.deeper"), nullptr);
+
+    EXPECT_THROW(find(data, "/result/a~2b"), std::invalid_argument);
+    EXPECT_THROW(find(data, "/result/a~"), std::invalid_argument);
+}
+
+TEST(JsonQuery, FindStoreKeyStartingWithDollar) {
+    auto const store = inja::json{ { "$res", data }, { "res", 1 } };
+    EXPECT_EQ(*find(store, "$res.result.ledger_index"), 123);
+    EXPECT_EQ(*find(store, "$res"), data);
+    EXPECT_EQ(*find(store, "$.res"), 1);
+    EXPECT_EQ(*find(store, "$['$res'].result.ledger_index"), 123);
+    EXPECT_EQ(find(store, "$"), &store);
+}
+
+TEST(JsonQuery, Length) {
+    EXPECT_EQ(length(txs), 3u);
+    EXPECT_EQ(length(data["result"]), 3u);
+    EXPECT_EQ(length(inja::json("abcd")), 4u);
+    EXPECT_EQ(length(inja::json(42)), 0u);
+}
+
+TEST(JsonQuery, Slice) {
+    EXPECT_EQ(pluck(slice(txs, 1, 3), "hash"), inja::json::parse(R"(["A", "B"])"));
+    EXPECT_EQ(pluck(slice(txs, -2, 100), "hash"), inja::json::parse(R"(["A", "B"])"));
+    EXPECT_EQ(slice(txs, 2, 1), inja::json::array());
+    EXPECT_THROW(slice(data, 0, 1), std::invalid_argument);
+}
+
+TEST(JsonQuery, PluckAndFindBy) {
+    EXPECT_EQ(pluck(txs, "/tx/Sequence"), inja::json::parse("[3, 1, 2]"));
+    EXPECT_EQ(pluck(txs, "missing"), inja::json::parse("[null, null, null]"));
+    EXPECT_EQ(find_by(txs, "tx.Sequence", 2)["hash"], "B");
+    EXPECT_TRUE(find_by(txs, "hash", "Z").is_null());
+}
+
+TEST(JsonQuery, Sum) {
+    EXPECT_EQ(sum(txs, "/tx/Fee"), 37);
+    EXPECT_EQ(sum(txs, "tx.Sequence"), 6);
+    EXPECT_DOUBLE_EQ(sum(inja::json::parse("[1, 0.5]")).get<double>(), 1.5);
+    EXPECT_THROW(sum(txs), std::invalid_argument);
+
+    auto const big = std::numeric_limits<std::uint64_t>::max() - 1;
+    EXPECT_EQ(sum(inja::json::array({ big, 1u })).get<std::uint64_t>(), big + 1);
+    EXPECT_EQ(sum(inja::json::array({ big, -2 })).get<std::uint64_t>(), big - 2);
+    EXPECT_EQ(sum(inja::json::array({ "18446744073709551614", 1 })).get<std::uint64_t>(), big + 1);
+    EXPECT_EQ(sum(inja::json::parse("[-3, 1]")), -2);
+    EXPECT_GT(sum(inja::json::array({ big, big })).get<double>(), 3.6e19); // too large for any integer
+}
+
+TEST(JsonQuery, SortBy) {
+    EXPECT_EQ(pluck(sort_by(txs, "hash"), "hash"), inja::json::parse(R"(["A", "B", "C"])"));
+    EXPECT_EQ(pluck(sort_by(txs, "/tx/Sequence"), "hash"), inja::json::parse(R"(["A", "B", "C"])"));
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <reporting/latency_stats.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+LatencyEvent exchange(std::string const &flow, std::string const &path, std::string const &method, LatencyEvent::duration_t total) {
+    return LatencyEvent{ flow, path, method, 10us, total / 2, total, 100, 1000 };
+}
+} // namespace
+
+TEST(LatencyStats, NearestRankPercentile) {
+    auto histogram = LatencyStats::Histogram{};
+    for(int i = 1; i <= 100; ++i)
+        histogram.record(LatencyEvent::duration_t{ i });
+
+    // exact below twice LatencyStats::Histogram::sub_buckets, the highest value of a bucket of two above
+    EXPECT_EQ(histogram.percentile(25), 25us);
+    EXPECT_EQ(histogram.percentile(50), 50us);
+    EXPECT_EQ(histogram.percentile(90), 91us);
+    EXPECT_EQ(histogram.percentile(99), 99us);
+    EXPECT_EQ(histogram.percentile(100), 100us);
+    EXPECT_EQ(histogram.count(), 100u);
+    EXPECT_EQ(histogram.max(), 100us);
+
+    auto single = LatencyStats::Histogram{};
+    single.record(7us);
+    EXPECT_EQ(single.percentile(99), 7us);
+}
+
+TEST(LatencyStats, HistogramBucketsAreBoundedAndClose) {
+    using histogram_t = LatencyStats::Histogram;
+
+    auto last = std::size_t{ 0 };
+    for(auto micros = std::uint64_t{ 1 }; micros < (std::uint64_t{ 1 } << 62); micros += micros / 7 + 1) {
+        auto const bucket = histogram_t::bucket_of(micros);
+        EXPECT_GE(bucket, last) << micros; // monotonic
+        EXPECT_GE(histogram_t::highest_in(bucket), micros);
+        EXPECT_LT(histogram_t::highest_in(bucket) - micros, micros / histogram_t::sub_buckets + 1) << micros;
+        last = bucket;
+    }
+    EXPECT_LT(histogram_t::bucket_of(std::numeric_limits<std::int64_t>::max()), 64 * histogram_t::sub_buckets);
+
+    // a million exchanges of the same request keep a handful of counters, not a million samples
+    auto histogram = histogram_t{};
+    for(auto i = 0; i < 1'000'000; ++i)
+        histogram.record(LatencyEvent::duration_t{ 1000 + i % 100 });
+    EXPECT_EQ(histogram.count(), 1'000'000u);
+    EXPECT_EQ(histogram.max(), 1099us);
+    EXPECT_NEAR(static_cast<double>(histogram.percentile(50).count()), 1050.0, 1050.0 / histogram_t::sub_buckets);
+}
+
+TEST(LatencyStats, GroupsAndKeepsSlowest) {
+    auto stats = LatencyStats{ 2 };
+    stats.record(exchange("a", "a/1.json", "ledger", 100us));
+    stats.record(exchange("a", "a/2.json", "account_info", 300us));
+    stats.record(exchange("b", "b/1.json", "ledger", 200us));
+    stats.record(exchange("b", "b/2.json", "", 50us));
+    EXPECT_EQ(stats.size(), 4u);
+
+    auto const summary = stats.summarize();
+    ASSERT_EQ(summary.flows.size(), 2u);
+    EXPECT_EQ(summary.flows[0].key, "a"); // worst p99 first
+    EXPECT_EQ(summary.flows[0].count, 2u);
+    EXPECT_EQ(summary.flows[0].max, 300us);
+    EXPECT_EQ(summary.templates.size(), 4u);
+
+    ASSERT_EQ(summary.methods.size(), 3u);
+    EXPECT_EQ(summary.methods[0].key, "account_info");
+    EXPECT_EQ(summary.methods[1].key, "ledger");
+    EXPECT_EQ(summary.methods[1].p50, 101us); // 100us shares its bucket with 101us
+    EXPECT_EQ(summary.methods[2].key, "<none>");
+
+    ASSERT_EQ(summary.slowest.size(), 2u);
+    EXPECT_EQ(summary.slowest[0].path, "a/2.json");
+    EXPECT_EQ(summary.slowest[1].path, "b/1.json");
+}
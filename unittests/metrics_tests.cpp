@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <metrics/registry.hpp>
+#include <metrics/usage.hpp>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+TEST(Metrics, HistogramIsCumulative) {
+    auto histogram = metrics::Histogram{};
+    histogram.observe(500us);
+    histogram.observe(3ms);
+    histogram.observe(20s);
+
+    std::string out;
+    histogram.render(out, "latency", "help");
+    EXPECT_NE(out.find("# TYPE latency histogram\n"), std::string::npos);
+    EXPECT_NE(out.find("latency_bucket{le=\"0.001\"} 1\n"), std::string::npos);
+    EXPECT_NE(out.find("latency_bucket{le=\"0.0025\"} 1\n"), std::string::npos);
+    EXPECT_NE(out.find("latency_bucket{le=\"0.005\"} 2\n"), std::string::npos);
+    EXPECT_NE(out.find("latency_bucket{le=\"10\"} 2\n"), std::string::npos);
+    EXPECT_NE(out.find("latency_bucket{le=\"+Inf\"} 3\n"), std::string::npos);
+    EXPECT_NE(out.find("latency_count 3\n"), std::string::npos);
+}
+
+TEST(Metrics, RegistryRendersOpenMetrics) {
+    auto &registry = metrics::Registry::instance();
+    registry.response("account_info");
+    registry.response("account_info");
+
+    auto const out = registry.render();
+    EXPECT_NE(out.find("cliot_responses_total{method=\"account_info\"} 2\n"), std::string::npos);
+    EXPECT_NE(out.find("# TYPE cliot_requests counter\n"), std::string::npos);
+    EXPECT_EQ(out.substr(out.size() - 6), "# EOF\n");
+}
+
+TEST(Metrics, ResponsesFromAllThreadsAddUp) {
+    auto &registry = metrics::Registry::instance();
+    {
+        auto threads = std::vector<std::jthread>{};
+        for(auto i = 0; i < 4; ++i)
+            threads.emplace_back([&registry] {
+                for(auto j = 0; j < 100; ++j)
+                    registry.response("ledger");
+            });
+    }
+
+    EXPECT_NE(registry.render().find("cliot_responses_total{method=\"ledger\"} 400\n"), std::string::npos);
+}
+
+TEST(Metrics, UsageIsTrackedPerThread) {
+    auto const before = metrics::snapshot();
+    {
+        auto timed = metrics::Timed{ &metrics::Usage::render };
+        ++metrics::usage().frames;
+        metrics::usage().bytes_received += 42;
+    }
+
+    auto const used = metrics::snapshot() - before;
+    EXPECT_EQ(used.frames, 1u);
+    EXPECT_EQ(used.bytes_received, 42u);
+    EXPECT_GE(used.render.count(), 0);
+    EXPECT_EQ(used.validation.count(), 0);
+    EXPECT_GT(used.peak_rss_kb, 0u);
+
+    auto other = metrics::Usage{};
+    std::thread{ [&other] {
+        ++metrics::usage().frames;
+        other = metrics::usage();
+    } }.join();
+    EXPECT_EQ(other.frames, 1u);
+    EXPECT_EQ((metrics::snapshot() - before).frames, 1u); // untouched by the other thread
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include <reporting/json_lines_renderer.hpp>
+#include <reporting/junit_renderer.hpp>
+#include <reporting/merge.hpp>
+#include <reporting/report_engine.hpp>
+#include <temp_suite.hpp>
+
+#include <di.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+struct RecordingRenderer {
+    mutable std::vector<std::string> seen;
+    mutable int flushes = 0;
+
+    void operator()(SimpleEvent const &ev) const {
+        seen.push_back(ev.label);
+    }
+    void operator()(SuccessEvent const &ev) const {
+        seen.push_back(ev.flow_name);
+    }
+    void flush() const {
+        ++flushes;
+    }
+};
+
+struct SuccessOnlyRenderer {
+    mutable std::vector<std::string> seen;
+
+    void operator()(SuccessEvent const &ev) const {
+        seen.push_back(ev.flow_name);
+    }
+    void flush() const { }
+};
+
+using ReportingFilesTest = TempSuite;
+} // namespace
+
+TEST(ReportEngine, FansOutToEveryRendererThatHandlesTheEvent) {
+    auto all     = RecordingRenderer{};
+    auto success = SuccessOnlyRenderer{};
+
+    for(auto sync : { true, false }) {
+        all.seen.clear();
+        success.seen.clear();
+        {
+            auto deps      = di::Deps<RecordingRenderer, SuccessOnlyRenderer>{ all, success };
+            auto reporting = ReportEngine<RecordingRenderer, SuccessOnlyRenderer>{ deps, sync };
+            reporting.record(SimpleEvent{ "RUNNING", "flow" });
+            reporting.record(SuccessEvent{ "flow", 5ms });
+            reporting.record(FailureEvent{ "other", "path", {}, "" }); // nobody handles it
+        }
+        EXPECT_EQ(all.seen, (std::vector<std::string>{ "RUNNING", "flow" }));
+        EXPECT_EQ(success.seen, (std::vector<std::string>{ "flow" }));
+        EXPECT_GT(all.flushes, 0);
+    }
+}
+
+TEST(ReportEngine, BlockedProducersWaitForTheRenderer) {
+    auto all = RecordingRenderer{};
+    {
+        auto deps      = di::Deps<RecordingRenderer>{ all };
+        auto reporting = ReportEngine<RecordingRenderer>{ deps, false, 2, ReportOverflow::BLOCK };
+        auto producers = std::vector<std::thread>{};
+        for(auto i = 0; i < 4; ++i)
+            producers.emplace_back([&reporting] {
+                for(auto j = 0; j < 500; ++j) // far more than fits, so they park on the full queue
+                    reporting.record(SimpleEvent{ "RUNNING", "flow" });
+            });
+        for(auto &producer : producers)
+            producer.join();
+    }
+    EXPECT_EQ(all.seen.size(), 2000u);
+}
+
+TEST_F(ReportingFilesTest, JUnitRendersResultsWithDurations) {
+    auto const path = (root / "junit.xml").string();
+    auto xml        = std::string{};
+    {
+        auto junit = JUnitRenderer{ path };
+        junit(SuccessEvent{ "good <flow>", 1500ms });
+        junit(FailureEvent{ "bad", "bad/2.json",
+            { { FailureEvent::Data::Type::NOT_EQUAL, "result.ledger_index", "Expected 1 got 2" } },
+            "{}", 250ms });
+        xml = junit.render();
+    }
+    EXPECT_TRUE(std::filesystem::remove(path)); // written on destruction
+
+    EXPECT_NE(xml.find("<testsuite name=\"cliot\" tests=\"2\" failures=\"1\" errors=\"0\" skipped=\"0\" time=\"1.750\">"), std::string::npos);
+    EXPECT_NE(xml.find("<testcase classname=\"cliot\" name=\"good &lt;flow&gt;\" time=\"1.500\"/>"), std::string::npos);
+    EXPECT_NE(xml.find("<failure message=\"Expected 1 got 2\">result.ledger_index: Expected 1 got 2\n"), std::string::npos);
+}
+
+TEST_F(ReportingFilesTest, MergeJsonLinesCombinesShardsAndRecomputesSummaries) {
+    auto const write_shard = [this](std::string const &name, std::string const &flow, bool passed, LatencyEvent::duration_t total) {
+        auto const out = JsonLinesRenderer{ (root / name).string() };
+        out(LatencyEvent{ flow, flow + "/1.json", "ledger", 10us, 20us, total, 100, 200 });
+        if(passed)
+            out(SuccessEvent{ flow, 5ms });
+        else
+            out(FailureEvent{ flow, flow + "/2.json", {}, "{}", 5ms });
+        out(UsageSummaryEvent{ { { flow, passed, 5ms, {} } } });
+        out(LatencySummaryEvent{ {}, {}, {}, {} });
+        return root / name;
+    };
+
+    auto const inputs = std::vector<std::filesystem::path>{
+        write_shard("1.jsonl", "b", true, 100us),
+        write_shard("2.jsonl", "a", false, 300us)
+    };
+    auto const summary = merge_json_lines(inputs, root / "merged.jsonl");
+    EXPECT_EQ(summary.passed, 1u);
+    EXPECT_EQ(summary.failed, 1u);
+
+    auto lines = std::vector<inja::json>{};
+    auto in    = std::ifstream{ root / "merged.jsonl" };
+    for(auto text = std::string{}; std::getline(in, text);)
+        lines.push_back(inja::json::parse(text));
+
+    // 2 latency and 2 results, then one usage and one latency summary for both shards
+    ASSERT_EQ(lines.size(), 6u);
+    EXPECT_EQ(lines[0]["shard"], 1);
+    EXPECT_EQ(lines[4]["event"], "usage_summary");
+    EXPECT_EQ(lines[4]["flows"].size(), 2u);
+    EXPECT_EQ(lines[4]["flows"][0]["flow"], "a");
+    EXPECT_EQ(lines[5]["event"], "latency_summary");
+    EXPECT_EQ(lines[5]["methods"][0]["count"], 2);
+    EXPECT_EQ(lines[5]["methods"][0]["max_us"], 300);
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include <util/ring_buffer.hpp>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+TEST(RingBuffer, FifoAndCapacity) {
+    util::RingBuffer<std::unique_ptr<int>> queue{ 3 };
+    EXPECT_EQ(queue.capacity(), 4u);
+
+    for(int i = 0; i < 4; ++i)
+        EXPECT_TRUE(queue.try_push(std::make_unique<int>(i)));
+    auto extra = std::make_unique<int>(42);
+    EXPECT_FALSE(queue.try_push(extra));
+    ASSERT_TRUE(extra); // untouched if not enqueued
+    EXPECT_EQ(queue.size(), 4u);
+
+    std::unique_ptr<int> out;
+    for(int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.try_pop(out));
+        EXPECT_EQ(*out, i);
+    }
+    EXPECT_FALSE(queue.try_pop(out));
+}
+
+TEST(RingBuffer, ConcurrentProducersAndConsumers) {
+    constexpr int producers  = 4;
+    constexpr int consumers  = 4;
+    constexpr int per_thread = 20000;
+
+    util::RingBuffer<int> queue{ 64 };
+    std::atomic<long long> sum = 0;
+    std::atomic<int> consumed  = 0;
+    std::vector<std::thread> threads;
+
+    for(int p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue] {
+            for(int i = 1; i <= per_thread; ++i) {
+                while(not queue.try_push(i))
+                    std::this_thread::yield();
+            }
+        });
+    }
+    for(int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&] {
+            int value;
+            while(consumed.load() < producers * per_thread) {
+                if(queue.try_pop(value)) {
+                    sum += value;
+                    ++consumed;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for(auto &thread : threads)
+        thread.join();
+
+    EXPECT_EQ(sum.load(), static_cast<long long>(producers) * per_thread * (per_thread + 1) / 2);
+}
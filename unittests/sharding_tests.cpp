@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <flow/sharding.hpp>
+#include <temp_suite.hpp>
+
+#include <filesystem>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+struct ShardingTest : public TempSuite {
+    std::filesystem::path flows = root / "flows";
+    std::map<std::string, std::string> dirs;
+
+    void SetUp() override {
+        add("fixture", "steps: []\n");
+        add("helper", "steps:\n- type: run_flow\n  name: fixture\n  fixture: true\n");
+        add("uses_fixture", "steps:\n- type: block\n  repeat: 2\n  steps:\n  - type: run_flow\n    name: fixture\n    fixture: true\n");
+        add("uses_helper", "steps:\n- type: run_flow\n  name: helper\n");
+        add("standalone_a", "steps: []\n");
+        add("standalone_b", "steps: []\n");
+        add("standalone_c", "steps: []\n");
+        dirs.erase("helper"); // only reachable as a subflow, e.g. excluded by a filter
+    }
+
+    void add(std::string const &name, std::string const &script) {
+        write(flows / name / "script.yaml", script);
+        dirs[name] = (flows / name / "").string();
+    }
+};
+} // namespace
+
+TEST(Shard, Parse) {
+    auto const shard = Shard::parse("2/4");
+    EXPECT_EQ(shard.index, 2u);
+    EXPECT_EQ(shard.count, 4u);
+
+    for(auto const *bad : { "0/4", "5/4", "1", "a/b", "1/4x", "/4" })
+        EXPECT_THROW(Shard::parse(bad), std::runtime_error) << bad;
+}
+
+TEST_F(ShardingTest, GroupsFlowsSharingFixtures) {
+    auto const groups = group_by_fixtures(dirs);
+    EXPECT_EQ(groups,
+        (std::vector<std::vector<std::string>>{
+            { "fixture", "uses_fixture", "uses_helper" },
+            { "standalone_a" },
+            { "standalone_b" },
+            { "standalone_c" } }));
+}
+
+TEST_F(ShardingTest, ShardsAreDisjointCompleteAndBalanced) {
+    auto history = DurationHistory{ "" };
+    history.record("fixture", 100ms);
+    history.record("uses_fixture", 100ms);
+    history.record("uses_helper", 100ms);
+    history.record("standalone_a", 200ms);
+    history.record("standalone_b", 50ms);
+    history.record("standalone_c", 50ms);
+
+    auto seen = std::set<std::string>{};
+    for(auto i = 1u; i <= 2u; ++i) {
+        auto const shard = select_shard(dirs, { i, 2 }, history);
+        for(auto const &name : shard)
+            EXPECT_TRUE(seen.insert(name).second) << name << " is in more than one shard";
+        EXPECT_EQ(shard, select_shard(dirs, { i, 2 }, history)); // deterministic
+    }
+    EXPECT_EQ(seen.size(), dirs.size());
+
+    // 300ms of fixture users against 200 + 50 + 50
+    EXPECT_EQ(select_shard(dirs, { 1, 2 }, history), (std::set<std::string>{ "fixture", "uses_fixture", "uses_helper" }));
+}
+
+TEST_F(ShardingTest, BalancesByCountWithoutHistory) {
+    auto const history = DurationHistory{ "" };
+    auto sizes         = std::vector<std::size_t>{};
+    for(auto i = 1u; i <= 3u; ++i)
+        sizes.push_back(select_shard(dirs, { i, 3 }, history).size());
+    EXPECT_EQ(sizes, (std::vector<std::size_t>{ 3, 2, 1 }));
+}
+
+TEST_F(ShardingTest, ShardsRunInSequenceShareTheHistory) {
+    auto const path = root / DurationHistory::file_name;
+    {
+        auto history = DurationHistory{ path };
+        for(auto const &[name, dir] : dirs)
+            history.record(name, 100ms);
+        history.store();
+    }
+
+    // every shard runs like cliot does with --shard: it loads the shared history and reports what it ran
+    auto seen = std::set<std::string>{};
+    for(auto i = 1u; i <= 2u; ++i) {
+        auto history = DurationHistory{ path };
+        history.freeze();
+        auto const shard = select_shard(dirs, { i, 2 }, history);
+        for(auto const &name : shard) {
+            EXPECT_TRUE(seen.insert(name).second) << name << " is in more than one shard";
+            history.record(name, 5000ms); // would move the flows that ran into the other shard
+        }
+        history.store();
+    }
+    EXPECT_EQ(seen.size(), dirs.size());
+    EXPECT_EQ(DurationHistory{ path }.find("standalone_a"), 100ms);
+}
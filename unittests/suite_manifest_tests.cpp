@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <flow/suite_manifest.hpp>
+#include <temp_suite.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+struct SuiteManifestTest : public TempSuite {
+    std::filesystem::path flows    = root / "flows";
+    std::filesystem::path manifest = root / SuiteManifest::file_name;
+
+    void SetUp() override {
+        for(auto const *flow : { "a", "b", ".hidden" }) {
+            std::filesystem::create_directories(flows / flow);
+            write(flows / flow / "script.yaml", "{}");
+        }
+        write(flows / "a" / "2.json", "{}");
+        write(flows / "a" / "1.json", "{}");
+        write(flows / "a" / "env.json", "{}");
+        std::filesystem::create_directories(flows / "no_script");
+        write(flows / "no_script" / "1.json", "{}");
+    }
+};
+} // namespace
+
+TEST_F(SuiteManifestTest, WalksColdAndReusesWarm) {
+    {
+        auto cold    = SuiteManifest{ flows, manifest };
+        auto entries = cold.entries();
+        EXPECT_EQ(cold.walked(), 3u);
+        ASSERT_EQ(entries.size(), 3u);
+        EXPECT_TRUE(entries.at("a").has_script);
+        EXPECT_TRUE(entries.at("a").has_env);
+        EXPECT_EQ(entries.at("a").templates, (std::vector<std::string>{ "1.json", "2.json" }));
+        EXPECT_FALSE(entries.at("no_script").has_script);
+        EXPECT_TRUE(std::filesystem::exists(manifest));
+    }
+
+    auto warm    = SuiteManifest{ flows, manifest };
+    auto entries = warm.entries();
+    EXPECT_EQ(warm.walked(), 0u);
+    EXPECT_EQ(entries.at("a").templates, (std::vector<std::string>{ "1.json", "2.json" }));
+}
+
+TEST_F(SuiteManifestTest, RewalksOnlyChangedFlows) {
+    SuiteManifest{ flows, manifest }.entries();
+
+    std::filesystem::remove(flows / "b" / "script.yaml");
+    std::filesystem::last_write_time(flows / "b", std::filesystem::file_time_type::clock::now() + std::chrono::seconds{ 1 });
+
+    auto manifest_after = SuiteManifest{ flows, manifest };
+    auto entries        = manifest_after.entries();
+    EXPECT_EQ(manifest_after.walked(), 1u);
+    EXPECT_FALSE(entries.at("b").has_script);
+
+    std::filesystem::create_directories(flows / "c");
+    std::filesystem::last_write_time(flows, std::filesystem::file_time_type::clock::now() + std::chrono::seconds{ 1 });
+
+    auto with_new = SuiteManifest{ flows, manifest };
+    EXPECT_EQ(with_new.entries().size(), 4u);
+    EXPECT_EQ(with_new.walked(), 1u);
+}
+
+TEST_F(SuiteManifestTest, WorksWithoutCaching) {
+    auto uncached = SuiteManifest{ flows, {} };
+    EXPECT_EQ(uncached.entries().size(), 3u);
+    EXPECT_FALSE(std::filesystem::exists(manifest));
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+/**
+ * @brief Base for test suites that work with files on disk
+ *
+ * Every test gets a fresh directory of its own as root, removed with everything in it afterwards,
+ * so tests never see each other's leftovers, not even across concurrent test runs.
+ */
+struct TempSuite : public ::testing::Test {
+    std::filesystem::path root = make_root();
+
+    ~TempSuite() override {
+        auto ec = std::error_code{};
+        std::filesystem::remove_all(root, ec);
+    }
+
+    /**
+     * @brief Writes content to path, creating the directories leading to it
+     */
+    static void write(std::filesystem::path const &path, std::string_view content) {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream{ path } << content;
+    }
+
+private:
+    static std::filesystem::path make_root() {
+        auto pattern = (std::filesystem::temp_directory_path() / "cliot_tests_XXXXXX").string();
+        if(::mkdtemp(pattern.data()) == nullptr)
+            throw std::system_error{ errno, std::generic_category(), "Could not create test directory" };
+        return pattern;
+    }
+};
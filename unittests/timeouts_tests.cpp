@@ -0,0 +1,224 @@
+#include <gtest/gtest.h>
+
+#include <flow/impl/yaml_file_loader.hpp>
+#include <flow/timeouts.hpp>
+#include <temp_suite.hpp>
+#include <web/web_socket_session.hpp>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace {
+struct TimeoutsTest : public ::testing::Test {
+    void SetUp() override {
+        Timeouts::set_default(100ms);
+    }
+
+    void TearDown() override {
+        Timeouts::set_default(0ms);
+    }
+};
+
+using TimeoutsScriptTest = TempSuite;
+} // namespace
+
+TEST_F(TimeoutsTest, StepTimeoutOverridesDefault) {
+    EXPECT_EQ(Timeouts::budget("response.json.j2", 0ms).wait, 100ms);
+    EXPECT_EQ(Timeouts::budget("response.json.j2", 2000ms).wait, 2000ms);
+    EXPECT_NE(Timeouts::budget("response.json.j2", 0ms).reason.find("response.json.j2"), std::string::npos);
+
+    Timeouts::set_default(0ms);
+    EXPECT_EQ(Timeouts::budget("response.json.j2", 0ms).wait, 0ms);
+}
+
+TEST_F(TimeoutsTest, EnclosingDeadlinesShortenTheWait) {
+    auto flow = Timeouts::Scope{ "Flow a", 1000ms };
+    EXPECT_GT(Timeouts::budget("response.json.j2", 5000ms).wait, 900ms);
+    {
+        auto block        = Timeouts::Scope{ "Block in a", 50ms };
+        auto const budget = Timeouts::budget("response.json.j2", 5000ms);
+        EXPECT_LE(budget.wait, 50ms);
+        EXPECT_NE(budget.reason.find("Block in a"), std::string::npos);
+    }
+    EXPECT_GT(Timeouts::budget("response.json.j2", 5000ms).wait, 50ms); // the block's deadline is gone
+
+    auto none = Timeouts::Scope{ "Flow b", 0ms }; // adds nothing
+    EXPECT_FALSE(Timeouts::expired().has_value());
+}
+
+TEST_F(TimeoutsTest, ExpiredDeadlineIsReported) {
+    auto flow = Timeouts::Scope{ "Flow a", 10ms };
+    std::this_thread::sleep_for(20ms);
+    ASSERT_TRUE(Timeouts::expired().has_value());
+    EXPECT_NE(Timeouts::expired()->find("Flow a"), std::string::npos);
+    EXPECT_GT(Timeouts::budget("response.json.j2", 0ms).wait, 0ms); // never means waiting forever
+}
+
+TEST_F(TimeoutsTest, DetachedScopeHidesEnclosingDeadlines) {
+    auto flow = Timeouts::Scope{ "Flow a", 10ms };
+    std::this_thread::sleep_for(20ms);
+    {
+        auto fixture = Timeouts::Detached{};
+        EXPECT_FALSE(Timeouts::expired().has_value());
+        EXPECT_EQ(Timeouts::budget("response.json.j2", 0ms).wait, 100ms);
+
+        auto own = Timeouts::Scope{ "Flow fixture", 50ms }; // its own deadlines still count
+        EXPECT_LE(Timeouts::budget("response.json.j2", 0ms).wait, 50ms);
+    }
+    ASSERT_TRUE(Timeouts::expired().has_value());
+    EXPECT_NE(Timeouts::expired()->find("Flow a"), std::string::npos);
+}
+
+TEST_F(TimeoutsScriptTest, ParsedFromScript) {
+    write(root / "script.yaml", R"(
+timeout: 30000
+steps:
+- type: request
+  file: request.json.j2
+  timeout: 500
+- type: response
+  file: response.json.j2
+  timeout: 200
+- type: block
+  repeat: 2
+  timeout: 1000
+  steps: []
+)");
+
+    auto const script = impl::YamlFileLoader{ root }.load();
+
+    EXPECT_EQ(script.timeout, 30000ms);
+    ASSERT_EQ(script.steps.size(), 3u);
+    EXPECT_EQ(std::get<descriptor::Request>(script.steps[0]).timeout, 500ms);
+    EXPECT_EQ(std::get<descriptor::Response>(script.steps[1]).timeout, 200ms);
+    EXPECT_EQ(std::get<descriptor::RepeatBlock>(script.steps[2]).timeout, 1000ms);
+}
+
+TEST(WebSocketSession, ReadTimesOutAndReconnects) {
+    namespace websocket = boost::beast::websocket;
+    using tcp           = boost::asio::ip::tcp;
+
+    // the first connection never answers, the second one echoes
+    auto server_ctx = boost::asio::io_context{};
+    auto acceptor   = tcp::acceptor{ server_ctx, { boost::asio::ip::make_address("127.0.0.1"), 0 } };
+    auto server     = std::thread{ [&acceptor] {
+        for(auto answer : { false, true }) {
+            auto ws = websocket::stream<tcp::socket>{ acceptor.accept() };
+            ws.accept();
+            auto buffer = boost::beast::flat_buffer{};
+            auto ec     = boost::beast::error_code{};
+            ws.read(buffer, ec);
+            if(answer)
+                ws.write(buffer.data());
+            while(not ec) // until the client gives up on this connection
+                ws.read(buffer, ec);
+        }
+    } };
+
+    auto ctx     = boost::asio::io_context{};
+    auto work    = boost::asio::make_work_guard(ctx);
+    auto io      = std::thread{ [&ctx] { ctx.run(); } };
+    auto session = WebSocketSession{ ctx, "127.0.0.1", std::to_string(acceptor.local_endpoint().port()) };
+
+    session.write("first");
+    auto const started = std::chrono::steady_clock::now();
+    EXPECT_THROW(session.read_one(100ms), ReadTimeout);
+    EXPECT_LT(std::chrono::steady_clock::now() - started, 2s);
+
+    session.write("second");
+    EXPECT_EQ(session.read_one(2000ms), "second");
+
+    session.close();
+    server.join();
+    work.reset();
+    ctx.stop();
+    io.join();
+}
+
+TEST(WebSocketSession, FailedReconnectIsReported) {
+    namespace websocket = boost::beast::websocket;
+    using tcp           = boost::asio::ip::tcp;
+
+    // the server takes a single connection, never answers and goes away
+    auto server_ctx = boost::asio::io_context{};
+    auto acceptor   = tcp::acceptor{ server_ctx, { boost::asio::ip::make_address("127.0.0.1"), 0 } };
+    auto const port = std::to_string(acceptor.local_endpoint().port());
+    auto server     = std::thread{ [&acceptor] {
+        auto ws = websocket::stream<tcp::socket>{ acceptor.accept() };
+        ws.accept();
+        acceptor.close();
+        auto buffer = boost::beast::flat_buffer{};
+        auto ec     = boost::beast::error_code{};
+        while(not ec)
+            ws.read(buffer, ec);
+    } };
+
+    auto ctx     = boost::asio::io_context{};
+    auto work    = boost::asio::make_work_guard(ctx);
+    auto io      = std::thread{ [&ctx] { ctx.run(); } };
+    auto session = WebSocketSession{ ctx, "127.0.0.1", port };
+
+    session.write("first");
+    EXPECT_THROW(session.read_one(100ms), ReadTimeout);
+    server.join();
+
+    // reconnecting after the timeout is refused; that must not leave the session hanging
+    auto const started = std::chrono::steady_clock::now();
+    EXPECT_THROW(session.write("second"), ConnectionError);
+    EXPECT_THROW(session.read_one(100ms), ConnectionError); // every further attempt fails too
+    EXPECT_LT(std::chrono::steady_clock::now() - started, 2s);
+
+    work.reset();
+    ctx.stop();
+    io.join();
+}
+
+TEST(WebSocketSession, LostConnectionIsReportedAndReconnects) {
+    namespace websocket = boost::beast::websocket;
+    using tcp           = boost::asio::ip::tcp;
+
+    // the first connection goes away while the client waits for the answer, the second one echoes
+    auto server_ctx = boost::asio::io_context{};
+    auto acceptor   = tcp::acceptor{ server_ctx, { boost::asio::ip::make_address("127.0.0.1"), 0 } };
+    auto server     = std::thread{ [&acceptor] {
+        for(auto answer : { false, true }) {
+            auto ws = websocket::stream<tcp::socket>{ acceptor.accept() };
+            ws.accept();
+            auto buffer = boost::beast::flat_buffer{};
+            auto ec     = boost::beast::error_code{};
+            ws.read(buffer, ec);
+            if(not answer) {
+                ws.next_layer().close();
+                continue;
+            }
+            ws.write(buffer.data());
+            while(not ec) // until the client closes the session
+                ws.read(buffer, ec);
+        }
+    } };
+
+    auto ctx     = boost::asio::io_context{};
+    auto work    = boost::asio::make_work_guard(ctx);
+    auto io      = std::thread{ [&ctx] { ctx.run(); } };
+    auto session = WebSocketSession{ ctx, "127.0.0.1", std::to_string(acceptor.local_endpoint().port()) };
+
+    session.write("first");
+    EXPECT_THROW(session.read_one(2000ms), ConnectionError);
+
+    session.write("second");
+    EXPECT_EQ(session.read_one(2000ms), "second");
+
+    session.close();
+    server.join();
+    work.reset();
+    ctx.stop();
+    io.join();
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <temp_suite.hpp>
+#include <trace/tracer.hpp>
+
+#include <inja/inja.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace {
+struct TracerTest : public TempSuite {
+    std::filesystem::path path = root / "trace.json";
+
+    void SetUp() override {
+        trace::Tracer::instance().enable();
+    }
+
+    void TearDown() override {
+        trace::Tracer::instance().disable();
+    }
+
+    // the tracer is process-wide, so only the spans of this test are picked out
+    std::map<std::string, inja::json> spans() const {
+        trace::Tracer::instance().write(path.string());
+        auto const exported = inja::json::parse(std::ifstream{ path });
+
+        auto result = std::map<std::string, inja::json>{};
+        for(auto const &event : exported.at("traceEvents"))
+            if(event.at("ph") == "X" and event.at("cat") == "test")
+                result[event.at("name").get<std::string>()] = event;
+            else if(event.at("ph") == "M" and event.at("args").at("name").get<std::string>().starts_with("tracer-test"))
+                result["metadata"] = event;
+        return result;
+    }
+};
+
+void record(int thread) {
+    auto outer = trace::Span{ "test", "outer-{}", thread };
+    std::this_thread::sleep_for(2ms);
+    {
+        auto inner = trace::Span{ "test", "inner-{}", thread };
+        std::this_thread::sleep_for(2ms);
+    }
+    std::this_thread::sleep_for(2ms);
+}
+} // namespace
+
+TEST_F(TracerTest, ExportsSpansOfEveryThread) {
+    auto first  = std::thread{ record, 1 };
+    auto second = std::thread{ record, 2 };
+    first.join();
+    second.join();
+
+    auto connection = 0;
+    {
+        auto span = trace::Span{ { &connection, "tracer-test" }, "test", "read" };
+    }
+
+    auto const events = spans();
+    for(auto const *name : { "outer-1", "inner-1", "outer-2", "inner-2", "read" }) {
+        ASSERT_TRUE(events.contains(name)) << name;
+        auto const &event = events.at(name);
+        EXPECT_EQ(event.at("pid"), 1);
+        EXPECT_TRUE(event.at("ts").is_number());
+        EXPECT_GT(event.at("dur").get<double>(), 0.0);
+        EXPECT_TRUE(event.at("tid").is_number_unsigned());
+    }
+
+    for(auto const *thread : { "1", "2" }) {
+        auto const &outer = events.at(std::string{ "outer-" } + thread);
+        auto const &inner = events.at(std::string{ "inner-" } + thread);
+        EXPECT_EQ(inner.at("tid"), outer.at("tid"));
+        EXPECT_GE(inner.at("ts").get<double>(), outer.at("ts").get<double>());
+        EXPECT_LE(inner.at("ts").get<double>() + inner.at("dur").get<double>(), outer.at("ts").get<double>() + outer.at("dur").get<double>());
+        EXPECT_GE(inner.at("dur").get<double>(), 2000.0); // microseconds
+    }
+    EXPECT_NE(events.at("outer-1").at("tid"), events.at("outer-2").at("tid"));
+
+    // named tracks get their own timeline with a name
+    ASSERT_TRUE(events.contains("metadata"));
+    EXPECT_EQ(events.at("metadata").at("name"), "thread_name");
+    EXPECT_EQ(events.at("metadata").at("tid"), events.at("read").at("tid"));
+}
+
+TEST_F(TracerTest, DisabledTracerRecordsNothing) {
+    trace::Tracer::instance().disable();
+    {
+        auto span = trace::Span{ "test", "disabled" };
+    }
+    EXPECT_FALSE(spans().contains("disabled"));
+}
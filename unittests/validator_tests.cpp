@@ -0,0 +1,237 @@
+#include <gtest/gtest.h>
+
+#include <util/arena.hpp>
+#include <util/arena_json.hpp>
+#include <validation/program.hpp>
+#include <validation/regex_cache.hpp>
+#include <validation/validator.hpp>
+
+#include <fmt/format.h>
+#include <inja/inja.hpp>
+
+namespace {
+auto validate(std::string const &expectations, std::string const &incoming) {
+    return Validator{}.validate(inja::json::parse(expectations), inja::json::parse(incoming));
+}
+} // namespace
+
+TEST(Validator, EmptyExpectationsAlwaysPass) {
+    EXPECT_TRUE(validate("{}", R"({"a": 1})").first);
+    EXPECT_TRUE(validate("null", R"({"a": 1})").first);
+    EXPECT_TRUE(validate(R"({"a": {}})", R"({"a": [1, 2]})").first);
+}
+
+TEST(Validator, TypeChecks) {
+    auto [valid, issues] = validate(
+        R"({"b": "$bool", "s": "$string", "a": "$array", "a2": "$array=2", "d": "$double", "i": "$int", "u": "$uint", "o": "$object"})",
+        R"({"b": true, "s": "x", "a": [], "a2": [1, 2], "d": 1.5, "i": -1, "u": 1, "o": {}})");
+    EXPECT_TRUE(valid);
+    EXPECT_TRUE(issues.empty());
+
+    std::tie(valid, issues) = validate(R"({"result": {"b": "$bool", "a2": "$array=3"}})", R"({"result": {"b": 1, "a2": [1, 2]}})");
+    EXPECT_FALSE(valid);
+    ASSERT_EQ(issues.size(), 2u);
+    EXPECT_EQ(issues[0].type, FailureEvent::Data::Type::TYPE_CHECK);
+    EXPECT_EQ(issues[0].path, "result.a2");
+    EXPECT_EQ(issues[1].path, "result.b");
+    EXPECT_EQ(issues[1].message, R"("$bool" is not met for value '1')");
+}
+
+TEST(Validator, Equality) {
+    EXPECT_TRUE(validate(R"({"a": {"b": [1, 2]}, "c": "x"})", R"({"a": {"b": [1, 2], "extra": 1}, "c": "x"})").first);
+
+    auto [valid, issues] = validate(R"({"a": {"b": [1, 2]}})", R"({"a": {"b": [2, 1]}})");
+    EXPECT_FALSE(valid);
+    ASSERT_EQ(issues.size(), 1u);
+    EXPECT_EQ(issues[0].type, FailureEvent::Data::Type::NOT_EQUAL);
+    EXPECT_EQ(issues[0].path, "a.b");
+    EXPECT_EQ(issues[0].message, "[1,2] != [2,1]");
+}
+
+TEST(Validator, MissingKeys) {
+    auto [valid, issues] = validate(R"({"a": {"b": 1, "c": "$int"}, "d": 1})", R"({"a": {"c": 1}, "e": 1})");
+    EXPECT_FALSE(valid);
+    ASSERT_EQ(issues.size(), 2u);
+    EXPECT_EQ(issues[0].type, FailureEvent::Data::Type::NO_MATCH);
+    EXPECT_EQ(issues[0].path, "a.b");
+    EXPECT_EQ(issues[1].path, "d");
+
+    std::tie(valid, issues) = validate(R"({"a": {"b": 1}})", R"({"a": 5})");
+    ASSERT_EQ(issues.size(), 1u);
+    EXPECT_EQ(issues[0].path, "a.b");
+}
+
+namespace {
+auto validate_stream(std::string const &expectations, std::string const &incoming, Validator::captures_t const &captures = {}) {
+    inja::json store     = inja::json::object();
+    auto [valid, issues] = Validator{}.validate_stream(inja::json::parse(expectations), incoming, captures, store);
+    return std::make_tuple(valid, issues, store);
+}
+
+void expect_same_as_dom(std::string const &expectations, std::string const &incoming) {
+    auto const [dom_valid, dom_issues] = validate(expectations, incoming);
+    auto const [valid, issues, store]  = validate_stream(expectations, incoming);
+    EXPECT_EQ(valid, dom_valid);
+    ASSERT_EQ(issues.size(), dom_issues.size());
+    for(std::size_t i = 0; i < issues.size(); ++i) {
+        EXPECT_EQ(issues[i].type, dom_issues[i].type);
+        EXPECT_EQ(issues[i].path, dom_issues[i].path);
+        EXPECT_EQ(issues[i].message, dom_issues[i].message);
+    }
+}
+} // namespace
+
+TEST(Validator, StreamingMatchesDom) {
+    expect_same_as_dom(R"({"a": {"b": "$int", "c": [1, 2]}, "d": "$array"})", R"({"z": [{"x": 1}], "a": {"b": 5, "c": [1, 2]}, "d": [1, [2]]})");
+    expect_same_as_dom(R"({"a": {"b": "$int", "c": [1, 2]}, "d": "$array=1"})", R"({"a": {"b": "x", "c": [2, 1]}, "d": {"q": 1}})");
+    expect_same_as_dom(R"({"a": {"b": 1, "c": "$int"}, "d": 1})", R"({"a": {"c": 1}, "e": 1})");
+    expect_same_as_dom(R"({"a": {"b": 1}, "c": {"d": 1}})", R"({"a": 5, "c": [1]})");
+    expect_same_as_dom(R"({"a": "$string", "b": {}})", R"({"a": {"x": [1, {"y": 2}]}, "b": [1]})");
+}
+
+TEST(Validator, StreamingCapturesOnlyRequestedPaths) {
+    auto [valid, issues, store] = validate_stream(R"({"result": {"status": "ok"}})",
+        R"({"result": {"status": "ok", "ledger_index": 7, "objects": [{"id": "a"}, {"id": "b"}], "marker": {"m": 1}}})",
+        { { "Index", "/result/ledger_index" }, { "Second", "/result/objects/1/id" }, { "Marker", "/result/marker" } });
+    EXPECT_TRUE(valid);
+    EXPECT_TRUE(issues.empty());
+    EXPECT_EQ(store, inja::json::parse(R"({"Index": 7, "Second": "b", "Marker": {"m": 1}})"));
+}
+
+TEST(Validator, StreamingReportsInvalidJson) {
+    auto [valid, issues, store] = validate_stream(R"({"a": 1})", R"({"a": 1)");
+    EXPECT_FALSE(valid);
+    ASSERT_EQ(issues.size(), 1u);
+    EXPECT_EQ(issues[0].type, FailureEvent::Data::Type::LOGIC_ERROR);
+}
+
+TEST(Validator, Each) {
+    auto const expectations = R"({"objects": {"$each": {"id": "$string", "flags": "$uint"}}})";
+    EXPECT_TRUE(validate(expectations, R"({"objects": [{"id": "a", "flags": 1}, {"id": "b", "flags": 0, "x": 1}]})").first);
+    EXPECT_TRUE(validate(expectations, R"({"objects": []})").first);
+
+    auto [valid, issues] = validate(expectations, R"({"objects": [{"id": "a", "flags": 1}, {"id": 5}]})");
+    EXPECT_FALSE(valid);
+    ASSERT_EQ(issues.size(), 2u);
+    EXPECT_EQ(issues[0].path, "objects[1].flags");
+    EXPECT_EQ(issues[0].type, FailureEvent::Data::Type::NO_MATCH);
+    EXPECT_EQ(issues[1].path, "objects[1].id");
+    EXPECT_EQ(issues[1].type, FailureEvent::Data::Type::TYPE_CHECK);
+
+    std::tie(valid, issues) = validate(expectations, R"({"objects": {"id": "a"}})");
+    ASSERT_EQ(issues.size(), 1u);
+    EXPECT_EQ(issues[0].type, FailureEvent::Data::Type::TYPE_CHECK);
+}
+
+TEST(Validator, EachOnHugeArrayIsParallelAndOrdered) {
+    auto incoming = inja::json::object();
+    auto &objects = incoming["objects"] = inja::json::array();
+    for(std::size_t i = 0; i < 5 * validation::Program::parallel_threshold; ++i)
+        objects.push_back({ { "seq", i % 1000 == 999 ? inja::json("bad") : inja::json(i) } });
+
+    auto [valid, issues] = Validator{}.validate(inja::json::parse(R"({"objects": {"$each": {"seq": "$uint"}}})"), incoming);
+    EXPECT_FALSE(valid);
+    ASSERT_EQ(issues.size(), objects.size() / 1000);
+    for(std::size_t i = 0; i < issues.size(); ++i)
+        EXPECT_EQ(issues[i].path, fmt::format("objects[{}].seq", i * 1000 + 999));
+}
+
+TEST(Validator, NestedEachOnHugeArraysStaysOrdered) {
+    // one of the rows is big enough to be split again while its outer chunk runs
+    auto incoming = inja::json::object();
+    auto &rows    = incoming["rows"] = inja::json::array();
+    for(std::size_t r = 0; r < 2 * validation::Program::parallel_threshold; ++r)
+        rows.push_back(inja::json::array({ r }));
+    for(std::size_t i = 0; i < 2 * validation::Program::parallel_threshold; ++i)
+        rows[7].push_back(i % 1000 == 999 ? inja::json("bad") : inja::json(i));
+
+    auto [valid, issues] = Validator{}.validate(inja::json::parse(R"({"rows": {"$each": {"$each": "$uint"}}})"), incoming);
+    EXPECT_FALSE(valid);
+    ASSERT_EQ(issues.size(), 2 * validation::Program::parallel_threshold / 1000);
+    for(std::size_t i = 0; i < issues.size(); ++i)
+        EXPECT_EQ(issues[i].path, fmt::format("rows[7][{}]", i * 1000 + 1000));
+}
+
+TEST(Validator, UnorderedAndContains) {
+    EXPECT_TRUE(validate(R"({"a": {"$unordered": [1, {"x": 2}, 1]}})", R"({"a": [{"x": 2}, 1, 1]})").first);
+    EXPECT_TRUE(validate(R"({"a": {"$contains": [3, 1]}})", R"({"a": [1, 2, 3, 4]})").first);
+
+    auto [valid, issues] = validate(R"({"a": {"$unordered": [1, 1, 2]}})", R"({"a": [2, 1, 3]})");
+    EXPECT_FALSE(valid);
+    ASSERT_EQ(issues.size(), 2u);
+    EXPECT_EQ(issues[0].type, FailureEvent::Data::Type::NOT_EQUAL);
+    EXPECT_EQ(issues[0].path, "a[2]");
+    EXPECT_EQ(issues[1].type, FailureEvent::Data::Type::NO_MATCH);
+    EXPECT_EQ(issues[1].path, "a");
+    EXPECT_EQ(issues[1].message, "Expected element 1 is missing (1 time(s))");
+
+    std::tie(valid, issues) = validate(R"({"a": {"$contains": [5, 1]}})", R"({"a": [1, 2]})");
+    ASSERT_EQ(issues.size(), 1u);
+    EXPECT_EQ(issues[0].message, "Expected element 5 is missing (1 time(s))");
+
+    EXPECT_THROW(validate(R"({"a": {"$contains": 5}})", R"({"a": [5]})"), std::invalid_argument);
+
+    // matched like plain equality where 1 == 1.0, also inside nested elements
+    EXPECT_TRUE(validate(R"({"a": {"$unordered": [1, {"x": [2]}]}})", R"({"a": [{"x": [2.0]}, 1.0]})").first);
+    EXPECT_TRUE(validate(R"({"a": {"$contains": [1.0]}})", R"({"a": [0, 1]})").first);
+}
+
+TEST(Validator, StreamingArrayMatchers) {
+    expect_same_as_dom(R"({"a": {"$each": {"x": "$int"}}, "b": {"$unordered": [1, 2]}})", R"({"a": [{"x": 1}, {"x": "y"}], "b": [2, 3]})");
+    expect_same_as_dom(R"({"a": {"$each": "$int"}, "b": {"$contains": [1]}})", R"({"a": 5, "b": []})");
+}
+
+TEST(Validator, ScalarMatchers) {
+    auto const expectations = R"({
+        "account": {"$regex": "^r[1-9A-HJ-NP-Za-km-z]{24,34}$"},
+        "ledger_index": {"$range": [100, 200]},
+        "fee": {"$range": [10, null]},
+        "hash": {"$length": 64},
+        "objects": {"$length": [1, 3]}
+    })";
+    EXPECT_TRUE(validate(expectations, fmt::format(R"({{"account": "rL4fPHi2FWGwRGRQSH7gBcxkuo2b9NTjKKa", "ledger_index": 150, "fee": "12", "hash": "{}", "objects": [1]}})", std::string(64, 'A'))).first);
+
+    auto [valid, issues] = validate(expectations, R"({"account": "xL4f", "ledger_index": 201, "fee": "9", "hash": "AB", "objects": []})");
+    EXPECT_FALSE(valid);
+    ASSERT_EQ(issues.size(), 5u);
+    for(auto const &issue : issues)
+        EXPECT_EQ(issue.type, FailureEvent::Data::Type::TYPE_CHECK);
+
+    EXPECT_THROW(validate(R"({"a": {"$regex": "("}})", "{}"), std::regex_error);
+    EXPECT_THROW(validate(R"({"a": {"$range": [1]}})", "{}"), std::invalid_argument);
+    EXPECT_THROW(validate(R"({"a": {"$length": ["x", 1]}})", "{}"), std::invalid_argument);
+}
+
+TEST(Validator, RegexCacheEvictsLeastRecentlyUsed) {
+    auto cache   = validation::RegexCache{ 2 };
+    auto const a = cache.get("^a$");
+    auto const b = cache.get("^b$");
+    EXPECT_EQ(cache.get("^a$"), a); // now b is the least recently used
+
+    cache.get("^c$");
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_EQ(cache.get("^a$"), a);
+    EXPECT_NE(cache.get("^b$"), b); // compiled again
+    EXPECT_TRUE(std::regex_match("b", *b)); // still usable by whoever held on to it
+}
+
+TEST(Validator, ArenaMatchesDom) {
+    auto const expect_same = [](std::string const &expectations, std::string const &incoming) {
+        auto const [dom_valid, dom_issues] = validate(expectations, incoming);
+
+        auto const arena           = util::Arena::Scope{};
+        auto const [valid, issues] = Validator{}.validate(util::ArenaJson::parse(expectations), util::ArenaJson::parse(incoming));
+        EXPECT_EQ(valid, dom_valid);
+        ASSERT_EQ(issues.size(), dom_issues.size());
+        for(std::size_t i = 0; i < issues.size(); ++i) {
+            EXPECT_EQ(issues[i].type, dom_issues[i].type);
+            EXPECT_EQ(issues[i].path, dom_issues[i].path);
+            EXPECT_EQ(issues[i].message, dom_issues[i].message);
+        }
+    };
+
+    expect_same(R"({"a": {"b": "$int", "c": [1, 2]}, "d": "$array=1"})", R"({"a": {"b": "x", "c": [2, 1]}, "d": {"q": 1}})");
+    expect_same(R"({"a": {"b": 1, "c": "$int"}, "d": 1})", R"({"a": {"c": 1}, "e": 1})");
+    expect_same(R"({"a": {"$each": {"x": "$int"}}, "b": {"$unordered": [1, 2]}, "c": {"$contains": [{"y": 1}]}})", R"({"a": [{"x": 1}, {"x": "y"}], "b": [2, 3], "c": [{"y": 1}]})");
+    expect_same(R"({"s": {"$regex": "^r[0-9]+$"}, "n": {"$range": [1, 5]}, "l": {"$length": [2, 3]}})", R"({"s": "r12x", "n": "7", "l": "abcd"})");
+}
@@ -1,8 +1,16 @@
 #include <gtest/gtest.h>
 
+#include <echo_server.hpp>
+#include <metrics/usage.hpp>
 #include <web/async_connection_pool.hpp>
 #include <web/connection_manager.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
 struct MockHandler {
     std::string host;
     std::string port;
@@ -45,3 +53,75 @@ TEST(Web, ConManTest) {
     EXPECT_EQ(man.get("http://test.com"), "{data}");
     EXPECT_EQ(man.post("https://another.test.com/something"), "{data}");
 }
+
+TEST(Web, WarmRoundTripsDoNotAllocate) {
+    using namespace std::chrono_literals;
+
+    auto const server = EchoServer{};
+
+    auto const request = std::string{ R"({"method":"server_info","params":[{}]})" };
+    auto pool          = AsyncConnectionPool{ "127.0.0.1", server.port() };
+    auto requests      = std::vector<std::string>(120, request); // rendering them is not part of this
+    auto mismatches    = 0;
+    auto round_trip    = [&] {
+        auto link = pool.borrow();
+        link->write(std::move(requests.back()));
+        requests.pop_back();
+        if(link->read_one(5000ms) != request)
+            ++mismatches;
+    };
+
+    for(auto i = 0; i < 20; ++i) // every connection has grown its buffers after this
+        round_trip();
+
+    auto const before = metrics::usage();
+    for(auto i = 0; i < 100; ++i)
+        round_trip();
+    auto const used = metrics::usage() - before;
+
+    EXPECT_EQ(mismatches, 0);
+    EXPECT_EQ(used.allocations, 0u);
+}
+
+TEST(Web, PoolLendsAsManyLinksAsItWasSizedFor) {
+    using namespace std::chrono_literals;
+
+    constexpr auto size = std::size_t{ 6 };
+    auto const server   = EchoServer{};
+
+    // like --jobs 6 flows each holding on to the link of their last request
+    auto pool  = AsyncConnectionPool{ "127.0.0.1", server.port(), size };
+    auto links = std::vector<AsyncConnectionPool::shared_link_t>{};
+    for(auto i = std::size_t{ 0 }; i < size; ++i) {
+        links.push_back(pool.borrow());
+        links.back()->write(std::to_string(i));
+    }
+    for(auto i = std::size_t{ 0 }; i < size; ++i)
+        EXPECT_EQ(links[i]->read_one(5000ms), std::to_string(i));
+}
+
+TEST(Web, BackToBackRoundTripsFromManyThreads) {
+    using namespace std::chrono_literals;
+
+    auto const server = EchoServer{};
+
+    // the next write of a session starts as soon as the response arrived, which can be
+    // before the previous write completed on the io thread
+    auto pool       = AsyncConnectionPool{ "127.0.0.1", server.port() };
+    auto mismatches = std::atomic_int{ 0 };
+    auto clients    = std::vector<std::thread>{};
+    for(auto t = 0; t < 4; ++t)
+        clients.emplace_back([&pool, &mismatches, t] {
+            for(auto i = 0; i < 500; ++i) {
+                auto const request = std::to_string(t * 1000 + i);
+                auto link          = pool.borrow();
+                link->write(std::string{ request });
+                if(link->read_one(5000ms) != request)
+                    ++mismatches;
+            }
+        });
+    for(auto &client : clients)
+        client.join();
+
+    EXPECT_EQ(mismatches, 0);
+}